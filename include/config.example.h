@@ -9,4 +9,18 @@
 // How many **groups of four** 8x8 MAX7219 modules are connected
 const uint8_t matrixModulesCount = 4;
 
+// Uncomment to fetch prices on the second core so the first core only has to
+// scroll the display
+// #define USE_DUAL_CORE
+
+// Uncomment to connect to a local stand-in for the real-time stream, like
+// tools/stream_replay.py, when "dataSource" is "stream"
+// #define STREAM_SERVER_HOST "192.168.1.2"
+// #define STREAM_SERVER_PORT 8443
+
+// Uncomment to fetch snapshots, latest trades and bars from a local stand-in
+// for the REST API, like tools/mock_data_server.py
+// #define DATA_SERVER_HOST "192.168.1.2"
+// #define DATA_SERVER_PORT 8444
+
 #endif
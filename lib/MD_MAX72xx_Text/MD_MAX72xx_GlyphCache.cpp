@@ -0,0 +1,46 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include "MD_MAX72xx_GlyphCache.h"
+
+/**
+ * @brief Get the columns of a character, leftmost first.
+ *
+ * @param c The character.
+ * @param width Where to store its width in columns, without the space after
+ *  it.
+ * @return const uint8_t* The columns, only valid until the next call.
+ */
+const uint8_t* MD_MAX72XX_GlyphCache::getGlyph(char c, uint8_t& width) {
+  if (!this->built) {
+    this->build();
+  }
+  const uint8_t i = static_cast<uint8_t>(c);
+  width = this->widths[i];
+  if (this->offsets[i] != NOT_CACHED) {
+    return this->columns + this->offsets[i];
+  }
+  this->display->getChar(i, sizeof(this->uncached), this->uncached);
+  return this->uncached;
+}
+
+/**
+ * @brief Read every character of the display's font into the cache.
+ */
+void MD_MAX72XX_GlyphCache::build() {
+  uint16_t used = 0;
+  for (uint16_t c = 0; c < 256; c++) {
+    const uint8_t width =
+      this->display->getChar(c, sizeof(this->uncached), this->uncached);
+    this->widths[c] = width;
+    if (width <= GLYPH_COLUMNS_SIZE - used) {
+      memcpy(this->columns + used, this->uncached, width);
+      this->offsets[c] = used;
+      used += width;
+    } else {
+      this->offsets[c] = NOT_CACHED;
+    }
+  }
+  this->built = true;
+}
@@ -0,0 +1,75 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_MD_MAX72XX_GLYPHCACHE_H
+#define PICO2W_STOCK_TICKER_MD_MAX72XX_GLYPHCACHE_H
+
+#include <Arduino.h>
+#include <MD_MAX72xx.h>
+
+// Copies the widths and columns of every character of a MD_MAX72XX font into
+// RAM, so drawing text doesn't have to look them up in the font. MD_MAX72XX
+// finds a character by walking the font from the first one, every time.
+//
+// Built from the display's font the first time it's used, so after
+// MD_MAX72XX::begin(). Share one between everything drawing on the same
+// display.
+class MD_MAX72XX_GlyphCache {
+  public:
+    /**
+     * @brief Constructor for MD_MAX72XX_GlyphCache.
+     *
+     * @param display A pointer to the MD_MAX72XX display object whose font
+     *  to cache.
+     */
+    MD_MAX72XX_GlyphCache(MD_MAX72XX* display) {
+      this->display = display;
+    }
+    ~MD_MAX72XX_GlyphCache() = default;
+
+    /**
+     * @brief Build the cache again on next use, call it after changing the
+     *  display's font.
+     */
+    void fontChanged() {
+      this->built = false;
+    }
+
+    /**
+     * @brief Get the width of a character in columns, without the space
+     *  after it.
+     *
+     * @param c The character.
+     * @return uint8_t
+     */
+    uint8_t getWidth(char c) {
+      if (!this->built) {
+        this->build();
+      }
+      return this->widths[static_cast<uint8_t>(c)];
+    }
+
+    const uint8_t* getGlyph(char c, uint8_t& width);
+
+    // Room for the columns of every character, a font with more only has the
+    // characters that fit cached and the rest are read from the font
+    static const uint16_t GLYPH_COLUMNS_SIZE = 2048;
+
+  protected:
+    static const uint16_t NOT_CACHED = UINT16_MAX;
+
+    MD_MAX72XX* display = nullptr;
+    bool built = false;
+
+    uint8_t widths[256];
+    // Where each character's columns start in columns, or NOT_CACHED
+    uint16_t offsets[256];
+    uint8_t columns[GLYPH_COLUMNS_SIZE];
+    // Characters that weren't cached are read into here
+    uint8_t uncached[UINT8_MAX];
+
+    void build();
+};
+
+#endif // PICO2W_STOCK_TICKER_MD_MAX72XX_GLYPHCACHE_H
@@ -5,7 +5,7 @@
 #include "MD_MAX72xx_Print.h"
 
 size_t MD_MAX72XX_Print::write(uint8_t c) {
-  if (this->display == nullptr) {
+  if (this->display == nullptr || this->glyphs == nullptr) {
     return 0;
   }
   if (c == '\r') { // Return to start of line, but do not clear
@@ -13,7 +13,13 @@ size_t MD_MAX72XX_Print::write(uint8_t c) {
   } else if (c == '\n') { // Return to start of line and clear
     this->newline();      // Automatic carriage return;
   } else {
-    this->curCol -= this->display->setChar(curCol, c) + 1;
+    uint8_t width;
+    const uint8_t* columns = this->glyphs->getGlyph(c, width);
+    // The display counts columns from the right, stop at its right edge
+    for (uint8_t i = 0; i < width && i <= this->curCol; i++) {
+      this->display->setColumn(this->curCol - i, columns[i]);
+    }
+    this->curCol -= width + 1;
   }
   return 1;
 }
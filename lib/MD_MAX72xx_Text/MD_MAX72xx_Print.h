@@ -7,6 +7,7 @@
 
 #include <Arduino.h>
 #include <MD_MAX72xx.h>
+#include <MD_MAX72xx_GlyphCache.h>
 
 // This class extends the Print class to allow printing text to an MD_MAX72XX
 // display.
@@ -22,9 +23,11 @@ class MD_MAX72XX_Print : public Print {
      * carriage return as well)
      *
      * @param display A pointer to the MD_MAX72XX display object to print to.
+     * @param glyphs A pointer to the glyph cache of the display's font.
      */
-    MD_MAX72XX_Print(MD_MAX72XX* display) {
+    MD_MAX72XX_Print(MD_MAX72XX* display, MD_MAX72XX_GlyphCache* glyphs) {
       this->display = display;
+      this->glyphs = glyphs;
       this->carriageReturn();
     }
     ~MD_MAX72XX_Print() = default;
@@ -33,6 +36,7 @@ class MD_MAX72XX_Print : public Print {
 
   protected:
     MD_MAX72XX* display = nullptr;
+    MD_MAX72XX_GlyphCache* glyphs = nullptr;
     uint16_t curCol = 0;
 
     void carriageReturn() {
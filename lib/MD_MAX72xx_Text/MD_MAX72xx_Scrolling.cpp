@@ -9,84 +9,174 @@
  *
  * This update function checks to make sure the text is scrolled at the set
  * speed `MD_MAX72XX_Scrolling::periodBetweenShifts`. It will also handle text
- * that is constantly changing.
+ * that is constantly changing, see textChanged(). Its cost doesn't depend on
+ * the length of the text.
+ *
+ * @return true if it was time for a frame.
  */
-void MD_MAX72XX_Scrolling::update() {
-  if (this->display == nullptr || this->strToDisplay == nullptr ||
-      strlen(this->strToDisplay) == 0) {
-    return; // Nothing to display
+bool MD_MAX72XX_Scrolling::update() {
+  if (this->display == nullptr || this->glyphs == nullptr ||
+      this->strToDisplay == nullptr || this->textLen == 0) {
+    return false; // Nothing to display
   }
 
-  if (this->nextShiftTime > millis()) {
-    return; // Not time to shift yet
+  // Compares the difference so it still works when millis() wraps
+  if (static_cast<int32_t>(this->nextShiftTime - millis()) > 0) {
+    return false; // Not time to shift yet
   }
+  const uint32_t startTime = micros();
   this->nextShiftTime = millis() + this->periodBetweenShifts;
   this->display->update(); // Update now, which will be more precise than
                            // waiting till after we do all the computation
+  this->lastFrameSpiBytes = this->pendingSpiBytes;
 
-  const size_t strToDisplayLen = strlen(this->strToDisplay);
-  const uint16_t colCount = this->display->getColumnCount();
-  this->display->clear();
-  int16_t thisCurCol = this->curCharColOffset;
-  if (this->pretendPositiveOffset) {
-    // If we are pretending the offset is positive, then we start at the left
-    // side of the display and scroll right
-    thisCurCol = 1;
+  const uint16_t colCount = this->getVisibleColumnCount();
+  // Render the characters that scrolled into view since the last frame
+  while (this->nextCharIndex < this->textLen &&
+         this->nextCharCol < this->scrollCol + colCount) {
+    if (this->strToDisplay[this->nextCharIndex] == '\0') {
+      // Shortened without textChanged(), end the text here
+      this->textLen = this->nextCharIndex;
+      break;
+    }
+    this->nextCharCol +=
+      this->renderChar(this->nextCharIndex, this->nextCharCol);
+    this->nextCharIndex++;
+  }
+  // Nothing to draw while holding
+  bool changed = false;
+  if (this->shownValid && this->shownCol + 1 == this->scrollCol &&
+      colCount == this->display->getColumnCount()) {
+    changed = this->shiftFrame(colCount);
+  } else if (!this->shownValid || this->shownCol != this->scrollCol) {
+    changed = this->redrawFrame(colCount);
   }
-  for (size_t i = this->curCharIndex; // Start from the current character index
-       i < strToDisplayLen && // Keep going as long as we have characters to
-       thisCurCol < colCount; // display or columns left to fill
-       i++) {
-    thisCurCol +=
-      this->display->setChar(colCount - thisCurCol, this->strToDisplay[i]) +
-      this->spaceBetweenChars;
+  this->shownCol = this->scrollCol;
+  this->shownValid = true;
+  // MD_MAX72XX sends a row to every module in the chain, 2 bytes each, if it
+  // changed on any of them, and drawing a column changes all of its rows
+  this->pendingSpiBytes =
+    changed ? ROW_SIZE * 2 * this->display->getDeviceCount() : 0;
+
+  if (this->holdFrames > 0) {
+    this->holdFrames--;
   }
-  // This column offset is from the left instead of from the right
-  // So to move text left, we subtract
-  this->curCharColOffset -= 1;
-  // If we are pretending the offset is positive and we've finally hit the left
-  // side of the screen, undo the effect and continue as normal.
-  if (this->pretendPositiveOffset && this->curCharColOffset <= 0) {
-    this->pretendPositiveOffset = false;
+  if (this->holdFrames == 0) {
+    this->scrollCol++;
   }
-  const char curChar = this->strToDisplay[this->curCharIndex];
-  // If the current character is scrolled completely past the left edge of the
-  // display, then focus on the next character and set it's offset to 0
-  if (this->curCharColOffset <= -this->getTextWidth(curChar)) {
-    this->curCharColOffset = 0;
-    this->curCharIndex++;
+  // Keep track of the leftmost character, textChanged() renders from it
+  while (this->firstCharIndex < this->nextCharIndex) {
+    const uint8_t width =
+      this->charWidths[this->firstCharIndex & (FRAMEBUFFER_COLUMNS - 1)];
+    if (this->scrollCol < this->firstCharCol + width) {
+      break;
+    }
+    this->firstCharCol += width;
+    this->firstCharIndex++;
   }
-  if (this->curCharIndex >= strToDisplayLen) {
+  // Start over once the last character scrolled past the left edge
+  if (this->nextCharIndex >= this->textLen &&
+      this->scrollCol >= this->nextCharCol) {
     this->reset();
   }
+  this->lastFrameTime = micros() - startTime;
+  return true;
 }
 
 /**
- * @brief Get the width of the text in columns.
+ * @brief Draw the frame one column after the one on the display by shifting
+ *  the modules that change and drawing the column coming into each of them.
+ *  Only used when the text covers the whole display.
  *
- * @param text The text to get the width of.
- * @return The number of columns it would take up.
+ * @param colCount How many columns of the display the text scrolls across.
+ * @return true if any module changed.
  */
-uint16_t MD_MAX72XX_Scrolling::getTextWidth(const char* text) {
-  uint16_t width = 0;
-  const size_t tempBufSize = 16; // Useless buffer, just to get column width
-  uint8_t tempBuf[tempBufSize];
-  for (size_t i = 0; i < strlen(text); i++) {
-    width += this->display->getChar(text[i], tempBufSize, tempBuf) +
-             this->spaceBetweenChars;
+bool MD_MAX72XX_Scrolling::shiftFrame(uint16_t colCount) {
+  // Display column c shows text column scrollCol + colCount - 1 - c. Shifting
+  // moves each column to c + 1, so a module only changes if its columns and
+  // the one coming in from its right aren't all the same.
+  const int32_t rightCol = this->scrollCol + colCount - 1;
+  const uint8_t deviceCount = this->display->getDeviceCount();
+  bool changed = false;
+  uint8_t runStart = 0;
+  bool inRun = false;
+  for (uint16_t dev = 0; dev <= deviceCount; dev++) {
+    bool shifts = false;
+    if (dev < deviceCount) {
+      const int32_t firstCol = rightCol - dev * COL_SIZE;
+      const uint8_t value = this->getTextColumn(firstCol);
+      for (uint8_t i = 1; i <= COL_SIZE && !shifts; i++) {
+        shifts = this->getTextColumn(firstCol - i) != value;
+      }
+    }
+    if (shifts && !inRun) {
+      runStart = dev;
+      inRun = true;
+    } else if (!shifts && inRun) {
+      this->display->transform(runStart, dev - 1, MD_MAX72XX::TSL);
+      this->display->setColumn(runStart * COL_SIZE,
+                               this->getTextColumn(rightCol -
+                                                   runStart * COL_SIZE));
+      inRun = false;
+      changed = true;
+    }
   }
-  return width;
+  return changed;
 }
 
 /**
- * @brief Get the width of a single character in columns.
+ * @brief Draw the whole frame, only writing the columns that are different
+ *  from what is on the display.
  *
- * @param c The character to get the width of.
- * @return The number of columns it would take up.
+ * @param colCount How many columns of the display the text scrolls across.
+ * @return true if any column changed.
  */
-uint16_t MD_MAX72XX_Scrolling::getTextWidth(char c) {
-  const size_t tempBufSize = 16; // Useless buffer, just to get column width
-  uint8_t tempBuf[tempBufSize];
-  return this->display->getChar(c, tempBufSize, tempBuf) +
-         this->spaceBetweenChars;
+bool MD_MAX72XX_Scrolling::redrawFrame(uint16_t colCount) {
+  bool changed = false;
+  for (uint16_t x = 0; x < colCount; x++) {
+    // The display counts columns from the right
+    const uint16_t displayCol = this->display->getColumnCount() - 1 - x;
+    const uint8_t value = this->getTextColumn(this->scrollCol + x);
+    if (this->display->getColumn(displayCol) != value) {
+      this->display->setColumn(displayCol, value);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+/**
+ * @brief Render one character of the text into the framebuffer, or the
+ *  provided columns if it is a COLUMNS_MARKER, followed by the space between
+ *  characters.
+ *
+ * @param textIndex The index of the character in the text.
+ * @param col The column of the text it starts at.
+ * @return The number of columns rendered, including the space after it.
+ */
+uint16_t MD_MAX72XX_Scrolling::renderChar(size_t textIndex, int32_t col) {
+  const char c = this->strToDisplay[textIndex];
+  const uint8_t* columns;
+  uint8_t providedColumns[MAX_CHAR_COLUMNS];
+  uint8_t glyphWidth;
+  if (c != COLUMNS_MARKER || this->columnProvider == nullptr) {
+    columns = this->glyphs->getGlyph(c, glyphWidth);
+  } else {
+    glyphWidth = this->providedWidth;
+    for (uint8_t i = 0; i < glyphWidth; i++) {
+      providedColumns[i] =
+        this->columnProvider(this->columnProviderContext, textIndex, i);
+    }
+    columns = providedColumns;
+  }
+  uint16_t width = glyphWidth;
+  width = min(width, static_cast<uint16_t>(MAX_CHAR_COLUMNS -
+                                           this->spaceBetweenChars));
+  for (uint16_t i = 0; i < width + this->spaceBetweenChars; i++) {
+    this->framebuffer[(col + i) & (FRAMEBUFFER_COLUMNS - 1)] =
+      i < width ? columns[i] : 0;
+  }
+  width += this->spaceBetweenChars;
+  this->charWidths[textIndex & (FRAMEBUFFER_COLUMNS - 1)] = width;
+  return width;
 }
@@ -7,8 +7,29 @@
 
 #include <Arduino.h>
 #include <MD_MAX72xx.h>
+#include <MD_MAX72xx_GlyphCache.h>
+
+/**
+ * @brief Called to draw the columns that replace a
+ *  MD_MAX72XX_Scrolling::COLUMNS_MARKER in the text.
+ *
+ * @param context The context pointer given to setColumnProvider().
+ * @param textIndex The index of the marker in the text.
+ * @param column Which column to draw, 0 is the leftmost.
+ * @return uint8_t The pixels of the column, bit 0 is the top row.
+ */
+typedef uint8_t (*MD_MAX72XX_ColumnProvider)(void* context, size_t textIndex,
+                                             uint8_t column);
 
 // Manages continually scrolling a string of text across the display.
+//
+// Characters are rendered into a framebuffer of columns once, as they scroll
+// in from the right. Each frame shifts the modules whose columns change by one
+// column and draws the column coming in, so modules that stay the same (ex.
+// blank ones) aren't touched and aren't sent to the display again. If the text
+// is changed in place, call textChanged() so the characters already on the
+// display are rendered again, and call reset() after drawing something else
+// on the display.
 class MD_MAX72XX_Scrolling {
   public:
     /**
@@ -18,9 +39,11 @@ class MD_MAX72XX_Scrolling {
      * This enables easy scrolling at a configurable speed.
      *
      * @param display A pointer to the MD_MAX72XX display object to print to.
+     * @param glyphs A pointer to the glyph cache of the display's font.
      */
-    MD_MAX72XX_Scrolling(MD_MAX72XX* display) {
+    MD_MAX72XX_Scrolling(MD_MAX72XX* display, MD_MAX72XX_GlyphCache* glyphs) {
       this->display = display;
+      this->glyphs = glyphs;
     }
     ~MD_MAX72XX_Scrolling() = default;
 
@@ -36,6 +59,7 @@ class MD_MAX72XX_Scrolling {
      */
     void setText(const char* text, bool startOnLeftInsteadOfRightSide = false) {
       this->strToDisplay = text;
+      this->textLen = text != nullptr ? strlen(text) : 0;
       this->reset(startOnLeftInsteadOfRightSide);
     }
 
@@ -48,7 +72,57 @@ class MD_MAX72XX_Scrolling {
       return this->strToDisplay;
     }
 
-    void update();
+    /**
+     * @brief Draw raw columns wherever COLUMNS_MARKER is in the text instead
+     *  of a character, ex. for small graphs.
+     *
+     * @param provider Called for each column of each marker, nullptr to
+     *  draw the marker as a normal character again.
+     * @param width How many columns each marker takes up.
+     * @param context Passed to the provider.
+     */
+    void setColumnProvider(MD_MAX72XX_ColumnProvider provider, uint8_t width,
+                           void* context) {
+      this->columnProvider = provider;
+      this->providedWidth = width;
+      this->columnProviderContext = context;
+    }
+
+    bool update();
+
+    /**
+     * @brief Render the characters already on the display again on the next
+     *  update, call it after changing the text in place. Characters that
+     *  haven't scrolled in yet are always rendered from the current text.
+     *
+     * Ignored if text isn't the text being displayed, ex. when a message was
+     * set with setText() since, so the length of one text is never used for
+     * another.
+     *
+     * @param text The text that changed.
+     * @param length Its new length, without the null terminator.
+     * @return true if it's the text being displayed.
+     */
+    bool textChanged(const char* text, size_t length) {
+      if (text == nullptr || text != this->strToDisplay) {
+        return false;
+      }
+      this->textLen = length;
+      this->nextCharIndex = this->firstCharIndex;
+      this->nextCharCol = this->firstCharCol;
+      this->shownValid = false;
+      return true;
+    }
+
+    /**
+     * @brief Same as textChanged(const char*, size_t) for the text being
+     *  displayed, but measures it.
+     */
+    void textChanged() {
+      if (this->strToDisplay != nullptr) {
+        this->textChanged(this->strToDisplay, strlen(this->strToDisplay));
+      }
+    }
 
     /**
      * @brief Reset the scrolling display to the initial state. (text to the
@@ -59,11 +133,43 @@ class MD_MAX72XX_Scrolling {
      *  right side off the screen.
      */
     void reset(bool startOnLeftInsteadOfRightSide = false) {
-      this->curCharIndex = 0;
-      this->curCharColOffset = this->display->getColumnCount();
-      this->nextShiftTime = 0; // Reset next shift time to 0 so it will shift
-                               // immediately on next update
-      this->pretendPositiveOffset = startOnLeftInsteadOfRightSide;
+      const uint16_t colCount = this->getVisibleColumnCount();
+      if (startOnLeftInsteadOfRightSide) {
+        // Hold the text on the left for as long as it would have taken to
+        // scroll in
+        this->scrollCol = 0;
+        this->holdFrames = colCount;
+      } else {
+        this->scrollCol = -static_cast<int32_t>(colCount);
+        this->holdFrames = 0;
+      }
+      this->firstCharIndex = 0;
+      this->firstCharCol = 0;
+      this->nextCharIndex = 0;
+      this->nextCharCol = 0;
+      this->shownValid = false;
+      this->nextShiftTime = millis(); // Reset next shift time to now so it
+                                      // will shift immediately on next update
+    }
+
+    /**
+     * @brief Get how long the last frame took, including sending the frame
+     *  before it to the display, in microseconds.
+     *
+     * @return uint32_t
+     */
+    uint32_t getLastFrameTime() const {
+      return this->lastFrameTime;
+    }
+
+    /**
+     * @brief Get how many bytes sending the frame before the last one to the
+     *  display took over SPI, which happens at the start of the last frame.
+     *
+     * @return uint32_t
+     */
+    uint32_t getLastFrameSpiBytes() const {
+      return this->lastFrameSpiBytes;
     }
 
     /**
@@ -74,23 +180,83 @@ class MD_MAX72XX_Scrolling {
      */
     uint32_t periodBetweenShifts = 30;
 
+    // Replaced by columns from the provider, see setColumnProvider()
+    static const char COLUMNS_MARKER = '\x01';
+
+    // Columns of rendered text kept, must be a power of 2. Longer chains only
+    // scroll on their leftmost FRAMEBUFFER_COLUMNS - MAX_CHAR_COLUMNS columns,
+    // so the last frame's columns are still there to shift from.
+    static const uint16_t FRAMEBUFFER_COLUMNS = 512;
+    // Widest a character can be, including the space after it
+    static const uint16_t MAX_CHAR_COLUMNS = 255;
+
   protected:
     MD_MAX72XX* display = nullptr;
+    MD_MAX72XX_GlyphCache* glyphs = nullptr;
     const char* strToDisplay = nullptr;
-    int16_t curCharIndex = 0;
-    // Instead of 0 being the right, we'll define 0 as offset from the left edge
-    // of the display
-    int16_t curCharColOffset = 0;
-    // If true, then the text will start on the left side and wait for a bit
-    // before scrolling instead of starting on the right side off the screen.
-    bool pretendPositiveOffset = false;
+    // Only measured by setText() and textChanged(), not every frame
+    size_t textLen = 0;
 
     const uint16_t spaceBetweenChars = 1;
 
+    // Column i of the text, counted from the left, is at
+    // framebuffer[i % FRAMEBUFFER_COLUMNS] once rendered, and the width of
+    // character i is at charWidths[i % FRAMEBUFFER_COLUMNS]
+    uint8_t framebuffer[FRAMEBUFFER_COLUMNS];
+    uint8_t charWidths[FRAMEBUFFER_COLUMNS];
+    // Column of the text on the left edge of the display, negative while the
+    // text is still scrolling in from the right
+    int32_t scrollCol = 0;
+    // Frames left before the text starts scrolling
+    uint16_t holdFrames = 0;
+    // Leftmost character on the display, and the column it starts at
+    size_t firstCharIndex = 0;
+    int32_t firstCharCol = 0;
+    // Next character to render, and the column it starts at
+    size_t nextCharIndex = 0;
+    int32_t nextCharCol = 0;
+    // Column of the text on the left edge of the display as it was last
+    // drawn, only if nothing else changed the display since
+    int32_t shownCol = 0;
+    bool shownValid = false;
+
     uint32_t nextShiftTime = 0;
+    uint32_t lastFrameTime = 0;
+    // Sent by the display update at the start of the next frame
+    uint32_t pendingSpiBytes = 0;
+    uint32_t lastFrameSpiBytes = 0;
+
+    MD_MAX72XX_ColumnProvider columnProvider = nullptr;
+    uint8_t providedWidth = 0;
+    void* columnProviderContext = nullptr;
+
+    /**
+     * @brief Get how many columns of the display the text scrolls across.
+     *
+     * @return uint16_t
+     */
+    uint16_t getVisibleColumnCount() const {
+      return min(this->display->getColumnCount(),
+                 static_cast<uint16_t>(FRAMEBUFFER_COLUMNS - MAX_CHAR_COLUMNS));
+    }
+
+    /**
+     * @brief Get a column of the text from the framebuffer, blank before and
+     *  after the text.
+     *
+     * @param col The column of the text.
+     * @return uint8_t
+     */
+    uint8_t getTextColumn(int32_t col) const {
+      if (col < 0 || col >= this->nextCharCol) {
+        return 0;
+      }
+      return this->framebuffer[col & (FRAMEBUFFER_COLUMNS - 1)];
+    }
 
-    uint16_t getTextWidth(const char* text);
-    uint16_t getTextWidth(char c);
+    uint16_t renderChar(size_t textIndex, int32_t col);
+    bool shiftFrame(uint16_t colCount);
+    bool redrawFrame(uint16_t colCount);
 };
 
 #endif // PICO2W_STOCK_TICKER_MD_MAX72XX_SCROLLING_H
@@ -7,6 +7,7 @@
 
 #include <Arduino.h>
 #include <MD_MAX72xx.h>
+#include <MD_MAX72xx_GlyphCache.h>
 #include <MD_MAX72xx_Print.h>
 #include <MD_MAX72xx_Scrolling.h>
 
@@ -16,37 +16,57 @@ namespace Settings {
    * @return SaveToDiskResult
    */
   SaveToDiskResult BaseSettings::saveToDisk() {
-    Serial1.printf("Saving %s settings to disk\n", this->getSettingsName());
+    LOG_INFO("Saving %s settings to disk", this->getSettingsName());
+
+    const uint32_t startTime = micros();
+    jsonArena.reset();
+    // The only way out, so the arena is released however writing went
+    const SaveToDiskResult result = this->writeToDisk();
+    this->releaseJsonArena();
+    if (result != SaveToDiskResult::OK) {
+      return result;
+    }
+    Telemetry::metrics.record(Telemetry::MetricTiming::SETTINGS_SAVE,
+                              micros() - startTime);
+    LOG_INFO("%s settings saved to disk successfully",
+             this->getSettingsName());
 
-#ifdef LOG_FREE_MEMORY
-    Serial1.printf("Free memory before save to disk: heap %d kb, stack %d kb\n",
-                   rp2040.getFreeHeap() / 1024, rp2040.getFreeStack() / 1024);
-#endif
+    return SaveToDiskResult::OK;
+  }
+
+  /**
+   * @brief Build the settings document in the JSON arena and write it to
+   *  the settings file. The document is destroyed by the time this returns.
+   *
+   * @return SaveToDiskResult
+   */
+  SaveToDiskResult BaseSettings::writeToDisk() {
     { // Scope for JsonDocument
-      JsonDocument doc;
+      JsonDocument doc(&jsonArena);
       this->saveValuesToDocument(doc);
-      doc.shrinkToFit();
+      if (doc.overflowed()) {
+        // Don't overwrite the file with part of the settings
+        LOG_ERROR("Not enough memory to build the settings document");
+        return SaveToDiskResult::ERROR_OUT_OF_MEMORY;
+      }
 
-#ifdef LOG_FREE_MEMORY
-      Serial1.printf(
-        "Free memory after building document: heap %d kb, stack %d kb\n",
-        rp2040.getFreeHeap() / 1024, rp2040.getFreeStack() / 1024);
-#endif
+      Telemetry::metrics.sampleMemory();
 
       { // Scope for file operations
-        Serial1.println("Starting FatFS and opening file");
+        LOG_DEBUG("Starting FatFS and opening file");
         if (!FatFS.begin()) {
-          Serial1.println("Failed to init FatFS");
+          LOG_ERROR("Failed to init FatFS");
           return SaveToDiskResult::ERROR_FATFS_INIT_FAILED;
         }
         File file = FatFS.open(this->getSettingsFilePath(), "w");
         if (!file) {
-          Serial1.printf("Failed to open %s for writing",
-                         this->getSettingsFilePath());
+          LOG_ERROR("Failed to open %s for writing",
+                    this->getSettingsFilePath());
+          FatFS.end();
           return SaveToDiskResult::ERROR_FILE_OPEN_FAILED;
         }
 
-        Serial1.println("Serializing JSON to file");
+        LOG_DEBUG("Serializing JSON to file");
 #ifdef LOG_JSON_PARSED
         Serial1.println("JSON:");
         WriteLoggingStream loggingStream(file, Serial1);
@@ -56,24 +76,13 @@ namespace Settings {
         serializeJsonPretty(doc, file);
 #endif
 
-#ifdef LOG_FREE_MEMORY
-        Serial1.printf(
-          "Free memory after serialization: heap %d kb, stack %d kb\n",
-          rp2040.getFreeHeap() / 1024, rp2040.getFreeStack() / 1024);
-#endif
+        Telemetry::metrics.sampleMemory();
 
-        Serial1.println("Closing file and stopping FatFS");
+        LOG_DEBUG("Closing file and stopping FatFS");
         file.close();
         FatFS.end();
       }
     }
-#ifdef LOG_FREE_MEMORY
-    Serial1.printf("Free memory after save to disk: heap %d kb, stack %d kb\n",
-                   rp2040.getFreeHeap() / 1024, rp2040.getFreeStack() / 1024);
-#endif
-    Serial1.printf("%s settings saved to disk successfully\n",
-                   this->getSettingsName());
-
     return SaveToDiskResult::OK;
   }
 
@@ -83,29 +92,49 @@ namespace Settings {
    * @return LoadFromDiskResult
    */
   LoadFromDiskResult BaseSettings::loadFromDisk() {
-    Serial1.printf("Loading %s settings from disk\n", this->getSettingsName());
+    LOG_INFO("Loading %s settings from disk", this->getSettingsName());
+
+    const uint32_t startTime = micros();
+    jsonArena.reset();
+    // The only way out, so the arena is released however reading went
+    const LoadFromDiskResult result = this->readFromDisk();
+    this->releaseJsonArena();
+    if (result != LoadFromDiskResult::OK) {
+      return result;
+    }
+    Telemetry::metrics.record(Telemetry::MetricTiming::SETTINGS_LOAD,
+                              micros() - startTime);
+    LOG_INFO("%s settings loaded from disk successfully",
+             this->getSettingsName());
 
-#ifdef LOG_FREE_MEMORY
-    Serial1.printf(
-      "Free memory before load from disk: heap %d kb, stack %d kb\n",
-      rp2040.getFreeHeap() / 1024, rp2040.getFreeStack() / 1024);
-#endif
+    return LoadFromDiskResult::OK;
+  }
+
+  /**
+   * @brief Parse the settings file into a document in the JSON arena, then
+   *  validate and load it. The document is destroyed by the time this
+   *  returns.
+   *
+   * @return LoadFromDiskResult
+   */
+  LoadFromDiskResult BaseSettings::readFromDisk() {
     {
-      Serial1.println("Starting FatFS and opening file");
+      LOG_DEBUG("Starting FatFS and opening file");
       if (!FatFS.begin()) {
-        Serial1.println("Failed to init FatFS");
+        LOG_ERROR("Failed to init FatFS");
         return LoadFromDiskResult::ERROR_FATFS_INIT_FAILED;
       }
       File file = FatFS.open(this->getSettingsFilePath(), "r");
       if (!file) {
-        Serial1.printf("Failed to open %s for reading",
-                       this->getSettingsFilePath());
+        LOG_ERROR("Failed to open %s for reading",
+                  this->getSettingsFilePath());
+        FatFS.end();
         return LoadFromDiskResult::ERROR_FILE_OPEN_FAILED;
       }
 
       {
-        Serial1.println("Deserializing JSON from file");
-        JsonDocument doc;
+        LOG_DEBUG("Deserializing JSON from file");
+        JsonDocument doc(&jsonArena);
 #ifdef LOG_JSON_PARSED
         Serial1.println("JSON:");
         ReadLoggingStream loggingStream(file, Serial1);
@@ -114,78 +143,81 @@ namespace Settings {
 #else
         DeserializationError error = deserializeJson(doc, file);
 #endif
-        Serial1.println("Closing file and stopping FatFS");
+        LOG_DEBUG("Closing file and stopping FatFS");
         file.close();
         FatFS.end();
 
         if (error) {
-          Serial1.printf("Failed to deserialize JSON: %s\n", error.c_str());
+          LOG_ERROR("Failed to deserialize JSON: %s", error.c_str());
           switch (error.code()) {
             case DeserializationError::TooDeep: {
-              Serial1.println("JSON is too deep, please check the file");
+              LOG_ERROR("JSON is too deep, please check the file");
               return LoadFromDiskResult::ERROR_JSON_PARSE_TOO_DEEP;
             }
             case DeserializationError::NoMemory: {
-              Serial1.println("JSON parsing failed due to insufficient memory");
+              LOG_ERROR("JSON parsing failed due to insufficient memory");
               return LoadFromDiskResult::ERROR_JSON_PARSE_NO_MEMORY;
             }
             case DeserializationError::InvalidInput: {
-              Serial1.println("JSON parsing failed due to invalid input");
+              LOG_ERROR("JSON parsing failed due to invalid input");
               return LoadFromDiskResult::ERROR_JSON_PARSE_INVALID_INPUT;
             }
             case DeserializationError::IncompleteInput: {
-              Serial1.println("JSON parsing failed due to incomplete input");
+              LOG_ERROR("JSON parsing failed due to incomplete input");
               return LoadFromDiskResult::ERROR_JSON_PARSE_INCOMPLETE_INPUT;
             }
             case DeserializationError::EmptyInput: {
-              Serial1.println("JSON parsing failed due to empty input");
+              LOG_ERROR("JSON parsing failed due to empty input");
               return LoadFromDiskResult::ERROR_JSON_PARSE_EMPTY_INPUT;
             }
             case DeserializationError::Ok:
             default: {
-              Serial1.println("Unknown error");
+              LOG_ERROR("Unknown error");
               return LoadFromDiskResult::ERROR_JSON_PARSE_UNKNOWN_ERROR;
             }
           }
         }
 
-#ifdef LOG_FREE_MEMORY
-        Serial1.printf(
-          "Free memory after deserialization: heap %d kb, stack %d kb\n",
-          rp2040.getFreeHeap() / 1024, rp2040.getFreeStack() / 1024);
-#endif
+        Telemetry::metrics.sampleMemory();
 
         this->lastValidationResult = this->validateSettings(doc);
         if (this->lastValidationResult == 0) {
-          Serial1.printf("%s settings validation passed\n",
-                         this->getSettingsName());
+          LOG_DEBUG("%s settings validation passed",
+                    this->getSettingsName());
           this->loadValuesFromDocument(doc);
         } else {
-          Serial1.printf(
-            "Validation failed for %s settings after loading from disk\n",
+          LOG_ERROR(
+            "Validation failed for %s settings after loading from disk",
             this->getSettingsName());
           return LoadFromDiskResult::ERROR_VALIDATION_FAILED;
         }
       }
     }
-#ifdef LOG_FREE_MEMORY
-    Serial1.printf(
-      "Free memory after load from disk: heap %d kb, stack %d kb\n",
-      rp2040.getFreeHeap() / 1024, rp2040.getFreeStack() / 1024);
-#endif
-    Serial1.printf("%s settings loaded from disk successfully\n",
-                   this->getSettingsName());
-
     return LoadFromDiskResult::OK;
   }
 
+  /**
+   * @brief Report how much of the JSON arena the last load or save used,
+   *  then give it all back. Only call it once the JsonDocument is destroyed.
+   */
+  void BaseSettings::releaseJsonArena() {
+    LOG_DEBUG("%s settings used %u of %u bytes of the JSON arena",
+              this->getSettingsName(),
+              static_cast<unsigned>(jsonArena.getHighWaterMark()),
+              static_cast<unsigned>(JSON_ARENA_SIZE));
+    Telemetry::metrics.set(Telemetry::MetricGauge::JSON_ARENA_PEAK,
+                           jsonArena.getHighWaterMark());
+    jsonArena.reset();
+  }
+
   /**
    * @brief Start exposing the FatFS filesystem to the computer as a USB.
    *
    * This will allow the user to modify the settings file on the USB drive.
    */
   void BaseSettings::fatFSUSBBegin() {
-    Serial1.println("Exposing FatFS to USB");
+    LOG_INFO("Exposing FatFS to USB");
+    // Called from the USB interrupt, where the logger can't be used
     FatFSUSB.onUnplug([](uint32_t i) {
       usbConnected = false;
       Serial1.println("USB unplugged");
@@ -197,7 +229,7 @@ namespace Settings {
     FatFSUSB.driveReady([](uint32_t i) { return true; });
     FatFSUSB.begin();
     usbConnected = true;
-    Serial1.println("FatFSUSB started");
+    LOG_INFO("FatFSUSB started");
   }
 
   /**
@@ -208,6 +240,6 @@ namespace Settings {
   void BaseSettings::fatFSUSBEnd() {
     FatFSUSB.end();
     usbConnected = false;
-    Serial1.println("FatFSUSB stopped");
+    LOG_INFO("FatFSUSB stopped");
   }
 } // Settings
@@ -5,17 +5,19 @@
 #ifndef PICO2W_STOCK_TICKER_BASESETTINGS_H
 #define PICO2W_STOCK_TICKER_BASESETTINGS_H
 
-#ifndef LOG_FREE_MEMORY
-  #define LOG_FREE_MEMORY
-#endif
+// Dumps the settings files to Serial1 as they are read and written, secrets
+// included, so it's off unless defined in build_flags
 #ifndef LOG_JSON_PARSED
-  #define LOG_JSON_PARSED
+// #define LOG_JSON_PARSED
 #endif
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <FatFS.h>
 #include <FatFSUSB.h>
+#include <JsonArena.h>
+#include <Log.h>
+#include <Metrics.h>
 #include <StreamUtils.h>
 
 namespace Settings {
@@ -23,7 +25,8 @@ namespace Settings {
   enum class SaveToDiskResult {
     OK,
     ERROR_FATFS_INIT_FAILED,
-    ERROR_FILE_OPEN_FAILED
+    ERROR_FILE_OPEN_FAILED,
+    ERROR_OUT_OF_MEMORY
   };
 
   enum class LoadFromDiskResult {
@@ -85,6 +88,10 @@ namespace Settings {
     protected:
       uint8_t lastValidationResult = 0;
 
+      SaveToDiskResult writeToDisk();
+      LoadFromDiskResult readFromDisk();
+      void releaseJsonArena();
+
       /**
        * @brief Classes inheriting from BaseSettings must implement this method
        *  to save their specific values to the JSON document.
@@ -0,0 +1,105 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <JsonArena.h>
+
+namespace Settings {
+  JsonArena jsonArena;
+
+  /**
+   * @brief Take a block from the top of the arena.
+   *
+   * @param size How many bytes.
+   * @return void* The block, or nullptr if the arena is full.
+   */
+  void* JsonArena::allocate(size_t size) {
+    const size_t needed =
+      HEADER_SIZE + (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    if (needed > JSON_ARENA_SIZE - this->top) {
+      LOG_ERROR("JSON arena full, %u bytes requested with %u of %u used",
+                static_cast<unsigned>(size), static_cast<unsigned>(this->top),
+                static_cast<unsigned>(JSON_ARENA_SIZE));
+      this->failedAllocations++;
+      return nullptr;
+    }
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(this->buffer +
+                                                         this->top);
+    header->size = size;
+    header->previous = this->lastBlock;
+    this->lastBlock = this->top;
+    this->top += needed;
+    if (this->top > this->highWaterMark) {
+      this->highWaterMark = this->top;
+    }
+    return header + 1;
+  }
+
+  /**
+   * @brief Free a block. Only the last block is given back right away, the
+   *  others are given back by reset().
+   *
+   * @param pointer The block, may be nullptr.
+   */
+  void JsonArena::deallocate(void* pointer) {
+    if (pointer == nullptr) {
+      return;
+    }
+    BlockHeader* header = this->headerOf(pointer);
+    if (reinterpret_cast<uint8_t*>(header) - this->buffer == this->lastBlock) {
+      this->top = this->lastBlock;
+      this->lastBlock = header->previous;
+    }
+  }
+
+  /**
+   * @brief Grow or shrink a block. The last block is resized in place, any
+   *  other block is copied to the top of the arena.
+   *
+   * @param pointer The block, or nullptr to allocate a new one.
+   * @param newSize The new size in bytes.
+   * @return void* The resized block, or nullptr if the arena is full, in
+   *  which case the old block is left as is.
+   */
+  void* JsonArena::reallocate(void* pointer, size_t newSize) {
+    if (pointer == nullptr) {
+      return this->allocate(newSize);
+    }
+    BlockHeader* header = this->headerOf(pointer);
+    const size_t offset = reinterpret_cast<uint8_t*>(header) - this->buffer;
+    if (offset == this->lastBlock) {
+      const size_t needed =
+        HEADER_SIZE + (newSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+      if (needed > JSON_ARENA_SIZE - offset) {
+        LOG_ERROR("JSON arena full, %u bytes requested with %u of %u used",
+                  static_cast<unsigned>(newSize),
+                  static_cast<unsigned>(this->top),
+                  static_cast<unsigned>(JSON_ARENA_SIZE));
+        this->failedAllocations++;
+        return nullptr;
+      }
+      header->size = newSize;
+      this->top = offset + needed;
+      if (this->top > this->highWaterMark) {
+        this->highWaterMark = this->top;
+      }
+      return pointer;
+    }
+    void* moved = this->allocate(newSize);
+    if (moved != nullptr) {
+      memcpy(moved, pointer, min(static_cast<size_t>(header->size), newSize));
+    }
+    return moved;
+  }
+
+  /**
+   * @brief Give back every block. Only call it once every document using the
+   *  arena has been destroyed.
+   */
+  void JsonArena::reset() {
+    this->top = 0;
+    this->lastBlock = NO_BLOCK;
+    this->highWaterMark = 0;
+    this->failedAllocations = 0;
+  }
+} // Settings
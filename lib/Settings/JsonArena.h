@@ -0,0 +1,105 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_JSONARENA_H
+#define PICO2W_STOCK_TICKER_JSONARENA_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <Log.h>
+
+namespace Settings {
+  // Room for the biggest settings document, a full symbols string and every
+  // other setting, with space to spare for ArduinoJson's pools
+  const size_t JSON_ARENA_SIZE = 8192;
+
+  /**
+   * @brief ArduinoJson allocator that hands out memory from a static buffer
+   *  instead of the heap, so building and parsing the settings documents
+   *  doesn't fragment the heap next to the TLS buffers.
+   *
+   * Memory is taken from the top of the arena. Only the last block can be
+   * grown, shrunk or freed in place, which is how ArduinoJson uses memory
+   * while parsing anyways. Everything else is only freed by reset(), which
+   * must be called once every document using the arena is destroyed.
+   *
+   * When the arena runs out, allocations return nullptr and ArduinoJson
+   * reports DeserializationError::NoMemory, or JsonDocument::overflowed().
+   */
+  class JsonArena : public ArduinoJson::Allocator {
+    public:
+      JsonArena() = default;
+      ~JsonArena() = default;
+
+      void* allocate(size_t size) override;
+      void deallocate(void* pointer) override;
+      void* reallocate(void* pointer, size_t newSize) override;
+
+      void reset();
+
+      /**
+       * @brief Get how many bytes are in use, including block headers.
+       *
+       * @return size_t
+       */
+      size_t getUsed() const {
+        return this->top;
+      }
+
+      /**
+       * @brief Get the most bytes that were in use since the last reset().
+       *
+       * @return size_t
+       */
+      size_t getHighWaterMark() const {
+        return this->highWaterMark;
+      }
+
+      /**
+       * @brief Get how many allocations failed because the arena was full,
+       *  since the last reset().
+       *
+       * @return uint32_t
+       */
+      uint32_t getFailedAllocations() const {
+        return this->failedAllocations;
+      }
+
+    protected:
+      // clang-format off
+      struct BlockHeader {
+        uint32_t size;
+        uint32_t previous;
+      };
+      // clang-format on
+
+      static const size_t ALIGNMENT = 8;
+      static const size_t HEADER_SIZE = sizeof(BlockHeader);
+      static const uint32_t NO_BLOCK = UINT32_MAX;
+
+      alignas(ALIGNMENT) uint8_t buffer[JSON_ARENA_SIZE];
+      // Offset of the first free byte, and of the header of the last block
+      size_t top = 0;
+      uint32_t lastBlock = NO_BLOCK;
+      size_t highWaterMark = 0;
+      uint32_t failedAllocations = 0;
+
+      /**
+       * @brief Get the header in front of a block.
+       *
+       * @param pointer The block, as returned by allocate().
+       * @return BlockHeader*
+       */
+      BlockHeader* headerOf(void* pointer) {
+        return reinterpret_cast<BlockHeader*>(static_cast<uint8_t*>(pointer) -
+                                              HEADER_SIZE);
+      }
+  };
+
+  // Shared by every settings class, they are never loaded or saved at the
+  // same time
+  extern JsonArena jsonArena;
+} // Settings
+
+#endif // PICO2W_STOCK_TICKER_JSONARENA_H
@@ -18,6 +18,8 @@ namespace Settings {
       doc["requestPeriod"] | 60; // Default to 60 seconds
     const uint8_t parsedDisplayBrightness =
       doc["displayBrightness"] | 7; // Default to 7
+    const char* parsedDataSource =
+      doc["dataSource"] | "snapshots"; // Default to snapshots
     if (strlen(parsedApcaApiKeyId) == 0 ||
         strlen(parsedApcaApiKeyId) >= APCA_API_KEY_ID_MAX_LEN) {
       return static_cast<uint8_t>(
@@ -63,6 +65,11 @@ namespace Settings {
       return static_cast<uint8_t>(
         TickerSettingsValidationResult::ERROR_INVALID_DISPLAY_BRIGHTNESS);
     }
+    StockTicker::DataSource source;
+    if (!StockTicker::dataSourceFromString(parsedDataSource, source)) {
+      return static_cast<uint8_t>(
+        TickerSettingsValidationResult::ERROR_INVALID_DATA_SOURCE);
+    }
     return static_cast<uint8_t>(TickerSettingsValidationResult::OK);
   }
 #pragma clang diagnostic pop
@@ -75,6 +82,7 @@ namespace Settings {
     doc["requestPeriod"] = this->requestPeriod;
     doc["scrollPeriod"] = this->scrollPeriod;
     doc["displayBrightness"] = this->displayBrightness;
+    doc["dataSource"] = this->dataSource;
   }
 
   void TickerSettings::loadValuesFromDocument(const JsonDocument& doc) {
@@ -89,5 +97,7 @@ namespace Settings {
     this->requestPeriod = doc["requestPeriod"] | 60; // Default to 60 seconds
     this->scrollPeriod = doc["scrollPeriod"] | 30;   // Default to 30 ms
     this->displayBrightness = doc["displayBrightness"] | 7; // Default to 7
+    strncpy(this->dataSource, doc["dataSource"] | "snapshots",
+            DATA_SOURCE_MAX_LEN); // Default to snapshots
   }
 } // Settings
@@ -12,9 +12,10 @@
 namespace Settings {
   const size_t APCA_API_KEY_ID_MAX_LEN = 32;
   const size_t APCA_API_SECRET_KEY_MAX_LEN = 64;
-  const size_t SYMBOLS_STRING_MAX_LEN = 256;
-  const uint16_t MAX_SYMBOLS_COUNT = 32;
+  const size_t SYMBOLS_STRING_MAX_LEN = StockTicker::MAX_SYMBOLS_STRING_LEN;
+  const uint16_t MAX_SYMBOLS_COUNT = StockTicker::MAX_SYMBOLS;
   const size_t SOURCE_FEED_MAX_LEN = 16;
+  const size_t DATA_SOURCE_MAX_LEN = 16;
 
   enum class TickerSettingsValidationResult {
     OK = 0,
@@ -24,7 +25,8 @@ namespace Settings {
     ERROR_INVALID_SOURCE_FEED = 4,
     ERROR_INVALID_REQUEST_PERIOD = 5,
     ERROR_INVALID_SCROLL_PERIOD = 6,
-    ERROR_INVALID_DISPLAY_BRIGHTNESS = 7
+    ERROR_INVALID_DISPLAY_BRIGHTNESS = 7,
+    ERROR_INVALID_DATA_SOURCE = 8
   };
 
   class TickerSettings : public BaseSettings {
@@ -58,6 +60,16 @@ namespace Settings {
        * Free account only has access to "iex" or "delayed_sip". (15 min delay)
        */
       char sourceFeed[SOURCE_FEED_MAX_LEN] = "iex";
+      /**
+       * @brief Which endpoint to get prices from, either "snapshots",
+       *  "latestTrades", or "stream". Defaults to "snapshots".
+       *
+       * "latestTrades" downloads much less per request, and only fetches a
+       * full snapshot for the start of day prices once an hour. "stream"
+       * fetches one snapshot, then gets trades as they happen over a
+       * WebSocket and ignores the request period.
+       */
+      char dataSource[DATA_SOURCE_MAX_LEN] = "snapshots";
       /**
        * @brief Request period in seconds. (how long to wait between each
        *  request to the Alpaca Markets API) Must be a natural number. Defaults
@@ -79,6 +91,17 @@ namespace Settings {
        */
       uint8_t displayBrightness = 7;
 
+      /**
+       * @brief Get dataSource as a StockTicker::DataSource.
+       *
+       * @return StockTicker::DataSource
+       */
+      StockTicker::DataSource getDataSource() const {
+        StockTicker::DataSource source = StockTicker::DataSource::SNAPSHOTS;
+        StockTicker::dataSourceFromString(this->dataSource, source);
+        return source;
+      }
+
     protected:
       void saveValuesToDocument(JsonDocument& doc) override;
       void loadValuesFromDocument(const JsonDocument& doc) override;
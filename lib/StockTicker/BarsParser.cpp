@@ -0,0 +1,48 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <BarsParser.h>
+
+namespace StockTicker {
+  void BarsParser::onContainerStart(uint8_t depth, const char* key,
+                                    bool isArray) {
+    if (depth == 1) {
+      this->inBars = false;
+      this->nextPage = false;
+    } else if (depth == 2 && !isArray && key != nullptr) {
+      this->inBars = strcmp(key, "bars") == 0;
+    } else if (depth == 3 && this->inBars && isArray && key != nullptr) {
+      // Start of a symbol's bars, skipped if the id was cut off
+      strncpy(this->symbol, key, JSON_TOKEN_MAX_LEN);
+      if (this->keyTruncated()) {
+        this->symbol[0] = '\0';
+      }
+    } else if (depth == 4 && this->inBars && !isArray) {
+      this->hasClose = false;
+    }
+  }
+
+  void BarsParser::onContainerEnd(uint8_t depth, bool isArray) {
+    if (depth == 2) {
+      this->inBars = false;
+    } else if (depth == 4 && this->inBars && this->hasClose &&
+               this->symbol[0] != '\0') {
+      this->callback(this->context, this->symbol, this->closePrice);
+      this->hasClose = false;
+    }
+  }
+
+  void BarsParser::onValue(uint8_t depth, const char* key, JsonValueType type,
+                           const char* text) {
+    if (key == nullptr) {
+      return;
+    }
+    if (depth == 1 && strcmp(key, "next_page_token") == 0) {
+      this->nextPage = type == JsonValueType::STRING;
+    } else if (depth == 4 && this->inBars && type == JsonValueType::NUMBER &&
+               strcmp(key, "c") == 0 && !this->valueTruncated()) {
+      this->hasClose = parseFixedPoint(text, this->closePrice);
+    }
+  }
+} // StockTicker
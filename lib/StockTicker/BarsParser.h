@@ -0,0 +1,66 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_BARSPARSER_H
+#define PICO2W_STOCK_TICKER_BARSPARSER_H
+
+#include <Arduino.h>
+#include <FixedPoint.h>
+#include <JsonStreamTokenizer.h>
+
+namespace StockTicker {
+  /**
+   * @brief Called once per bar in a bars response, oldest first.
+   *
+   * @param context The context pointer given to the parser.
+   * @param id The symbol of the stock.
+   * @param closePrice The close price of the bar. (c) In 1/FIXED_POINT_SCALE
+   *  units.
+   */
+  typedef void (*BarCallback)(void* context, const char* id,
+                              int64_t closePrice);
+
+  /**
+   * @brief Streaming parser for the body of /v2/stocks/bars.
+   *
+   * The response looks like {"bars": {"AAPL": [{"c": 1.0, "o": 1.0, ...},
+   * ...], ...}, "next_page_token": null}. Only the close of each bar is kept.
+   */
+  class BarsParser : public JsonStreamTokenizer {
+    public:
+      BarsParser(BarCallback callback, void* context) {
+        this->callback = callback;
+        this->context = context;
+      }
+      ~BarsParser() override = default;
+
+      /**
+       * @brief Check if the response said there are more bars than it had.
+       *
+       * @return true if the response was cut short by its limit.
+       */
+      bool hasNextPage() const {
+        return this->nextPage;
+      }
+
+    protected:
+      void onContainerStart(uint8_t depth, const char* key,
+                            bool isArray) override;
+      void onContainerEnd(uint8_t depth, bool isArray) override;
+      void onValue(uint8_t depth, const char* key, JsonValueType type,
+                   const char* text) override;
+
+    private:
+      BarCallback callback = nullptr;
+      void* context = nullptr;
+
+      bool inBars = false;
+      bool nextPage = false;
+      char symbol[JSON_TOKEN_MAX_LEN];
+      bool hasClose = false;
+      int64_t closePrice = 0;
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_BARSPARSER_H
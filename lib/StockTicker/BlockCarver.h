@@ -0,0 +1,65 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_BLOCKCARVER_H
+#define PICO2W_STOCK_TICKER_BLOCKCARVER_H
+
+#include <Arduino.h>
+#include <new>
+
+namespace StockTicker {
+  /**
+   * @brief Hands out arrays from one block of memory one after the other, so
+   *  storage sized at runtime takes a single allocation.
+   *
+   * Without a block it only adds up the size, so the same code can measure
+   * the block first and then carve it:
+   *
+   *  BlockCarver measure(nullptr);
+   *  layout(measure);
+   *  uint8_t* block = static_cast<uint8_t*>(malloc(measure.size()));
+   *  BlockCarver carver(block);
+   *  layout(carver);
+   */
+  class BlockCarver {
+    public:
+      explicit BlockCarver(uint8_t* block) : block(block) {}
+      ~BlockCarver() = default;
+
+      /**
+       * @brief Take the next array from the block, default constructed.
+       *
+       * @param count How many elements.
+       * @return T* The array, or nullptr if only measuring.
+       */
+      template <class T>
+      T* take(size_t count) {
+        this->used = (this->used + alignof(T) - 1) & ~(alignof(T) - 1);
+        T* array = nullptr;
+        if (this->block != nullptr) {
+          array = reinterpret_cast<T*>(this->block + this->used);
+          for (size_t i = 0; i < count; i++) {
+            new (&array[i]) T();
+          }
+        }
+        this->used += count * sizeof(T);
+        return array;
+      }
+
+      /**
+       * @brief Get how many bytes have been taken, including padding.
+       *
+       * @return size_t
+       */
+      size_t size() const {
+        return this->used;
+      }
+
+    protected:
+      uint8_t* block;
+      size_t used = 0;
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_BLOCKCARVER_H
@@ -0,0 +1,224 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <FixedPoint.h>
+
+namespace StockTicker {
+  // Enough digits to not overflow a uint64_t while accumulating
+  const uint8_t MAX_SIGNIFICANT_DIGITS = 19;
+
+  static const uint64_t POWERS_OF_TEN[] = {1,
+                                           10,
+                                           100,
+                                           1000,
+                                           10000,
+                                           100000,
+                                           1000000,
+                                           10000000,
+                                           100000000,
+                                           1000000000,
+                                           10000000000,
+                                           100000000000,
+                                           1000000000000,
+                                           10000000000000,
+                                           100000000000000,
+                                           1000000000000000,
+                                           10000000000000000,
+                                           100000000000000000,
+                                           1000000000000000000,
+                                           10000000000000000000u};
+  const int8_t MAX_POWER_OF_TEN = 19;
+
+  /**
+   * @brief Divide, rounding half away from zero.
+   */
+  static int64_t divideRounded(int64_t dividend, int64_t divisor) {
+    if (divisor < 0) {
+      dividend = -dividend;
+      divisor = -divisor;
+    }
+    if (dividend < 0) {
+      return -((-dividend + divisor / 2) / divisor);
+    }
+    return (dividend + divisor / 2) / divisor;
+  }
+
+  /**
+   * @brief Parse the text of a JSON number into a fixed-point value without
+   *  going through float, so no precision is lost on high prices.
+   *
+   * @param text The number, like "-12.345" or "1.5e2". Digits past the
+   *  precision of the fixed-point value are rounded half away from zero,
+   *  like divideRounded().
+   * @param value Where to store the value, in 1/FIXED_POINT_SCALE units.
+   * @return true if the text was a number that fits.
+   */
+  bool parseFixedPoint(const char* text, int64_t& value) {
+    const char* p = text;
+    const bool negative = *p == '-';
+    if (*p == '-' || *p == '+') {
+      p++;
+    }
+    uint64_t mantissa = 0;
+    uint8_t significantDigits = 0;
+    // First digit that didn't fit in the mantissa, the ones after it can't
+    // change which way it rounds
+    uint8_t roundingDigit = 0;
+    bool droppedDigits = false;
+    // Power of ten the mantissa is multiplied by
+    int32_t exponent = 0;
+    bool hasDigits = false;
+    bool inFraction = false;
+    for (; (*p >= '0' && *p <= '9') || (*p == '.' && !inFraction); p++) {
+      if (*p == '.') {
+        inFraction = true;
+        continue;
+      }
+      hasDigits = true;
+      if (significantDigits < MAX_SIGNIFICANT_DIGITS) {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa > 0) {
+          significantDigits++;
+        }
+        if (inFraction) {
+          exponent--;
+        }
+        continue;
+      }
+      // Too precise, keep the digit to round with and its place
+      if (!droppedDigits) {
+        roundingDigit = *p - '0';
+        droppedDigits = true;
+      }
+      if (!inFraction) {
+        exponent++;
+      }
+    }
+    if (!hasDigits) {
+      return false;
+    }
+    if (*p == 'e' || *p == 'E') {
+      p++;
+      const bool negativeExponent = *p == '-';
+      if (*p == '-' || *p == '+') {
+        p++;
+      }
+      if (*p < '0' || *p > '9') {
+        return false;
+      }
+      int32_t explicitExponent = 0;
+      for (; *p >= '0' && *p <= '9'; p++) {
+        if (explicitExponent < 1000) {
+          explicitExponent = explicitExponent * 10 + (*p - '0');
+        }
+      }
+      exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+    if (*p != '\0') {
+      return false;
+    }
+
+    exponent += FIXED_POINT_DECIMALS;
+    uint64_t magnitude;
+    if (mantissa == 0) {
+      magnitude = 0;
+    } else if (exponent > 0) {
+      // A full mantissa times 10 doesn't fit, so nothing was dropped here
+      if (exponent > MAX_POWER_OF_TEN ||
+          mantissa > INT64_MAX / POWERS_OF_TEN[exponent]) {
+        return false;
+      }
+      magnitude = mantissa * POWERS_OF_TEN[exponent];
+    } else if (exponent == 0) {
+      magnitude = mantissa + (droppedDigits && roundingDigit >= 5 ? 1 : 0);
+    } else if (exponent < -MAX_POWER_OF_TEN) {
+      magnitude = 0; // Too small to show up
+    } else {
+      // Rounding half up on the magnitude is half away from zero. A remainder
+      // under half stays under half with the dropped digits added to it.
+      const uint64_t divisor = POWERS_OF_TEN[-exponent];
+      magnitude = (mantissa + divisor / 2) / divisor;
+    }
+    if (magnitude > INT64_MAX) {
+      return false;
+    }
+    value = negative ? -static_cast<int64_t>(magnitude) : magnitude;
+    return true;
+  }
+
+  /**
+   * @brief Calculate part / whole as a percentage with integer arithmetic.
+   *
+   * @param part The fixed-point numerator, like the change in price.
+   * @param whole The fixed-point denominator, like the open price.
+   * @return int64_t The percentage in 1/FIXED_POINT_SCALE units, or 0 if
+   *  whole is 0.
+   */
+  int64_t fixedPointPercent(int64_t part, int64_t whole) {
+    if (whole == 0) {
+      return 0;
+    }
+    return divideRounded(part * 100 * FIXED_POINT_SCALE, whole);
+  }
+
+  /**
+   * @brief Format a fixed-point value as decimal text without using floats
+   *  or printf.
+   *
+   * @param value The value in 1/FIXED_POINT_SCALE units.
+   * @param decimals How many decimals to round to, at most
+   *  FIXED_POINT_DECIMALS.
+   * @param showPlus Whether to write a '+' before positive values, like %+f.
+   * @param buf Where to write the text, always null terminated.
+   * @param len The size of buf.
+   * @return The length of the text, never more than len - 1.
+   */
+  size_t formatFixedPoint(int64_t value, uint8_t decimals, bool showPlus,
+                          char* buf, size_t len) {
+    if (len == 0) {
+      return 0;
+    }
+    decimals = min(decimals, FIXED_POINT_DECIMALS);
+    const bool negative = value < 0;
+    uint64_t magnitude = negative ? -static_cast<uint64_t>(value) : value;
+    const uint64_t divisor = POWERS_OF_TEN[FIXED_POINT_DECIMALS - decimals];
+    magnitude = (magnitude + divisor / 2) / divisor;
+
+    // Digits are written backwards, 64-bit division is slow on the M33 so
+    // switch to 32-bit as soon as the value fits
+    char digits[24];
+    size_t digitCount = 0;
+    while (magnitude > UINT32_MAX) {
+      digits[digitCount++] = '0' + magnitude % 10;
+      magnitude /= 10;
+    }
+    uint32_t small = magnitude;
+    do {
+      digits[digitCount++] = '0' + small % 10;
+      small /= 10;
+    } while (small > 0);
+    // At least one digit before the decimal point
+    while (digitCount <= decimals) {
+      digits[digitCount++] = '0';
+    }
+
+    size_t pos = 0;
+    if (negative) {
+      buf[pos++] = '-';
+    } else if (showPlus) {
+      buf[pos++] = '+';
+    }
+    while (digitCount > 0 && pos < len - 1) {
+      if (digitCount == decimals) {
+        buf[pos++] = '.';
+        if (pos >= len - 1) {
+          break;
+        }
+      }
+      buf[pos++] = digits[--digitCount];
+    }
+    buf[min(pos, len - 1)] = '\0';
+    return min(pos, len - 1);
+  }
+} // StockTicker
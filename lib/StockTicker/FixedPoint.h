@@ -0,0 +1,21 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_FIXEDPOINT_H
+#define PICO2W_STOCK_TICKER_FIXEDPOINT_H
+
+#include <Arduino.h>
+
+namespace StockTicker {
+  // Prices and percentages are stored in 1/FIXED_POINT_SCALE units
+  const uint8_t FIXED_POINT_DECIMALS = 4;
+  const int64_t FIXED_POINT_SCALE = 10000;
+
+  bool parseFixedPoint(const char* text, int64_t& value);
+  int64_t fixedPointPercent(int64_t part, int64_t whole);
+  size_t formatFixedPoint(int64_t value, uint8_t decimals, bool showPlus,
+                          char* buf, size_t len);
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_FIXEDPOINT_H
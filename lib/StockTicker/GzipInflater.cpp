@@ -0,0 +1,617 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <GzipInflater.h>
+
+namespace StockTicker {
+  // From RFC 1951
+  static const uint16_t LENGTH_BASE[29] = {
+    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+  static const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                           1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                           4, 4, 4, 4, 5, 5, 5, 5, 0};
+  static const uint16_t DISTANCE_BASE[30] = {
+    1,    2,    3,    4,    5,    7,    9,    13,    17,    25,
+    33,   49,   65,   97,   129,  193,  257,  385,   513,   769,
+    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+  static const uint8_t DISTANCE_EXTRA[30] = {0, 0, 0,  0,  1,  1,  2,  2,
+                                             3, 3, 4,  4,  5,  5,  6,  6,
+                                             7, 7, 8,  8,  9,  9,  10, 10,
+                                             11, 11, 12, 12, 13, 13};
+  // Order the code length code lengths are sent in
+  static const uint8_t CODE_LENGTH_ORDER[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+  // CRC-32 four bits at a time, to keep the table small
+  static const uint32_t CRC_TABLE[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
+    0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+    0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c};
+
+  const uint8_t GZIP_FLAG_HCRC = 0x02;
+  const uint8_t GZIP_FLAG_EXTRA = 0x04;
+  const uint8_t GZIP_FLAG_NAME = 0x08;
+  const uint8_t GZIP_FLAG_COMMENT = 0x10;
+  const int DECODE_NEED_BITS = -1;
+  const int DECODE_BAD_CODE = -2;
+
+  /**
+   * @brief Start decompressing a new gzip stream.
+   *
+   * @param source Where the compressed bytes come from.
+   */
+  void GzipInflater::begin(Stream* source) {
+    this->source = source;
+    this->state = InflateState::HEADER;
+    this->bits = 0;
+    this->bitCount = 0;
+    this->windowPos = 0;
+    this->pending = 0;
+    this->outputSize = 0;
+    this->crc = 0xffffffff;
+    this->lastBlock = false;
+    this->fieldPos = 0;
+    this->fieldValue = 0;
+  }
+
+  int GzipInflater::available() {
+    if (this->pending == 0) {
+      this->produce();
+    }
+    return this->pending;
+  }
+
+  int GzipInflater::read() {
+    if (this->pending == 0 && !this->produce()) {
+      return -1;
+    }
+    const uint8_t c = this->window[(this->windowPos - this->pending) &
+                                   (INFLATE_WINDOW_SIZE - 1)];
+    this->pending--;
+    return c;
+  }
+
+  int GzipInflater::peek() {
+    if (this->pending == 0 && !this->produce()) {
+      return -1;
+    }
+    return this->window[(this->windowPos - this->pending) &
+                        (INFLATE_WINDOW_SIZE - 1)];
+  }
+
+  /**
+   * @brief Decompress until there is output, or no more can be made with the
+   *  compressed bytes available.
+   *
+   * @return true if there is output to read.
+   */
+  bool GzipInflater::produce() {
+    while (this->pending == 0 && this->step()) {
+    }
+    return this->pending > 0;
+  }
+
+  /**
+   * @brief Do the next step of decoding, ex. one symbol of a block.
+   *
+   * @return true if it made progress, false if it needs more compressed
+   *  bytes, or is done or failed.
+   */
+  bool GzipInflater::step() {
+    this->fillBits();
+    switch (this->state) {
+      case InflateState::HEADER:
+        // Fallthrough
+      case InflateState::HEADER_EXTRA:
+        // Fallthrough
+      case InflateState::HEADER_NAME:
+        // Fallthrough
+      case InflateState::HEADER_COMMENT:
+        // Fallthrough
+      case InflateState::HEADER_CRC:
+        return this->stepHeader();
+      case InflateState::BLOCK_HEADER:
+        return this->stepBlockHeader();
+      case InflateState::STORED_LENGTHS:
+        // Fallthrough
+      case InflateState::STORED_DATA:
+        return this->stepStored();
+      case InflateState::TABLE_COUNTS:
+        // Fallthrough
+      case InflateState::CODE_LENGTH_CODES:
+        // Fallthrough
+      case InflateState::CODE_LENGTHS:
+        return this->stepTable();
+      case InflateState::BLOCK_DATA:
+        return this->stepBlockData();
+      case InflateState::TRAILER:
+        return this->stepTrailer();
+      default:
+        return false;
+    }
+  }
+
+  /**
+   * @brief Top up the bit buffer with what the source has, enough for the
+   *  longest symbol with its extra bits and distance.
+   */
+  void GzipInflater::fillBits() {
+    while (this->bitCount <= 56) {
+      const int c = this->source->read();
+      if (c < 0) {
+        return;
+      }
+      this->bits |= static_cast<uint64_t>(c) << this->bitCount;
+      this->bitCount += 8;
+    }
+  }
+
+  /**
+   * @brief Take a whole byte, only used when the bit buffer is byte aligned.
+   *
+   * @return int The byte, or -1 if it didn't arrive yet.
+   */
+  int GzipInflater::takeByte() {
+    if (this->bitCount < 8) {
+      return -1;
+    }
+    const int c = static_cast<uint8_t>(this->bits);
+    this->dropBits(8);
+    return c;
+  }
+
+  /**
+   * @brief Read the gzip header, RFC 1952, and skip its optional fields.
+   */
+  bool GzipInflater::stepHeader() {
+    // Skip over the optional fields that aren't there
+    if (this->state == InflateState::HEADER_EXTRA &&
+        !(this->headerFlags & GZIP_FLAG_EXTRA)) {
+      this->state = InflateState::HEADER_NAME;
+    }
+    if (this->state == InflateState::HEADER_NAME &&
+        !(this->headerFlags & GZIP_FLAG_NAME)) {
+      this->state = InflateState::HEADER_COMMENT;
+    }
+    if (this->state == InflateState::HEADER_COMMENT &&
+        !(this->headerFlags & GZIP_FLAG_COMMENT)) {
+      this->state = InflateState::HEADER_CRC;
+    }
+    if (this->state == InflateState::HEADER_CRC &&
+        !(this->headerFlags & GZIP_FLAG_HCRC)) {
+      this->state = InflateState::BLOCK_HEADER;
+      return true;
+    }
+
+    const int c = this->takeByte();
+    if (c < 0) {
+      return false;
+    }
+    const uint16_t pos = this->fieldPos++;
+    switch (this->state) {
+      case InflateState::HEADER:
+        // Magic number, method 8 (deflate), flags, then 6 bytes not needed
+        if ((pos == 0 && c != 0x1f) || (pos == 1 && c != 0x8b) ||
+            (pos == 2 && c != 8)) {
+          this->fail("not gzip");
+          return false;
+        }
+        if (pos == 3) {
+          this->headerFlags = c;
+        } else if (pos == 9) {
+          this->nextField(InflateState::HEADER_EXTRA);
+        }
+        break;
+      case InflateState::HEADER_EXTRA:
+        // 2 bytes of length, then that many bytes
+        if (pos < 2) {
+          this->fieldValue |= c << (8 * pos);
+        }
+        if (pos >= 1 && pos + 1U >= this->fieldValue + 2) {
+          this->nextField(InflateState::HEADER_NAME);
+        }
+        break;
+      case InflateState::HEADER_NAME:
+        if (c == 0) {
+          this->nextField(InflateState::HEADER_COMMENT);
+        }
+        break;
+      case InflateState::HEADER_COMMENT:
+        if (c == 0) {
+          this->nextField(InflateState::HEADER_CRC);
+        }
+        break;
+      case InflateState::HEADER_CRC:
+        if (pos == 1) {
+          this->nextField(InflateState::BLOCK_HEADER);
+        }
+        break;
+      default:
+        break;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Read the 3 bit header of a deflate block.
+   */
+  bool GzipInflater::stepBlockHeader() {
+    if (this->bitCount < 3) {
+      return false;
+    }
+    this->lastBlock = this->bits & 1;
+    const uint8_t type = (this->bits >> 1) & 3;
+    this->dropBits(3);
+    switch (type) {
+      case 0:
+        // Stored blocks start on a byte boundary
+        this->dropBits(this->bitCount % 8);
+        this->nextField(InflateState::STORED_LENGTHS);
+        break;
+      case 1:
+        this->buildFixedTables();
+        this->state = InflateState::BLOCK_DATA;
+        break;
+      case 2:
+        this->state = InflateState::TABLE_COUNTS;
+        break;
+      default:
+        this->fail("bad block type");
+        return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Copy a block that isn't compressed.
+   */
+  bool GzipInflater::stepStored() {
+    if (this->state == InflateState::STORED_LENGTHS) {
+      if (this->bitCount < 32) {
+        return false;
+      }
+      const uint16_t len = this->bits & 0xffff;
+      const uint16_t notLen = (this->bits >> 16) & 0xffff;
+      this->dropBits(32);
+      if (len != static_cast<uint16_t>(~notLen)) {
+        this->fail("bad stored block length");
+        return false;
+      }
+      this->fieldValue = len;
+      this->state = InflateState::STORED_DATA;
+      return true;
+    }
+    if (this->fieldValue == 0) {
+      this->endBlock();
+      return true;
+    }
+    // At most a long match's worth at a time, like the other blocks
+    uint16_t copied = 0;
+    while (this->fieldValue > 0 && copied < LENGTH_BASE[28]) {
+      int c = this->takeByte();
+      if (c < 0) {
+        this->fillBits();
+        c = this->takeByte();
+        if (c < 0) {
+          break;
+        }
+      }
+      this->output(c);
+      this->fieldValue--;
+      copied++;
+    }
+    return copied > 0;
+  }
+
+  /**
+   * @brief Read the code lengths of a dynamic block and build its tables.
+   */
+  bool GzipInflater::stepTable() {
+    switch (this->state) {
+      case InflateState::TABLE_COUNTS:
+        if (this->bitCount < 14) {
+          return false;
+        }
+        this->lengthCodeCount = (this->bits & 0x1f) + 257;
+        this->distanceCodeCount = ((this->bits >> 5) & 0x1f) + 1;
+        this->codeLengthCodeCount = ((this->bits >> 10) & 0xf) + 4;
+        this->dropBits(14);
+        if (this->lengthCodeCount > 286 || this->distanceCodeCount > 30) {
+          this->fail("too many codes");
+          return false;
+        }
+        memset(this->codeLengths, 0, sizeof(CODE_LENGTH_ORDER));
+        this->codeLengthsRead = 0;
+        this->state = InflateState::CODE_LENGTH_CODES;
+        return true;
+      case InflateState::CODE_LENGTH_CODES:
+        if (this->bitCount < 3) {
+          return false;
+        }
+        this->codeLengths[CODE_LENGTH_ORDER[this->codeLengthsRead++]] =
+          this->bits & 7;
+        this->dropBits(3);
+        if (this->codeLengthsRead == this->codeLengthCodeCount) {
+          // The length codes table decodes the code lengths for now
+          if (!this->buildTable(this->lengthCodes, this->codeLengths,
+                                sizeof(CODE_LENGTH_ORDER))) {
+            this->fail("bad code length codes");
+            return false;
+          }
+          this->codeLengthsRead = 0;
+          this->state = InflateState::CODE_LENGTHS;
+        }
+        return true;
+      default:
+        break;
+    }
+
+    // One code length, or a run of them, all at once or not at all
+    uint8_t pos = 0;
+    const int symbol = this->decode(this->lengthCodes, pos);
+    if (symbol == DECODE_NEED_BITS) {
+      return false;
+    }
+    const uint16_t total = this->lengthCodeCount + this->distanceCodeCount;
+    uint8_t value = symbol;
+    uint8_t repeat = 1;
+    if (symbol >= 16) {
+      // 16 repeats the last length 3-6 times, 17 and 18 repeat 0 3-10 and
+      // 11-138 times
+      static const uint8_t extraBits[3] = {2, 3, 7};
+      static const uint8_t base[3] = {3, 3, 11};
+      if (symbol == 16 && this->codeLengthsRead == 0) {
+        this->fail("nothing to repeat");
+        return false;
+      }
+      const uint8_t extra = extraBits[symbol - 16];
+      if (pos + extra > this->bitCount) {
+        return false;
+      }
+      value = symbol == 16 ? this->codeLengths[this->codeLengthsRead - 1] : 0;
+      repeat = base[symbol - 16] + ((this->bits >> pos) & ((1 << extra) - 1));
+      pos += extra;
+    }
+    if (symbol < 0 || this->codeLengthsRead + repeat > total) {
+      this->fail("bad code lengths");
+      return false;
+    }
+    this->dropBits(pos);
+    memset(this->codeLengths + this->codeLengthsRead, value, repeat);
+    this->codeLengthsRead += repeat;
+    if (this->codeLengthsRead < total) {
+      return true;
+    }
+    if (this->codeLengths[256] == 0 ||
+        !this->buildTable(this->lengthCodes, this->codeLengths,
+                          this->lengthCodeCount) ||
+        !this->buildTable(this->distanceCodes,
+                          this->codeLengths + this->lengthCodeCount,
+                          this->distanceCodeCount)) {
+      this->fail("bad code lengths");
+      return false;
+    }
+    this->state = InflateState::BLOCK_DATA;
+    return true;
+  }
+
+  /**
+   * @brief Decode one literal, match, or the end of the block. A match is
+   *  only decoded once all of its bits arrived, so nothing is half done.
+   */
+  bool GzipInflater::stepBlockData() {
+    uint8_t pos = 0;
+    int symbol = this->decode(this->lengthCodes, pos);
+    if (symbol == DECODE_NEED_BITS) {
+      return false;
+    }
+    if (symbol < 256) {
+      if (symbol < 0) {
+        this->fail("bad literal/length code");
+        return false;
+      }
+      this->dropBits(pos);
+      this->output(symbol);
+      return true;
+    }
+    if (symbol == 256) {
+      this->dropBits(pos);
+      this->endBlock();
+      return true;
+    }
+
+    symbol -= 257;
+    if (symbol >= 29) {
+      this->fail("bad length code");
+      return false;
+    }
+    uint8_t extra = LENGTH_EXTRA[symbol];
+    if (pos + extra > this->bitCount) {
+      return false;
+    }
+    const uint16_t length =
+      LENGTH_BASE[symbol] + ((this->bits >> pos) & ((1 << extra) - 1));
+    pos += extra;
+
+    symbol = this->decode(this->distanceCodes, pos);
+    if (symbol == DECODE_NEED_BITS) {
+      return false;
+    }
+    if (symbol < 0 || symbol >= 30) {
+      this->fail("bad distance code");
+      return false;
+    }
+    extra = DISTANCE_EXTRA[symbol];
+    if (pos + extra > this->bitCount) {
+      return false;
+    }
+    const uint16_t distance =
+      DISTANCE_BASE[symbol] + ((this->bits >> pos) & ((1 << extra) - 1));
+    pos += extra;
+    if (distance > this->outputSize) {
+      this->fail("distance too far back");
+      return false;
+    }
+    this->dropBits(pos);
+    // Byte by byte, the copy can overlap what it's copying
+    for (uint16_t i = 0; i < length; i++) {
+      this->output(this->window[(this->windowPos - distance) &
+                                (INFLATE_WINDOW_SIZE - 1)]);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Check the CRC-32 and size in the gzip trailer.
+   */
+  bool GzipInflater::stepTrailer() {
+    const int c = this->takeByte();
+    if (c < 0) {
+      return false;
+    }
+    this->fieldValue |= static_cast<uint32_t>(c) << (8 * (this->fieldPos % 4));
+    this->fieldPos++;
+    if (this->fieldPos == 4) {
+      if (this->fieldValue != ~this->crc) {
+        this->fail("CRC mismatch");
+        return false;
+      }
+      this->fieldValue = 0;
+    } else if (this->fieldPos == 8) {
+      if (this->fieldValue != this->outputSize) {
+        this->fail("size mismatch");
+        return false;
+      }
+      this->state = InflateState::DONE;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Go on to the next block, or to the trailer after the last one.
+   */
+  void GzipInflater::endBlock() {
+    if (!this->lastBlock) {
+      this->state = InflateState::BLOCK_HEADER;
+      return;
+    }
+    // The trailer starts on a byte boundary
+    this->dropBits(this->bitCount % 8);
+    this->nextField(InflateState::TRAILER);
+  }
+
+  /**
+   * @brief Decode one Huffman code starting pos bits into the bit buffer,
+   *  without using up the bits.
+   *
+   * @param table The code.
+   * @param pos Where the code starts, moved to where it ends.
+   * @return int The symbol, DECODE_NEED_BITS if the code didn't all arrive
+   *  yet, or DECODE_BAD_CODE.
+   */
+  int GzipInflater::decode(const HuffmanTable& table, uint8_t& pos) const {
+    // Codes of each length are consecutive, starting from first
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (uint8_t len = 1; len < 16; len++) {
+      if (pos >= this->bitCount) {
+        return DECODE_NEED_BITS;
+      }
+      code |= (this->bits >> pos++) & 1;
+      const int count = table.counts[len];
+      if (code - first < count) {
+        return table.symbols[index + code - first];
+      }
+      index += count;
+      first = (first + count) << 1;
+      code <<= 1;
+    }
+    return DECODE_BAD_CODE;
+  }
+
+  /**
+   * @brief Build a canonical Huffman code from the length of each symbol's
+   *  code.
+   *
+   * @param table Where to build it.
+   * @param lengths Length of each symbol's code, 0 if it has none.
+   * @param count How many symbols.
+   * @return true if the lengths make a valid code.
+   */
+  bool GzipInflater::buildTable(HuffmanTable& table, const uint8_t* lengths,
+                                uint16_t count) {
+    memset(table.counts, 0, sizeof(table.counts));
+    for (uint16_t i = 0; i < count; i++) {
+      table.counts[lengths[i]]++;
+    }
+    if (table.counts[0] == count) {
+      return true; // No codes, ex. no distances in a block of only literals
+    }
+    // More codes of a length than there's room for
+    int32_t left = 1;
+    for (uint8_t len = 1; len < 16; len++) {
+      left = (left << 1) - table.counts[len];
+      if (left < 0) {
+        return false;
+      }
+    }
+    uint16_t offsets[16];
+    offsets[1] = 0;
+    for (uint8_t len = 1; len < 15; len++) {
+      offsets[len + 1] = offsets[len] + table.counts[len];
+    }
+    for (uint16_t i = 0; i < count; i++) {
+      if (lengths[i] != 0) {
+        table.symbols[offsets[lengths[i]]++] = i;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Build the tables of blocks compressed with the fixed codes.
+   */
+  void GzipInflater::buildFixedTables() {
+    memset(this->codeLengths, 8, 144);
+    memset(this->codeLengths + 144, 9, 256 - 144);
+    memset(this->codeLengths + 256, 7, 280 - 256);
+    memset(this->codeLengths + 280, 8, INFLATE_MAX_CODES - 280);
+    this->buildTable(this->lengthCodes, this->codeLengths, INFLATE_MAX_CODES);
+    memset(this->codeLengths, 5, 30);
+    this->buildTable(this->distanceCodes, this->codeLengths, 30);
+  }
+
+  /**
+   * @brief Add a decompressed byte to the window, to be read.
+   *
+   * @param c The byte.
+   */
+  void GzipInflater::output(uint8_t c) {
+    this->window[this->windowPos] = c;
+    this->windowPos = (this->windowPos + 1) & (INFLATE_WINDOW_SIZE - 1);
+    this->pending++;
+    this->outputSize++;
+    this->crc ^= c;
+    this->crc = (this->crc >> 4) ^ CRC_TABLE[this->crc & 0xf];
+    this->crc = (this->crc >> 4) ^ CRC_TABLE[this->crc & 0xf];
+  }
+
+  /**
+   * @brief Start reading the next field, stored block or trailer.
+   *
+   * @param next Which one.
+   */
+  void GzipInflater::nextField(InflateState next) {
+    this->state = next;
+    this->fieldPos = 0;
+    this->fieldValue = 0;
+  }
+
+  void GzipInflater::fail(const char* reason) {
+    LOG_WARN("Failed to inflate gzip body: %s", reason);
+    this->state = InflateState::ERROR;
+    this->pending = 0;
+  }
+} // StockTicker
@@ -0,0 +1,151 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_GZIPINFLATER_H
+#define PICO2W_STOCK_TICKER_GZIPINFLATER_H
+
+#include <Arduino.h>
+#include <Log.h>
+
+namespace StockTicker {
+  // Deflate can copy from up to 32 KB back, so the window can't be smaller
+  const size_t INFLATE_WINDOW_SIZE = 32768;
+  const uint16_t INFLATE_MAX_CODES = 288;
+  // Literal/length codes plus distance codes of a dynamic block
+  const uint16_t INFLATE_MAX_CODE_LENGTHS = 320;
+
+  enum class InflateStatus : uint8_t {
+    IN_PROGRESS,
+    DONE,
+    ERROR
+  };
+
+  /**
+   * @brief Streaming gzip decoder. It is a Stream of the decompressed data
+   *  that pulls compressed bytes from another Stream, ex. the body of an
+   *  HttpKeepAliveClient, as they arrive.
+   *
+   * Like the source, it never waits: read() returns -1 when no more data can
+   * be decompressed until more compressed bytes arrive. Nothing but the
+   * 32 KB window the format needs is buffered, so bodies of any size are
+   * decompressed straight into the parser. The CRC and size in the gzip
+   * trailer are checked.
+   */
+  class GzipInflater : public Stream {
+    public:
+      GzipInflater() = default;
+      ~GzipInflater() override = default;
+
+      void begin(Stream* source);
+
+      /**
+       * @brief Get whether the whole gzip stream was decompressed, or why it
+       *  couldn't be.
+       *
+       * @return InflateStatus
+       */
+      InflateStatus getStatus() const {
+        if (this->state == InflateState::DONE) {
+          return InflateStatus::DONE;
+        }
+        return this->state == InflateState::ERROR ? InflateStatus::ERROR
+                                                  : InflateStatus::IN_PROGRESS;
+      }
+
+      // Stream interface for reading the decompressed data
+      int available() override;
+      int read() override;
+      int peek() override;
+      size_t write(uint8_t c) override {
+        return 0; // Read only
+      }
+
+    protected:
+      enum class InflateState : uint8_t {
+        HEADER,
+        HEADER_EXTRA,
+        HEADER_NAME,
+        HEADER_COMMENT,
+        HEADER_CRC,
+        BLOCK_HEADER,
+        STORED_LENGTHS,
+        STORED_DATA,
+        TABLE_COUNTS,
+        CODE_LENGTH_CODES,
+        CODE_LENGTHS,
+        BLOCK_DATA,
+        TRAILER,
+        DONE,
+        ERROR
+      };
+
+      // Canonical Huffman code, decoded one bit at a time
+      // clang-format off
+      struct HuffmanTable {
+        uint16_t counts[16];
+        uint16_t symbols[INFLATE_MAX_CODES];
+      };
+      // clang-format on
+
+      Stream* source = nullptr;
+      InflateState state = InflateState::ERROR;
+
+      // Bits from the source not used yet, least significant first
+      uint64_t bits = 0;
+      uint8_t bitCount = 0;
+
+      uint8_t window[INFLATE_WINDOW_SIZE];
+      // Where the next byte goes, and how many before it weren't read yet
+      uint16_t windowPos = 0;
+      uint16_t pending = 0;
+      uint32_t outputSize = 0;
+      uint32_t crc = 0;
+
+      HuffmanTable lengthCodes;
+      HuffmanTable distanceCodes;
+      uint8_t codeLengths[INFLATE_MAX_CODE_LENGTHS];
+      uint16_t lengthCodeCount = 0;
+      uint16_t distanceCodeCount = 0;
+      uint16_t codeLengthCodeCount = 0;
+      uint16_t codeLengthsRead = 0;
+
+      bool lastBlock = false;
+      uint8_t headerFlags = 0;
+      // Position in, and value of, the current header field or trailer.
+      // The value is the bytes left in a stored block.
+      uint16_t fieldPos = 0;
+      uint32_t fieldValue = 0;
+
+      /**
+       * @brief Use up bits from the bit buffer.
+       *
+       * @param count How many.
+       */
+      void dropBits(uint8_t count) {
+        this->bits >>= count;
+        this->bitCount -= count;
+      }
+
+      void fillBits();
+      int takeByte();
+      bool produce();
+      bool step();
+      bool stepHeader();
+      bool stepBlockHeader();
+      bool stepStored();
+      bool stepTable();
+      bool stepBlockData();
+      bool stepTrailer();
+      int decode(const HuffmanTable& table, uint8_t& pos) const;
+      bool buildTable(HuffmanTable& table, const uint8_t* lengths,
+                      uint16_t count);
+      void buildFixedTables();
+      void endBlock();
+      void output(uint8_t c);
+      void nextField(InflateState next);
+      void fail(const char* reason);
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_GZIPINFLATER_H
@@ -0,0 +1,570 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <HttpKeepAliveClient.h>
+
+namespace StockTicker {
+  /**
+   * @brief Parse an HTTP date, ex. "Sun, 06 Nov 1994 08:49:37 GMT".
+   *
+   * @param str The date.
+   * @return uint32_t The Unix timestamp in seconds, or 0 if invalid.
+   */
+  uint32_t parseHttpDate(const char* str) {
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    const char* comma = strchr(str, ',');
+    if (comma == nullptr) {
+      return 0;
+    }
+    char month[4];
+    int day, year, hour, minute, second;
+    if (sscanf(comma + 1, " %d %3s %d %d:%d:%d", &day, month, &year, &hour,
+               &minute, &second) != 6) {
+      return 0;
+    }
+    const char* found = strstr(months, month);
+    if (found == nullptr || strlen(month) != 3 || year < 1970) {
+      return 0;
+    }
+    int m = (found - months) / 3 + 1;
+    // Days since 1970-01-01, from Howard Hinnant's days_from_civil
+    int y = year - (m <= 2);
+    const int era = y / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    const int32_t days = era * 146097 + doe - 719468;
+    return static_cast<uint32_t>(days) * 86400 + hour * 3600 + minute * 60 +
+           second;
+  }
+
+  /**
+   * @brief Initialize and build the request.
+   *
+   * @param host The host to connect to, must stay valid until end().
+   * @param port The port to connect to, usually 443.
+   * @param path The path and query string to GET.
+   * @param headers Extra request headers, each formatted as "Name: value\r\n".
+   * @return true if the request fit in MAX_REQUEST_LEN.
+   */
+  bool HttpKeepAliveClient::begin(const char* host, uint16_t port,
+                                  const char* path, const char* headers) {
+    this->disconnect();
+    this->state = HttpRequestState::IDLE;
+    this->host = host;
+    this->port = port;
+    this->secureClient.setInsecure();
+    this->setTimeout(this->responseTimeout);
+    const int len = snprintf(this->request, MAX_REQUEST_LEN,
+                             "GET %s HTTP/1.1\r\n"
+                             "Host: %s\r\n"
+                             "Connection: keep-alive\r\n"
+                             "%s"
+                             "\r\n",
+                             path, host, headers);
+    if (len < 0 || static_cast<size_t>(len) >= MAX_REQUEST_LEN) {
+      this->requestLen = 0;
+      return false;
+    }
+    this->requestLen = len;
+    this->pathEnd = REQUEST_PATH_START + strlen(path);
+    return true;
+  }
+
+  /**
+   * @brief Change the path of the prebuilt request, keeping the headers and
+   *  the connection. Only call this between requests.
+   *
+   * @param path The new path and query string to GET.
+   * @return true if the request still fits in MAX_REQUEST_LEN. The request
+   *  is unchanged otherwise.
+   */
+  bool HttpKeepAliveClient::setPath(const char* path) {
+    if (this->requestLen == 0) {
+      return false;
+    }
+    const size_t pathLen = strlen(path);
+    const size_t tailLen = this->requestLen - this->pathEnd;
+    if (REQUEST_PATH_START + pathLen + tailLen >= MAX_REQUEST_LEN) {
+      return false;
+    }
+    // Move everything after the path (the headers) to fit the new path
+    memmove(this->request + REQUEST_PATH_START + pathLen,
+            this->request + this->pathEnd, tailLen);
+    memcpy(this->request + REQUEST_PATH_START, path, pathLen);
+    this->pathEnd = REQUEST_PATH_START + pathLen;
+    this->requestLen = this->pathEnd + tailLen;
+    this->request[this->requestLen] = '\0';
+    return true;
+  }
+
+  /**
+   * @brief Close the connection and forget the request.
+   */
+  void HttpKeepAliveClient::end() {
+    this->cancel();
+    this->requestLen = 0;
+  }
+
+  /**
+   * @brief Start sending the request. Opens a new connection on the next
+   *  poll() if there isn't one, and retries once on a fresh connection if the
+   *  server had silently closed the old one.
+   */
+  void HttpKeepAliveClient::startGet() {
+    if (this->requestLen == 0) {
+      this->fail(HTTP_ERROR_NOT_INITIALIZED);
+      return;
+    }
+    this->bodyState = BodyState::DONE;
+    this->statusCode = 0;
+    this->rateLimitInfo = {-1, -1, 0, 0};
+    this->retried = false;
+    this->pipelineReady = false;
+    this->pendingResponses = 0;
+    this->requestSentTime = 0;
+    this->reusedConnection = this->client->connected();
+    if (this->reusedConnection) {
+      this->sentLen = 0;
+      this->setState(HttpRequestState::SENDING);
+    } else {
+      this->setState(HttpRequestState::CONNECTING);
+    }
+  }
+
+  /**
+   * @brief Pipeline another request with a different path on the connection
+   *  of the current one, see canQueueGet(). Its response is read once the
+   *  responses before it are finished.
+   *
+   * @param path The path and query string to GET.
+   * @return true if the request was queued. If the server closes the
+   *  connection before answering it, the state goes to IDLE without reading
+   *  its response, so check getPendingResponses() before then.
+   */
+  bool HttpKeepAliveClient::queueGet(const char* path) {
+    if (!this->canQueueGet() || !this->setPath(path)) {
+      return false;
+    }
+    this->sentLen = 0;
+    this->pendingResponses++;
+    // Whatever doesn't fit in the TLS buffer is sent by the next polls
+    this->writeRequest();
+    return true;
+  }
+
+  /**
+   * @brief Do the next bounded piece of work for the current request.
+   *
+   * @return HttpRequestState The state after this step.
+   */
+  HttpRequestState HttpKeepAliveClient::poll() {
+    // The rest of a pipelined request goes out while reading responses
+    if (this->pendingResponses > 0 && this->sentLen < this->requestLen &&
+        !this->writeRequest()) {
+      this->fail(HTTP_ERROR_SEND_FAILED);
+      return this->state;
+    }
+    switch (this->state) {
+      case HttpRequestState::CONNECTING: {
+        // Blocking, but only happens when the server closed the connection
+        this->disconnect();
+        const uint32_t connectStartTime = micros();
+        if (!this->client->connect(this->host, this->port)) {
+          this->fail(HTTP_ERROR_CONNECTION_FAILED);
+          break;
+        }
+        this->timings.connect = micros() - connectStartTime;
+        this->sentLen = 0;
+        this->setState(HttpRequestState::SENDING);
+        break;
+      }
+      case HttpRequestState::SENDING:
+        this->pollSend();
+        break;
+      case HttpRequestState::READING_HEAD:
+        this->pollHead();
+        break;
+      case HttpRequestState::READING_BODY:
+        // The body is read through the Stream interface, only check progress
+        if (this->bodyComplete()) {
+          break;
+        }
+        if (!this->untilClose && this->rxPos >= this->rxLen &&
+            this->client->available() <= 0 && !this->client->connected()) {
+          // Closed before the whole body arrived, no need to wait it out
+          this->fail(HTTP_ERROR_CONNECTION_LOST);
+        } else if (this->stepTimedOut()) {
+          this->fail(HTTP_ERROR_READ_TIMEOUT);
+        }
+        break;
+      case HttpRequestState::FINISHING:
+        this->pollFinish();
+        break;
+      default:
+        break;
+    }
+    return this->state;
+  }
+
+  /**
+   * @brief Stop reading the current response. Whatever is left of the body
+   *  is skipped by the next calls to poll() so the next response starts in the
+   *  right place, then the state goes back to IDLE, or to READING_HEAD if a
+   *  pipelined response is next.
+   */
+  void HttpKeepAliveClient::finishResponse() {
+    if (this->state == HttpRequestState::ERROR) {
+      this->state = HttpRequestState::IDLE;
+      return;
+    }
+    this->setState(HttpRequestState::FINISHING);
+  }
+
+  /**
+   * @brief Abort the current request. The connection is closed since the
+   *  server may still be sending the response.
+   */
+  void HttpKeepAliveClient::cancel() {
+    if (this->state != HttpRequestState::IDLE) {
+      this->disconnect();
+    }
+    this->state = HttpRequestState::IDLE;
+  }
+
+  int HttpKeepAliveClient::available() {
+    if (this->bodyState != BodyState::DATA) {
+      return this->nextBodyByte(false) < 0 ? 0 : 1;
+    }
+    size_t avail = this->rxLen - this->rxPos;
+    if (avail == 0) {
+      avail = max(this->client->available(), 0);
+    }
+    if (!this->untilClose && avail > this->remaining) {
+      avail = this->remaining;
+    }
+    return avail;
+  }
+
+  int HttpKeepAliveClient::read() {
+    return this->nextBodyByte(true);
+  }
+
+  int HttpKeepAliveClient::peek() {
+    return this->nextBodyByte(false);
+  }
+
+  void HttpKeepAliveClient::fail(int32_t error) {
+    this->disconnect();
+    this->statusCode = error;
+    this->state = HttpRequestState::ERROR;
+  }
+
+  void HttpKeepAliveClient::retryOrFail(int32_t error) {
+    // A reused connection may have been closed by the server while idle.
+    // Never once it answered, the request may have been replaced by a
+    // pipelined one.
+    if (this->reusedConnection && !this->retried && !this->pipelineReady) {
+      this->retried = true;
+      this->reusedConnection = false;
+      this->disconnect();
+      this->setState(HttpRequestState::CONNECTING);
+      return;
+    }
+    this->fail(error);
+  }
+
+  void HttpKeepAliveClient::disconnect() {
+    this->client->stop();
+    this->rxPos = 0;
+    this->rxLen = 0;
+    this->bodyState = BodyState::DONE;
+    this->pipelineReady = false;
+    this->pendingResponses = 0;
+  }
+
+  bool HttpKeepAliveClient::fillRx() {
+    if (this->rxPos < this->rxLen) {
+      return true;
+    }
+    const int avail = this->client->available();
+    if (avail <= 0) {
+      return false;
+    }
+    const int n = this->client->read(
+      this->rxBuf, min(static_cast<size_t>(avail), RX_BUFFER_LEN));
+    if (n <= 0) {
+      return false;
+    }
+    this->rxPos = 0;
+    this->rxLen = n;
+    this->bytesReceived += n;
+    // New data counts as progress for the step timeout
+    this->stepDeadline = millis() + this->responseTimeout;
+    return true;
+  }
+
+  /**
+   * @brief Write as much of the rest of the request as the connection takes.
+   *
+   * @return false if the connection is closed.
+   */
+  bool HttpKeepAliveClient::writeRequest() {
+    if (!this->client->connected()) {
+      return false;
+    }
+    // The request fits in one TLS record, so this rarely takes more than one
+    // call. A partial write continues from where it stopped on the next poll.
+    const size_t written = this->client->write(
+      reinterpret_cast<const uint8_t*>(this->request) + this->sentLen,
+      this->requestLen - this->sentLen);
+    if (written > 0) {
+      this->sentLen += written;
+      this->stepDeadline = millis() + this->responseTimeout;
+    }
+    return true;
+  }
+
+  void HttpKeepAliveClient::pollSend() {
+    if (!this->writeRequest()) {
+      this->retryOrFail(HTTP_ERROR_SEND_FAILED);
+      return;
+    }
+    if (this->sentLen >= this->requestLen) {
+      this->requestSentTime = micros();
+      this->headLineLen = 0;
+      this->hasStatusLine = false;
+      this->setState(HttpRequestState::READING_HEAD);
+    } else if (this->stepTimedOut()) {
+      this->retryOrFail(HTTP_ERROR_SEND_FAILED);
+    }
+  }
+
+  void HttpKeepAliveClient::pollHead() {
+    // At most one buffer's worth per call
+    for (size_t i = 0; i < RX_BUFFER_LEN; i++) {
+      if (!this->fillRx()) {
+        if (!this->client->connected()) {
+          this->retryOrFail(HTTP_ERROR_CONNECTION_LOST);
+        } else if (this->stepTimedOut()) {
+          this->fail(HTTP_ERROR_READ_TIMEOUT);
+        }
+        return;
+      }
+      if (this->requestSentTime != 0) {
+        this->timings.firstByte = micros() - this->requestSentTime;
+        this->requestSentTime = 0;
+      }
+      const char c = static_cast<char>(this->rxBuf[this->rxPos++]);
+      if (c == '\r') {
+        continue;
+      }
+      if (c != '\n') {
+        if (this->headLineLen < MAX_HEADER_LINE_LEN - 1) {
+          this->headLine[this->headLineLen++] = c; // Overlong lines truncated
+        }
+        continue;
+      }
+      this->headLine[this->headLineLen] = '\0';
+      this->headLineLen = 0;
+      if (!this->handleHeadLine()) {
+        return; // Done with the head, or failed
+      }
+    }
+  }
+
+  /**
+   * @brief Handle one complete line of the status line and headers.
+   *
+   * @return true if more lines are expected.
+   */
+  bool HttpKeepAliveClient::handleHeadLine() {
+    const char* line = this->headLine;
+    if (!this->hasStatusLine) {
+      // Ex. "HTTP/1.1 200 OK"
+      if (strncmp(line, "HTTP/1.", 7) != 0 || strlen(line) < 12) {
+        this->fail(HTTP_ERROR_BAD_RESPONSE);
+        return false;
+      }
+      this->hasStatusLine = true;
+      this->statusCode = atoi(line + 9);
+      this->rateLimitInfo = {-1, -1, 0, 0};
+      this->retryAfterDate = 0;
+      // HTTP/1.0 servers close unless they say otherwise
+      this->closeAfterResponse = line[7] == '0';
+      this->chunked = false;
+      this->gzipEncoded = false;
+      this->untilClose = true;
+      this->remaining = 0;
+      return true;
+    }
+
+    if (line[0] == '\0') { // End of headers
+      if (this->retryAfterDate > 0 && this->rateLimitInfo.date > 0) {
+        this->rateLimitInfo.retryAfter =
+          this->retryAfterDate > this->rateLimitInfo.date
+            ? this->retryAfterDate - this->rateLimitInfo.date
+            : 0;
+      }
+      if (this->chunked) {
+        this->untilClose = false;
+        this->remaining = 0;
+        this->bodyState = BodyState::CHUNK_SIZE;
+      } else {
+        this->bodyState = BodyState::DATA;
+      }
+      if (this->untilClose) {
+        this->closeAfterResponse = true;
+      }
+      // Requests sent now would only be dropped if the server closes
+      this->pipelineReady = !this->closeAfterResponse;
+      this->setState(HttpRequestState::READING_BODY);
+      return false;
+    }
+    if (strncasecmp(line, "Content-Length:", 15) == 0) {
+      this->remaining = strtoul(line + 15, nullptr, 10);
+      this->untilClose = false;
+    } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+      this->chunked = strstr(line + 18, "chunked") != nullptr;
+    } else if (strncasecmp(line, "Content-Encoding:", 17) == 0) {
+      this->gzipEncoded = strstr(line + 17, "gzip") != nullptr;
+    } else if (strncasecmp(line, "Connection:", 11) == 0) {
+      const char* value = line + 11;
+      while (*value == ' ') {
+        value++;
+      }
+      this->closeAfterResponse = strncasecmp(value, "close", 5) == 0;
+    } else if (strncasecmp(line, "Retry-After:", 12) == 0) {
+      // Either a number of seconds or a date
+      const char* value = line + 12;
+      while (*value == ' ') {
+        value++;
+      }
+      if (*value >= '0' && *value <= '9') {
+        this->rateLimitInfo.retryAfter = atoi(value);
+      } else {
+        this->retryAfterDate = parseHttpDate(value);
+      }
+    } else if (strncasecmp(line, "X-RateLimit-Remaining:", 22) == 0) {
+      this->rateLimitInfo.remaining = atoi(line + 22);
+    } else if (strncasecmp(line, "X-RateLimit-Reset:", 18) == 0) {
+      this->rateLimitInfo.reset = strtoul(line + 18, nullptr, 10);
+    } else if (strncasecmp(line, "Date:", 5) == 0) {
+      this->rateLimitInfo.date = parseHttpDate(line + 5);
+    }
+    return true;
+  }
+
+  void HttpKeepAliveClient::pollFinish() {
+    // No need to skip the rest if the connection won't be reused
+    bool closeConnection = this->closeAfterResponse;
+    // At most one buffer's worth per call
+    for (size_t i = 0; !closeConnection && i < RX_BUFFER_LEN; i++) {
+      if (this->bodyComplete()) {
+        break;
+      }
+      if (this->nextBodyByte(true) < 0) {
+        if (this->client->connected() && !this->stepTimedOut()) {
+          return; // Wait for the rest
+        }
+        // Can't skip the rest, so the connection can't be reused
+        closeConnection = true;
+      }
+    }
+    if (!closeConnection && !this->bodyComplete()) {
+      return; // Continue on the next poll
+    }
+    if (closeConnection) {
+      // Also drops any pipelined requests the server won't answer now
+      this->disconnect();
+    }
+    if (this->pendingResponses > 0) {
+      // Straight on to the response to the next pipelined request
+      this->pendingResponses--;
+      this->headLineLen = 0;
+      this->hasStatusLine = false;
+      this->setState(HttpRequestState::READING_HEAD);
+      return;
+    }
+    this->state = HttpRequestState::IDLE;
+  }
+
+  /**
+   * @brief Get the next byte of the body, handling chunked framing. Never
+   *  waits for data.
+   *
+   * @param consume Whether to consume the byte or only peek at it.
+   * @return The byte, or -1 if none is available yet or the body is done.
+   */
+  int HttpKeepAliveClient::nextBodyByte(bool consume) {
+    while (true) {
+      if (this->bodyState == BodyState::DONE) {
+        return -1;
+      }
+      if (this->bodyState == BodyState::DATA) {
+        if (!this->untilClose && this->remaining == 0) {
+          this->bodyState =
+            this->chunked ? BodyState::CHUNK_DATA_END : BodyState::DONE;
+          continue;
+        }
+        if (!this->fillRx()) {
+          if (this->untilClose && !this->client->connected()) {
+            this->bodyState = BodyState::DONE;
+          }
+          return -1;
+        }
+        const int c = this->rxBuf[this->rxPos];
+        if (consume) {
+          this->rxPos++;
+          this->remaining--;
+        }
+        return c;
+      }
+
+      // Chunk framing, ex. "1a2;ext=1\r\n<data>\r\n0\r\n\r\n"
+      if (!this->fillRx()) {
+        return -1;
+      }
+      const char c = static_cast<char>(this->rxBuf[this->rxPos++]);
+      switch (this->bodyState) {
+        case BodyState::CHUNK_SIZE:
+          if (c >= '0' && c <= '9') {
+            this->remaining = (this->remaining << 4) | (c - '0');
+          } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+            this->remaining = (this->remaining << 4) | ((c | 0x20) - 'a' + 10);
+          } else if (c == ';') {
+            this->bodyState = BodyState::CHUNK_EXTENSION;
+          }
+          // Fallthrough
+        case BodyState::CHUNK_EXTENSION:
+          if (c == '\n') {
+            this->bodyState = this->remaining == 0
+                                ? BodyState::TRAILER_LINE_START
+                                : BodyState::DATA;
+          }
+          break;
+        case BodyState::CHUNK_DATA_END:
+          if (c == '\n') {
+            this->remaining = 0;
+            this->bodyState = BodyState::CHUNK_SIZE;
+          }
+          break;
+        case BodyState::TRAILER_LINE_START:
+          if (c == '\n') {
+            this->bodyState = BodyState::DONE;
+          } else if (c != '\r') {
+            this->bodyState = BodyState::TRAILER_LINE;
+          }
+          break;
+        case BodyState::TRAILER_LINE:
+          if (c == '\n') {
+            this->bodyState = BodyState::TRAILER_LINE_START;
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+} // StockTicker
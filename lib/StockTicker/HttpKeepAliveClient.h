@@ -0,0 +1,314 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_HTTPKEEPALIVECLIENT_H
+#define PICO2W_STOCK_TICKER_HTTPKEEPALIVECLIENT_H
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+
+namespace StockTicker {
+  const size_t MAX_REQUEST_LEN = 640;
+  const size_t MAX_HEADER_LINE_LEN = 128;
+  const size_t RX_BUFFER_LEN = 256;
+  // Length of "GET " before the path in the request
+  const size_t REQUEST_PATH_START = 4;
+
+  // Negative values of HttpKeepAliveClient::getStatusCode(), like HTTPClient's
+  const int32_t HTTP_ERROR_CONNECTION_FAILED = -1;
+  const int32_t HTTP_ERROR_SEND_FAILED = -2;
+  const int32_t HTTP_ERROR_CONNECTION_LOST = -3;
+  const int32_t HTTP_ERROR_READ_TIMEOUT = -4;
+  const int32_t HTTP_ERROR_BAD_RESPONSE = -5;
+  const int32_t HTTP_ERROR_NOT_INITIALIZED = -6;
+
+  /**
+   * @brief What the server said about rate limiting in the last response.
+   *  Times are Unix timestamps in seconds, 0 if not sent.
+   */
+  // clang-format off
+  struct HttpRateLimitInfo {
+    // Retry-After, -1 if not sent
+    int32_t retryAfter;
+    // X-RateLimit-Remaining, -1 if not sent
+    int32_t remaining;
+    // X-RateLimit-Reset
+    uint32_t reset;
+    // Date, the server's clock
+    uint32_t date;
+  };
+  // clang-format on
+
+  /**
+   * @brief How long the steps of the requests since the last
+   *  HttpKeepAliveClient::takeTimings() took, in microseconds. 0 if the step
+   *  didn't happen, ex. no connect on a reused connection.
+   */
+  // clang-format off
+  struct HttpTimings {
+    // DNS, TCP connect and TLS handshake, WiFiClientSecure does them all at
+    // once
+    uint32_t connect;
+    // From sending a request (not a pipelined one) to the first byte back
+    uint32_t firstByte;
+  };
+  // clang-format on
+
+  uint32_t parseHttpDate(const char* str);
+
+  /**
+   * @brief Steps of a request made by HttpKeepAliveClient.
+   */
+  enum class HttpRequestState : uint8_t {
+    IDLE,
+    CONNECTING,
+    SENDING,
+    READING_HEAD,
+    READING_BODY,
+    FINISHING,
+    ERROR
+  };
+
+  /**
+   * @brief Minimal HTTP/1.1 client that sends the same prebuilt GET request
+   *  over one persistent TLS connection.
+   *
+   * The request is formatted once in begin(). The connection is only
+   * reopened when the server closes it, so most polls skip DNS, TCP and the
+   * TLS handshake.
+   *
+   * Requests are non-blocking: startGet() begins one and every call to poll()
+   * does a bounded amount of work. Once the state is READING_BODY, the client
+   * itself is a Stream of the (de-chunked) response body that never waits for
+   * data. Each step times out after responseTimeout milliseconds without
+   * progress. The exception is opening a new connection, as the TLS handshake
+   * in WiFiClientSecure::connect() can't be split up.
+   *
+   * More requests (with a different path) can be pipelined with queueGet()
+   * once the server has started answering the first one. They are sent
+   * right away, and each response is read in order once the one before it
+   * is finished, without going back to IDLE in between.
+   */
+  class HttpKeepAliveClient : public Stream {
+    public:
+      HttpKeepAliveClient() = default;
+      ~HttpKeepAliveClient() override = default;
+
+      /**
+       * @brief Send requests over another connection instead of the built in
+       *  WiFiClientSecure, ex. a scripted one in host tests. Call before
+       *  begin().
+       *
+       * @param client The connection, must stay valid while this client is
+       *  used.
+       */
+      void setClient(Client* client) {
+        this->client = client;
+      }
+
+      bool begin(const char* host, uint16_t port, const char* path,
+                 const char* headers);
+      bool setPath(const char* path);
+      void end();
+
+      void startGet();
+      bool queueGet(const char* path);
+      HttpRequestState poll();
+      void finishResponse();
+      void cancel();
+
+      /**
+       * @brief Get the current step of the request.
+       *
+       * @return HttpRequestState
+       */
+      HttpRequestState getState() const {
+        return this->state;
+      }
+
+      /**
+       * @brief Get the HTTP status code of the response once the state is
+       *  READING_BODY, or a negative HTTP_ERROR_* value if the state is ERROR.
+       *
+       * @return int32_t
+       */
+      int32_t getStatusCode() const {
+        return this->statusCode;
+      }
+
+      /**
+       * @brief Check if the body of the current response is gzip
+       *  compressed. The body is read as is either way, ex. through a
+       *  GzipInflater.
+       *
+       * @return true if the server sent "Content-Encoding: gzip".
+       */
+      bool isGzipEncoded() const {
+        return this->gzipEncoded;
+      }
+
+      /**
+       * @brief Get the rate limiting headers of the last response.
+       *
+       * @return const HttpRateLimitInfo&
+       */
+      const HttpRateLimitInfo& getRateLimitInfo() const {
+        return this->rateLimitInfo;
+      }
+
+      /**
+       * @brief Get the timings measured since the last call, and clear them.
+       *
+       * @return HttpTimings
+       */
+      HttpTimings takeTimings() {
+        const HttpTimings timings = this->timings;
+        this->timings = {0, 0};
+        return timings;
+      }
+
+      /**
+       * @brief Get how many bytes were received since the last call,
+       *  headers included, and clear the count.
+       *
+       * @return uint32_t
+       */
+      uint32_t takeBytesReceived() {
+        const uint32_t bytes = this->bytesReceived;
+        this->bytesReceived = 0;
+        return bytes;
+      }
+
+      /**
+       * @brief Check if another request can be pipelined with queueGet(): the
+       *  server answered on this connection without closing it, and the last
+       *  request was sent.
+       *
+       * @return true if queueGet() would send the request.
+       */
+      bool canQueueGet() const {
+        return this->pipelineReady && this->sentLen >= this->requestLen;
+      }
+
+      /**
+       * @brief Get how many responses to pipelined requests are still to be
+       *  read after the current one.
+       *
+       * @return uint8_t
+       */
+      uint8_t getPendingResponses() const {
+        return this->pendingResponses;
+      }
+
+      /**
+       * @brief Check if the whole response body has been read.
+       *
+       * @return true if there is no more body to read.
+       */
+      bool bodyComplete() const {
+        return this->bodyState == BodyState::DONE;
+      }
+
+      /**
+       * @brief Check if the last request reused an already open connection.
+       *
+       * @return true if no new connection had to be made.
+       */
+      bool lastRequestReusedConnection() const {
+        return this->reusedConnection;
+      }
+
+      /**
+       * @brief How long a step can go without progress before giving up, in
+       *  milliseconds.
+       */
+      uint32_t responseTimeout = 5000;
+
+      // Stream interface for reading the response body
+      int available() override;
+      int read() override;
+      int peek() override;
+      size_t write(uint8_t c) override {
+        return 0; // The body is read only
+      }
+
+    protected:
+      enum class BodyState : uint8_t {
+        DATA,
+        CHUNK_SIZE,
+        CHUNK_EXTENSION,
+        CHUNK_DATA_END,
+        TRAILER_LINE_START,
+        TRAILER_LINE,
+        DONE
+      };
+
+      WiFiClientSecure secureClient;
+      Client* client = &this->secureClient;
+      const char* host = nullptr;
+      uint16_t port = 443;
+
+      char request[MAX_REQUEST_LEN];
+      size_t requestLen = 0;
+      size_t pathEnd = 0;
+      size_t sentLen = 0;
+
+      uint8_t rxBuf[RX_BUFFER_LEN];
+      size_t rxPos = 0;
+      size_t rxLen = 0;
+
+      HttpRequestState state = HttpRequestState::IDLE;
+      uint32_t stepDeadline = 0;
+      int32_t statusCode = 0;
+      HttpRateLimitInfo rateLimitInfo = {-1, -1, 0, 0};
+      // Retry-After can also be a date, only known once Date is read too
+      uint32_t retryAfterDate = 0;
+      bool reusedConnection = false;
+      bool retried = false;
+      // Set once the server answered and will keep the connection open, so
+      // a stale connection can't be retried with requests queued on it
+      bool pipelineReady = false;
+      uint8_t pendingResponses = 0;
+
+      HttpTimings timings = {0, 0};
+      // When the request started with startGet() was sent, 0 once its first
+      // byte back was timed
+      uint32_t requestSentTime = 0;
+      uint32_t bytesReceived = 0;
+
+      char headLine[MAX_HEADER_LINE_LEN];
+      size_t headLineLen = 0;
+      bool hasStatusLine = false;
+
+      BodyState bodyState = BodyState::DONE;
+      bool chunked = false;
+      bool untilClose = false;
+      bool closeAfterResponse = false;
+      bool gzipEncoded = false;
+      uint32_t remaining = 0;
+
+      void setState(HttpRequestState newState) {
+        this->state = newState;
+        this->stepDeadline = millis() + this->responseTimeout;
+      }
+
+      // Compares the difference so it still works when millis() wraps
+      bool stepTimedOut() const {
+        return static_cast<int32_t>(millis() - this->stepDeadline) > 0;
+      }
+
+      void fail(int32_t error);
+      void retryOrFail(int32_t error);
+      void disconnect();
+      bool fillRx();
+      bool writeRequest();
+      void pollSend();
+      void pollHead();
+      void pollFinish();
+      bool handleHeadLine();
+      int nextBodyByte(bool consume);
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_HTTPKEEPALIVECLIENT_H
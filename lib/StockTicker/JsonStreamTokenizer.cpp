@@ -0,0 +1,253 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <JsonStreamTokenizer.h>
+
+namespace StockTicker {
+  /**
+   * @brief Reset the tokenizer so it can parse a new document.
+   */
+  void JsonStreamTokenizer::reset() {
+    this->status = JsonStreamStatus::IN_PROGRESS;
+    this->state = State::EXPECT_VALUE;
+    this->inEscape = false;
+    this->depth = 0;
+    this->arrayMask = 0;
+    this->hasKey = false;
+    this->keyLen = 0;
+    this->keyOverflowed = false;
+    this->tokenLen = 0;
+    this->tokenOverflowed = false;
+  }
+
+  /**
+   * @brief Feed a single character to the tokenizer.
+   *
+   * @param c The next character of the document.
+   * @return JsonStreamStatus IN_PROGRESS if more characters are needed, DONE
+   *  once the root value is complete, or an error.
+   */
+  JsonStreamStatus JsonStreamTokenizer::feed(char c) {
+    if (this->status != JsonStreamStatus::IN_PROGRESS) {
+      return this->status;
+    }
+
+    // Numbers and literals have no terminator, so the character that ends
+    // them still has to be handled as a structural character below
+    if (this->state == State::IN_NUMBER) {
+      if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+          c == 'e' || c == 'E') {
+        this->appendToken(c);
+        return this->status;
+      }
+      this->onValue(this->depth, this->currentKey(), JsonValueType::NUMBER,
+                    this->token);
+      this->endValue();
+    } else if (this->state == State::IN_LITERAL) {
+      if (c >= 'a' && c <= 'z') {
+        this->appendToken(c);
+        return this->status;
+      }
+      if (!this->finishLiteral()) {
+        return this->fail(JsonStreamStatus::ERROR_INVALID_INPUT);
+      }
+    } else if (this->state == State::IN_KEY ||
+               this->state == State::IN_STRING) {
+      if (this->inEscape) {
+        // Escapes are kept as-is, none of the values we look at use them
+        this->inEscape = false;
+      } else if (c == '\\') {
+        this->inEscape = true;
+        return this->status;
+      } else if (c == '"') {
+        if (this->state == State::IN_KEY) {
+          this->hasKey = true;
+          this->state = State::EXPECT_COLON;
+        } else {
+          this->onValue(this->depth, this->currentKey(), JsonValueType::STRING,
+                        this->token);
+          this->endValue();
+        }
+        return this->status;
+      }
+      if (this->state == State::IN_KEY) {
+        if (this->keyLen < JSON_TOKEN_MAX_LEN - 1) {
+          this->key[this->keyLen++] = c;
+          this->key[this->keyLen] = '\0';
+        } else {
+          this->keyOverflowed = true;
+        }
+      } else {
+        this->appendToken(c);
+      }
+      return this->status;
+    }
+
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+      return this->status;
+    }
+    if (this->status != JsonStreamStatus::IN_PROGRESS) {
+      // Only whitespace may follow a number or literal at the root
+      return this->fail(JsonStreamStatus::ERROR_INVALID_INPUT);
+    }
+
+    bool ok = false;
+    switch (this->state) {
+      case State::EXPECT_VALUE_OR_END:
+        ok = c == ']' ? this->endContainer(true) : this->startValue(c);
+        break;
+      case State::EXPECT_VALUE:
+        ok = this->startValue(c);
+        break;
+      case State::EXPECT_KEY_OR_END:
+        if (c == '}') {
+          ok = this->endContainer(false);
+          break;
+        }
+        // Fallthrough
+      case State::EXPECT_KEY:
+        if (c == '"') {
+          this->keyLen = 0;
+          this->key[0] = '\0';
+          this->keyOverflowed = false;
+          this->state = State::IN_KEY;
+          ok = true;
+        }
+        break;
+      case State::EXPECT_COLON:
+        if (c == ':') {
+          this->state = State::EXPECT_VALUE;
+          ok = true;
+        }
+        break;
+      case State::EXPECT_COMMA_OR_END:
+        if (c == ',') {
+          this->state =
+            this->inArray() ? State::EXPECT_VALUE : State::EXPECT_KEY;
+          ok = true;
+        } else if (c == '}' || c == ']') {
+          ok = this->endContainer(c == ']');
+        }
+        break;
+      default:
+        break;
+    }
+    if (!ok && this->status == JsonStreamStatus::IN_PROGRESS) {
+      return this->fail(JsonStreamStatus::ERROR_INVALID_INPUT);
+    }
+    return this->status;
+  }
+
+  /**
+   * @brief Feed a buffer of characters to the tokenizer. Stops early once the
+   *  root value is complete or an error occurs.
+   *
+   * @param buf The characters to feed.
+   * @param len The number of characters in buf.
+   * @return JsonStreamStatus
+   */
+  JsonStreamStatus JsonStreamTokenizer::feed(const char* buf, size_t len) {
+    for (size_t i = 0;
+         i < len && this->status == JsonStreamStatus::IN_PROGRESS; i++) {
+      this->feed(buf[i]);
+    }
+    return this->status;
+  }
+
+  /**
+   * @brief Parse a whole document from a stream, blocking until the root value
+   *  is complete or the stream times out.
+   *
+   * @param stream The stream to read from. Reads stop right after the root
+   *  value so nothing after it is consumed.
+   * @return JsonStreamStatus
+   */
+  JsonStreamStatus JsonStreamTokenizer::parse(Stream& stream) {
+    this->reset();
+    while (this->status == JsonStreamStatus::IN_PROGRESS) {
+      char c;
+      if (stream.readBytes(&c, 1) != 1) {
+        return this->fail(JsonStreamStatus::ERROR_INCOMPLETE_INPUT);
+      }
+      this->feed(c);
+    }
+    return this->status;
+  }
+
+  void JsonStreamTokenizer::appendToken(char c) {
+    if (this->tokenLen < JSON_TOKEN_MAX_LEN - 1) {
+      this->token[this->tokenLen++] = c;
+      this->token[this->tokenLen] = '\0';
+    } else {
+      this->tokenOverflowed = true;
+    }
+  }
+
+  bool JsonStreamTokenizer::startValue(char c) {
+    this->tokenLen = 0;
+    this->token[0] = '\0';
+    this->tokenOverflowed = false;
+    if (c == '{' || c == '[') {
+      if (this->depth >= JSON_MAX_DEPTH) {
+        this->fail(JsonStreamStatus::ERROR_TOO_DEEP);
+        return false;
+      }
+      const bool isArray = c == '[';
+      this->depth++;
+      if (isArray) {
+        this->arrayMask |= 1 << (this->depth - 1);
+      } else {
+        this->arrayMask &= ~(1 << (this->depth - 1));
+      }
+      this->onContainerStart(this->depth, this->currentKey(), isArray);
+      this->hasKey = false;
+      this->state =
+        isArray ? State::EXPECT_VALUE_OR_END : State::EXPECT_KEY_OR_END;
+    } else if (c == '"') {
+      this->state = State::IN_STRING;
+    } else if (c == '-' || (c >= '0' && c <= '9')) {
+      this->appendToken(c);
+      this->state = State::IN_NUMBER;
+    } else if (c == 't' || c == 'f' || c == 'n') {
+      this->appendToken(c);
+      this->state = State::IN_LITERAL;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  void JsonStreamTokenizer::endValue() {
+    this->hasKey = false;
+    if (this->depth == 0) {
+      this->status = JsonStreamStatus::DONE;
+    } else {
+      this->state = State::EXPECT_COMMA_OR_END;
+    }
+  }
+
+  bool JsonStreamTokenizer::endContainer(bool isArray) {
+    if (this->depth == 0 || this->inArray() != isArray) {
+      return false;
+    }
+    this->onContainerEnd(this->depth, isArray);
+    this->depth--;
+    this->endValue();
+    return true;
+  }
+
+  bool JsonStreamTokenizer::finishLiteral() {
+    JsonValueType type;
+    if (strcmp(this->token, "true") == 0 || strcmp(this->token, "false") == 0) {
+      type = JsonValueType::BOOLEAN;
+    } else if (strcmp(this->token, "null") == 0) {
+      type = JsonValueType::NULL_VALUE;
+    } else {
+      return false;
+    }
+    this->onValue(this->depth, this->currentKey(), type, this->token);
+    this->endValue();
+    return true;
+  }
+} // StockTicker
@@ -0,0 +1,155 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_JSONSTREAMTOKENIZER_H
+#define PICO2W_STOCK_TICKER_JSONSTREAMTOKENIZER_H
+
+#include <Arduino.h>
+
+namespace StockTicker {
+  const size_t JSON_TOKEN_MAX_LEN = 32;
+  const uint8_t JSON_MAX_DEPTH = 16;
+
+  /**
+   * @brief Status of a JsonStreamTokenizer.
+   */
+  enum class JsonStreamStatus {
+    IN_PROGRESS,
+    DONE,
+    ERROR_INVALID_INPUT,
+    ERROR_TOO_DEEP,
+    ERROR_INCOMPLETE_INPUT
+  };
+
+  enum class JsonValueType { STRING, NUMBER, BOOLEAN, NULL_VALUE };
+
+  /**
+   * @brief Push-based JSON tokenizer that uses a fixed amount of memory.
+   *
+   * Characters are fed one at a time and events are reported to the virtual
+   * on*() methods, so a subclass only has to look at the parts of the document
+   * it cares about. Keys and scalar values longer than JSON_TOKEN_MAX_LEN - 1
+   * are truncated, subclasses check keyTruncated() and valueTruncated()
+   * before using one, ex. so a cut off number isn't taken as a price. Depth 1
+   * is the inside of the root container.
+   */
+  class JsonStreamTokenizer {
+    public:
+      JsonStreamTokenizer() = default;
+      virtual ~JsonStreamTokenizer() = default;
+
+      void reset();
+      JsonStreamStatus feed(char c);
+      JsonStreamStatus feed(const char* buf, size_t len);
+      JsonStreamStatus parse(Stream& stream);
+
+      /**
+       * @brief Get the current status of the tokenizer.
+       *
+       * @return JsonStreamStatus
+       */
+      JsonStreamStatus getStatus() const {
+        return this->status;
+      }
+
+    protected:
+      /**
+       * @brief Check if the key passed to the current on*() call was cut off
+       *  at JSON_TOKEN_MAX_LEN - 1 characters.
+       *
+       * @return true if the key is only the start of the real one.
+       */
+      bool keyTruncated() const {
+        return this->keyOverflowed;
+      }
+
+      /**
+       * @brief Check if the text passed to the current onValue() call was cut
+       *  off at JSON_TOKEN_MAX_LEN - 1 characters.
+       *
+       * @return true if the text is only the start of the real value.
+       */
+      bool valueTruncated() const {
+        return this->tokenOverflowed;
+      }
+
+      /**
+       * @brief Called when an object or array is opened.
+       *
+       * @param depth The depth of the contents of the new container.
+       * @param key The key of the container in the parent object, or nullptr
+       *  if the parent is an array or there is no parent.
+       * @param isArray True if the container is an array.
+       */
+      virtual void onContainerStart(uint8_t depth, const char* key,
+                                    bool isArray) {};
+      /**
+       * @brief Called when an object or array is closed.
+       *
+       * @param depth The depth of the contents of the closed container.
+       * @param isArray True if the container is an array.
+       */
+      virtual void onContainerEnd(uint8_t depth, bool isArray) {};
+      /**
+       * @brief Called for every scalar (string, number, boolean, null).
+       *
+       * @param depth The depth of the value.
+       * @param key The key of the value in the parent object, or nullptr if
+       *  the parent is an array.
+       * @param type The type of the value.
+       * @param text The raw text of the value, without quotes for strings.
+       */
+      virtual void onValue(uint8_t depth, const char* key, JsonValueType type,
+                           const char* text) {};
+
+    private:
+      enum class State : uint8_t {
+        EXPECT_VALUE,
+        EXPECT_VALUE_OR_END,
+        EXPECT_KEY,
+        EXPECT_KEY_OR_END,
+        EXPECT_COLON,
+        EXPECT_COMMA_OR_END,
+        IN_KEY,
+        IN_STRING,
+        IN_NUMBER,
+        IN_LITERAL
+      };
+
+      JsonStreamStatus status = JsonStreamStatus::IN_PROGRESS;
+      State state = State::EXPECT_VALUE;
+      bool inEscape = false;
+      uint8_t depth = 0;
+      // Bit n set means the container at depth n + 1 is an array
+      uint16_t arrayMask = 0;
+      bool hasKey = false;
+
+      char key[JSON_TOKEN_MAX_LEN];
+      size_t keyLen = 0;
+      bool keyOverflowed = false;
+      char token[JSON_TOKEN_MAX_LEN];
+      size_t tokenLen = 0;
+      bool tokenOverflowed = false;
+
+      bool inArray() const {
+        return this->depth > 0 && (this->arrayMask >> (this->depth - 1)) & 1;
+      }
+
+      const char* currentKey() const {
+        return this->hasKey ? this->key : nullptr;
+      }
+
+      void appendToken(char c);
+      bool startValue(char c);
+      void endValue();
+      bool endContainer(bool isArray);
+      bool finishLiteral();
+      JsonStreamStatus fail(JsonStreamStatus error) {
+        this->status = error;
+        return error;
+      }
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_JSONSTREAMTOKENIZER_H
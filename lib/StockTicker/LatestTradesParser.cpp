@@ -0,0 +1,44 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <LatestTradesParser.h>
+
+namespace StockTicker {
+  void LatestTradesParser::onContainerStart(uint8_t depth, const char* key,
+                                            bool isArray) {
+    if (depth == 1) {
+      this->inTrades = false;
+    } else if (depth == 2 && !isArray && key != nullptr) {
+      this->inTrades = strcmp(key, "trades") == 0;
+    } else if (depth == 3 && this->inTrades && !isArray && key != nullptr) {
+      // Start of a symbol's trade, skipped if the id was cut off
+      strncpy(this->symbol, key, JSON_TOKEN_MAX_LEN);
+      if (this->keyTruncated()) {
+        this->symbol[0] = '\0';
+      }
+      this->hasPrice = false;
+    }
+  }
+
+  void LatestTradesParser::onContainerEnd(uint8_t depth, bool isArray) {
+    if (depth == 2) {
+      this->inTrades = false;
+    } else if (depth == 3 && this->inTrades && this->hasPrice &&
+               this->symbol[0] != '\0') {
+      this->callback(this->context, this->symbol, this->price);
+      this->hasPrice = false;
+    }
+  }
+
+  void LatestTradesParser::onValue(uint8_t depth, const char* key,
+                                   JsonValueType type, const char* text) {
+    if (depth != 3 || !this->inTrades || type != JsonValueType::NUMBER ||
+        key == nullptr || this->valueTruncated()) {
+      return;
+    }
+    if (strcmp(key, "p") == 0) {
+      this->hasPrice = parseFixedPoint(text, this->price);
+    }
+  }
+} // StockTicker
@@ -0,0 +1,57 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_LATESTTRADESPARSER_H
+#define PICO2W_STOCK_TICKER_LATESTTRADESPARSER_H
+
+#include <Arduino.h>
+#include <FixedPoint.h>
+#include <JsonStreamTokenizer.h>
+
+namespace StockTicker {
+  /**
+   * @brief Called once per symbol in a latest trades response.
+   *
+   * @param context The context pointer given to the parser.
+   * @param id The symbol of the stock.
+   * @param price The price of the latest trade. (p) In 1/FIXED_POINT_SCALE
+   *  units.
+   */
+  typedef void (*LatestTradeCallback)(void* context, const char* id,
+                                      int64_t price);
+
+  /**
+   * @brief Streaming parser for the body of /v2/stocks/trades/latest.
+   *
+   * The response looks like {"trades": {"AAPL": {"p": 1.0, "s": 100, ...},
+   * ...}}. Only the price is kept, which is a fraction of what a snapshot
+   * carries per symbol.
+   */
+  class LatestTradesParser : public JsonStreamTokenizer {
+    public:
+      LatestTradesParser(LatestTradeCallback callback, void* context) {
+        this->callback = callback;
+        this->context = context;
+      }
+      ~LatestTradesParser() override = default;
+
+    protected:
+      void onContainerStart(uint8_t depth, const char* key,
+                            bool isArray) override;
+      void onContainerEnd(uint8_t depth, bool isArray) override;
+      void onValue(uint8_t depth, const char* key, JsonValueType type,
+                   const char* text) override;
+
+    private:
+      LatestTradeCallback callback = nullptr;
+      void* context = nullptr;
+
+      bool inTrades = false;
+      char symbol[JSON_TOKEN_MAX_LEN];
+      bool hasPrice = false;
+      int64_t price = 0;
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_LATESTTRADESPARSER_H
@@ -0,0 +1,170 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <PriceCache.h>
+
+namespace StockTicker {
+  /**
+   * @brief Update a CRC-32 (the zlib one) with more data. Uses a 16 entry
+   *  table, a nibble at a time, to keep it small.
+   *
+   * @param data The data.
+   * @param len The length of data.
+   * @param crc The CRC of the data before, 0 to start.
+   * @return uint32_t The CRC including data.
+   */
+  uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc /* = 0 */) {
+    static const uint32_t table[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+      0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+      0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+      crc ^= data[i];
+      crc = (crc >> 4) ^ table[crc & 0x0F];
+      crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+  }
+
+  /**
+   * @brief Start FatFS and start writing the file, replacing the old one.
+   *
+   * @return true if the file was opened.
+   */
+  bool PriceCache::beginWrite() {
+    if (!FatFS.begin()) {
+      LOG_ERROR("Failed to init FatFS");
+      return false;
+    }
+    this->file = FatFS.open(PRICE_CACHE_FILE_PATH, "w");
+    if (!this->file) {
+      LOG_ERROR("Failed to open %s for writing", PRICE_CACHE_FILE_PATH);
+      FatFS.end();
+      return false;
+    }
+    this->header = {PRICE_CACHE_MAGIC, PRICE_CACHE_VERSION, 0, 0, 0};
+    this->crc = 0;
+    // Written again with the real counts and CRC by endWrite()
+    this->failed = this->file.write(reinterpret_cast<uint8_t*>(&this->header),
+                                    sizeof(this->header)) !=
+                   sizeof(this->header);
+    return !this->failed;
+  }
+
+  /**
+   * @brief Write the prices of one symbol.
+   *
+   * @param id The symbol, shorter than MAX_ID_LEN.
+   * @param values Its prices.
+   * @return true if written.
+   */
+  bool PriceCache::writeRecord(const char* id, const PriceValues& values) {
+    const size_t idLen = strlen(id);
+    if (this->failed || idLen >= MAX_ID_LEN) {
+      return false;
+    }
+    uint8_t record[1 + MAX_ID_LEN + sizeof(PriceValues)];
+    record[0] = idLen;
+    memcpy(record + 1, id, idLen);
+    memcpy(record + 1 + idLen, &values, sizeof(PriceValues));
+    const size_t recordLen = 1 + idLen + sizeof(PriceValues);
+    if (this->file.write(record, recordLen) != recordLen) {
+      this->failed = true;
+      return false;
+    }
+    this->crc = crc32(record, recordLen, this->crc);
+    this->header.recordCount++;
+    this->header.recordsLen += recordLen;
+    return true;
+  }
+
+  /**
+   * @brief Finish the header, close the file and stop FatFS.
+   *
+   * @return true if the whole file was written.
+   */
+  bool PriceCache::endWrite() {
+    this->header.crc = this->crc;
+    if (!this->failed &&
+        (!this->file.seek(0) ||
+         this->file.write(reinterpret_cast<uint8_t*>(&this->header),
+                          sizeof(this->header)) != sizeof(this->header))) {
+      this->failed = true;
+    }
+    this->file.close();
+    FatFS.end();
+    return !this->failed;
+  }
+
+  /**
+   * @brief Start FatFS, open the file and check it before any record is read.
+   *  Call endRead() after, even if this fails.
+   *
+   * @return true if the file is there and intact.
+   */
+  bool PriceCache::beginRead() {
+    this->failed = true;
+    if (!FatFS.begin()) {
+      LOG_ERROR("Failed to init FatFS");
+      return false;
+    }
+    this->file = FatFS.open(PRICE_CACHE_FILE_PATH, "r");
+    if (!this->file) {
+      return false; // Not saved yet
+    }
+    if (this->file.read(reinterpret_cast<uint8_t*>(&this->header),
+                        sizeof(this->header)) != sizeof(this->header) ||
+        this->header.magic != PRICE_CACHE_MAGIC ||
+        this->header.version != PRICE_CACHE_VERSION ||
+        this->file.size() != sizeof(this->header) + this->header.recordsLen) {
+      LOG_WARN("Price cache is from another version or incomplete");
+      return false;
+    }
+    // Check the CRC first, so nothing is used from a corrupt file
+    uint8_t buf[64];
+    uint32_t crc = 0;
+    int n;
+    while ((n = this->file.read(buf, sizeof(buf))) > 0) {
+      crc = crc32(buf, n, crc);
+    }
+    if (crc != this->header.crc) {
+      LOG_WARN("Price cache CRC mismatch");
+      return false;
+    }
+    this->failed = !this->file.seek(sizeof(this->header));
+    return !this->failed;
+  }
+
+  /**
+   * @brief Read the prices of the next symbol.
+   *
+   * @param id Where to store the symbol, MAX_ID_LEN long.
+   * @param values Where to store its prices.
+   * @return true if there was another record.
+   */
+  bool PriceCache::readRecord(char* id, PriceValues& values) {
+    uint8_t idLen;
+    if (this->failed || this->header.recordCount == 0 ||
+        this->file.read(&idLen, 1) != 1 || idLen >= MAX_ID_LEN ||
+        this->file.read(reinterpret_cast<uint8_t*>(id), idLen) != idLen ||
+        this->file.read(reinterpret_cast<uint8_t*>(&values),
+                        sizeof(PriceValues)) != sizeof(PriceValues)) {
+      return false;
+    }
+    id[idLen] = '\0';
+    this->header.recordCount--;
+    return true;
+  }
+
+  /**
+   * @brief Close the file and stop FatFS.
+   */
+  void PriceCache::endRead() {
+    if (this->file) {
+      this->file.close();
+    }
+    FatFS.end();
+  }
+} // StockTicker
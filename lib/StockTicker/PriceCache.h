@@ -0,0 +1,66 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_PRICECACHE_H
+#define PICO2W_STOCK_TICKER_PRICECACHE_H
+
+#include <Arduino.h>
+#include <FatFS.h>
+#include <Log.h>
+#include <PriceTable.h>
+#include <TickerLimits.h>
+
+namespace StockTicker {
+  const char* const PRICE_CACHE_FILE_PATH = "/price_cache.bin";
+  // "PRC1" read as a little-endian uint32_t
+  const uint32_t PRICE_CACHE_MAGIC = 0x31435250;
+  // Bump when the layout of the records or FIXED_POINT_SCALE changes
+  const uint16_t PRICE_CACHE_VERSION = 1;
+
+  // At the start of the file, followed by the records. Each record is the
+  // length of the id (1 byte), the id (without a terminator), then its
+  // PriceValues.
+  // clang-format off
+  struct PriceCacheHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordCount;
+    uint32_t recordsLen;
+    // CRC-32 of the records
+    uint32_t crc;
+  };
+  // clang-format on
+
+  uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0);
+
+  /**
+   * @brief Saves the last known prices to FatFS, so they can be shown at boot
+   *  before the first fetch finishes.
+   *
+   * Records are streamed to and from the file one at a time, nothing is
+   * buffered whole. The file is only trusted if the magic, version, length
+   * and CRC all match, so a write cut short by a reboot is ignored.
+   */
+  class PriceCache {
+    public:
+      PriceCache() = default;
+      ~PriceCache() = default;
+
+      bool beginWrite();
+      bool writeRecord(const char* id, const PriceValues& values);
+      bool endWrite();
+
+      bool beginRead();
+      bool readRecord(char* id, PriceValues& values);
+      void endRead();
+
+    protected:
+      File file;
+      PriceCacheHeader header;
+      uint32_t crc = 0;
+      bool failed = false;
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_PRICECACHE_H
@@ -0,0 +1,46 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <PriceTable.h>
+
+namespace StockTicker {
+  /**
+   * @brief Copy the table if a new version was published since the last
+   *  successful read. Never waits for the writer.
+   *
+   * @param dst Where to copy the table to.
+   * @param sparklineDst Where to copy the sparklines to.
+   * @param count How many entries to copy.
+   * @return true if a new version was copied.
+   */
+  bool PriceTable::readIfChanged(PriceValues* dst,
+                                 SparklineColumns* sparklineDst,
+                                 uint16_t count) {
+    count = min(count, this->capacity);
+    for (uint8_t attempt = 0; attempt < PRICE_TABLE_READ_ATTEMPTS; attempt++) {
+      const uint32_t before = this->sequence.load(std::memory_order_acquire);
+      if (before == this->lastReadSequence) {
+        return false; // Nothing new
+      }
+      if (before & 1) {
+        // Writer is in the middle of an update
+        this->readerRetryCount++;
+        continue;
+      }
+      memcpy(dst, this->values, count * sizeof(PriceValues));
+      memcpy(sparklineDst, this->sparklines,
+             count * sizeof(SparklineColumns));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const uint32_t after = this->sequence.load(std::memory_order_relaxed);
+      if (before == after) {
+        this->lastReadSequence = before;
+        this->handoffCount++;
+        return true;
+      }
+      // Table changed while copying, the copy may be torn
+      this->readerRetryCount++;
+    }
+    return false; // Try again on the next call
+  }
+} // StockTicker
@@ -0,0 +1,138 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_PRICETABLE_H
+#define PICO2W_STOCK_TICKER_PRICETABLE_H
+
+#include <Arduino.h>
+#include <BlockCarver.h>
+#include <FixedPoint.h>
+#include <Sparkline.h>
+#include <atomic>
+
+namespace StockTicker {
+  const uint8_t PRICE_TABLE_READ_ATTEMPTS = 3;
+
+  // In 1/FIXED_POINT_SCALE units
+  // clang-format off
+  struct PriceValues {
+    int64_t price;
+    int64_t change;
+    int64_t changePercent;
+  };
+  // clang-format on
+
+  /**
+   * @brief Seqlock-protected table of prices to hand them from the core that
+   *  fetches them to the core that renders them.
+   *
+   * There must be only one writer and one reader. The writer never waits,
+   * and the reader retries (or tries again later) if it raced with a write,
+   * so it never sees a half-written table.
+   */
+  class PriceTable {
+    public:
+      PriceTable() = default;
+      ~PriceTable() = default;
+
+      /**
+       * @brief Take the table's storage. Only call this while neither the
+       *  writer nor the reader uses the table.
+       *
+       * @param storage Where to take the storage from.
+       * @param capacity How many entries the table holds.
+       */
+      void begin(BlockCarver& storage, uint16_t capacity) {
+        this->values = storage.take<PriceValues>(capacity);
+        this->sparklines = storage.take<SparklineColumns>(capacity);
+        this->capacity = capacity;
+      }
+
+      /**
+       * @brief Start writing a new version of the table. Must be followed by
+       *  endWrite().
+       *
+       * @return PriceValues* The table to write to.
+       */
+      PriceValues* beginWrite() {
+        this->sequence.fetch_add(1, std::memory_order_relaxed); // Now odd
+        std::atomic_thread_fence(std::memory_order_release);
+        return this->values;
+      }
+
+      /**
+       * @brief Get the sparklines of the version being written. Only use it
+       *  between beginWrite() and endWrite().
+       *
+       * @return SparklineColumns* The sparklines to write to.
+       */
+      SparklineColumns* writeSparklines() {
+        return this->sparklines;
+      }
+
+      /**
+       * @brief Finish writing and publish the new version of the table.
+       */
+      void endWrite() {
+        this->sequence.fetch_add(1, std::memory_order_release); // Even again
+        this->publishCount++;
+      }
+
+      bool readIfChanged(PriceValues* dst, SparklineColumns* sparklineDst,
+                         uint16_t count);
+
+      /**
+       * @brief Get the last version the writer published. Only call this
+       *  from the writer, outside of beginWrite() and endWrite().
+       *
+       * @return const PriceValues*
+       */
+      const PriceValues* getPublished() const {
+        return this->values;
+      }
+
+      /**
+       * @brief Get how many versions of the table have been published.
+       *
+       * @return uint32_t
+       */
+      uint32_t getPublishCount() const {
+        return this->publishCount;
+      }
+
+      /**
+       * @brief Get how many versions of the table the reader has copied.
+       *
+       * @return uint32_t
+       */
+      uint32_t getHandoffCount() const {
+        return this->handoffCount;
+      }
+
+      /**
+       * @brief Get how many times the reader raced with the writer and had to
+       *  retry.
+       *
+       * @return uint32_t
+       */
+      uint32_t getReaderRetryCount() const {
+        return this->readerRetryCount;
+      }
+
+    protected:
+      std::atomic<uint32_t> sequence{0};
+      PriceValues* values = nullptr;
+      SparklineColumns* sparklines = nullptr;
+      uint16_t capacity = 0;
+
+      // Only touched by the writer
+      volatile uint32_t publishCount = 0;
+      // Only touched by the reader
+      uint32_t lastReadSequence = 0;
+      volatile uint32_t handoffCount = 0;
+      volatile uint32_t readerRetryCount = 0;
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_PRICETABLE_H
@@ -0,0 +1,121 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <RetryPolicy.h>
+
+namespace StockTicker {
+  // Indexed by RetryClass
+  static const RetryBackoff BACKOFFS[] = {
+    {2 * 1000, 60 * 1000},       // CONNECTION
+    {5 * 1000, 5 * 60 * 1000},   // RATE_LIMITED
+    {2 * 1000, 2 * 60 * 1000},   // SERVER_ERROR
+    {60 * 1000, 30 * 60 * 1000}, // CLIENT_ERROR
+  };
+
+  /**
+   * @brief Forget all failures and close the circuit breaker.
+   */
+  void RetryPolicy::reset() {
+    this->circuitState = CircuitState::CLOSED;
+    this->consecutiveFailures = 0;
+    this->recoveryDelay = 0;
+  }
+
+  /**
+   * @brief Call when a request is started. A request made while the circuit
+   *  breaker is open is the probe that decides if it can close again.
+   */
+  void RetryPolicy::onAttempt() {
+    if (this->circuitState == CircuitState::OPEN) {
+      this->circuitState = CircuitState::HALF_OPEN;
+    }
+  }
+
+  /**
+   * @brief Call when a request is done to get how long to wait before the
+   *  next one.
+   *
+   * @param statusCode 200 on success, otherwise the HTTP status code or a
+   *  negative error.
+   * @param info The rate limiting headers of the response.
+   * @param period The normal time between requests, in milliseconds.
+   * @return uint32_t The delay before the next request, in milliseconds.
+   */
+  uint32_t RetryPolicy::onResult(int32_t statusCode,
+                                 const HttpRateLimitInfo& info,
+                                 uint32_t period) {
+    uint32_t delay;
+    if (statusCode == 200) {
+      if (this->circuitState != CircuitState::CLOSED) {
+        LOG_INFO("Request succeeded, closing circuit breaker");
+      }
+      this->circuitState = CircuitState::CLOSED;
+      this->consecutiveFailures = 0;
+      this->recoveryDelay /= 2;
+      delay = max(period, this->recoveryDelay);
+    } else {
+      if (this->consecutiveFailures < UINT16_MAX) {
+        this->consecutiveFailures++;
+      }
+      const RetryBackoff& backoff =
+        BACKOFFS[static_cast<uint8_t>(classify(statusCode))];
+      // Doubles on every failure, capped before it can overflow
+      const uint8_t doublings = min(this->consecutiveFailures - 1, 16);
+      delay = min(backoff.baseDelay << doublings, backoff.maxDelay);
+      // Equal jitter, between half and all of the delay
+      delay = delay / 2 + Telemetry::randomWord() % (delay / 2 + 1);
+
+      if (this->circuitState == CircuitState::HALF_OPEN ||
+          this->consecutiveFailures >= CIRCUIT_BREAKER_THRESHOLD) {
+        if (this->circuitState == CircuitState::CLOSED) {
+          LOG_WARN("%d failures in a row, opening circuit breaker",
+                   this->consecutiveFailures);
+        }
+        this->circuitState = CircuitState::OPEN;
+        delay = max(delay, CIRCUIT_BREAKER_OPEN_TIME);
+      }
+      this->recoveryDelay = delay;
+    }
+    // The server knows best if it asks for longer
+    return max(delay, serverRequestedDelay(info));
+  }
+
+  /**
+   * @brief Get which backoff a failure uses.
+   *
+   * @param statusCode The HTTP status code or a negative error.
+   * @return RetryClass
+   */
+  RetryClass RetryPolicy::classify(int32_t statusCode) {
+    if (statusCode == 429) {
+      return RetryClass::RATE_LIMITED;
+    }
+    if (statusCode >= 500) {
+      return RetryClass::SERVER_ERROR;
+    }
+    if (statusCode >= 400) {
+      return RetryClass::CLIENT_ERROR;
+    }
+    return RetryClass::CONNECTION;
+  }
+
+  /**
+   * @brief Get how long the server asked to wait, from Retry-After or from
+   *  X-RateLimit-Reset once X-RateLimit-Remaining hits 0.
+   *
+   * @param info The rate limiting headers of the response.
+   * @return uint32_t The delay in milliseconds, 0 if none.
+   */
+  uint32_t RetryPolicy::serverRequestedDelay(const HttpRateLimitInfo& info) {
+    uint32_t seconds = 0;
+    if (info.retryAfter >= 0) {
+      seconds = info.retryAfter;
+    }
+    // The reset time is by the server's clock, so compare it to the Date
+    if (info.remaining == 0 && info.reset > info.date && info.date > 0) {
+      seconds = max(seconds, info.reset - info.date);
+    }
+    return min(seconds, MAX_SERVER_REQUESTED_DELAY / 1000) * 1000;
+  }
+} // StockTicker
@@ -0,0 +1,100 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_RETRYPOLICY_H
+#define PICO2W_STOCK_TICKER_RETRYPOLICY_H
+
+#include <Arduino.h>
+#include <HttpKeepAliveClient.h>
+#include <Log.h>
+#include <SystemStats.h>
+
+namespace StockTicker {
+  // Consecutive failures before the circuit breaker opens
+  const uint8_t CIRCUIT_BREAKER_THRESHOLD = 5;
+  // How long the circuit breaker stays open before a probe, in milliseconds
+  const uint32_t CIRCUIT_BREAKER_OPEN_TIME = 5 * 60 * 1000;
+  // Longest the server can make us wait, in case of a bad clock
+  const uint32_t MAX_SERVER_REQUESTED_DELAY = 60 * 60 * 1000;
+
+  /**
+   * @brief Kinds of failures, each with its own backoff.
+   */
+  enum class RetryClass : uint8_t {
+    // No response, ex. WiFi or TLS trouble
+    CONNECTION,
+    // 429
+    RATE_LIMITED,
+    // 5xx
+    SERVER_ERROR,
+    // Other 4xx, most likely bad settings so there's no rush
+    CLIENT_ERROR
+  };
+
+  /**
+   * @brief State of the circuit breaker, see RetryPolicy.
+   */
+  enum class CircuitState : uint8_t { CLOSED, OPEN, HALF_OPEN };
+
+  // Backoff of a RetryClass, in milliseconds
+  // clang-format off
+  struct RetryBackoff {
+    uint32_t baseDelay;
+    uint32_t maxDelay;
+  };
+  // clang-format on
+
+  /**
+   * @brief Decides how long to wait before the next request from how the
+   *  last one went.
+   *
+   * Failures back off exponentially per RetryClass with jitter, so many
+   * tickers don't retry in lockstep. Retry-After and an exhausted
+   * X-RateLimit-Remaining are honoured when they ask for a longer wait.
+   * After CIRCUIT_BREAKER_THRESHOLD failures in a row the circuit opens and
+   * only one probe is made every CIRCUIT_BREAKER_OPEN_TIME. Once requests
+   * succeed again the delay is halved on every success until it's back to
+   * the normal period, instead of jumping straight back to it.
+   */
+  class RetryPolicy {
+    public:
+      RetryPolicy() = default;
+      ~RetryPolicy() = default;
+
+      void reset();
+      void onAttempt();
+      uint32_t onResult(int32_t statusCode, const HttpRateLimitInfo& info,
+                        uint32_t period);
+
+      static RetryClass classify(int32_t statusCode);
+
+      /**
+       * @brief Get the state of the circuit breaker.
+       *
+       * @return CircuitState
+       */
+      CircuitState getCircuitState() const {
+        return this->circuitState;
+      }
+
+      /**
+       * @brief Get how many requests in a row have failed.
+       *
+       * @return uint16_t
+       */
+      uint16_t getConsecutiveFailures() const {
+        return this->consecutiveFailures;
+      }
+
+    protected:
+      CircuitState circuitState = CircuitState::CLOSED;
+      uint16_t consecutiveFailures = 0;
+      // Delay being eased back down to the period after recovering
+      uint32_t recoveryDelay = 0;
+
+      static uint32_t serverRequestedDelay(const HttpRateLimitInfo& info);
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_RETRYPOLICY_H
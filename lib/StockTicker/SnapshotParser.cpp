@@ -0,0 +1,49 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <SnapshotParser.h>
+
+namespace StockTicker {
+  void SnapshotParser::onContainerStart(uint8_t depth, const char* key,
+                                        bool isArray) {
+    if (depth == 2 && !isArray && key != nullptr) {
+      // Start of a symbol's snapshot. A cut off id could be another
+      // symbol's, so that snapshot is skipped.
+      strncpy(this->symbol, key, JSON_TOKEN_MAX_LEN);
+      if (this->keyTruncated()) {
+        this->symbol[0] = '\0';
+      }
+      this->inDailyBar = false;
+      this->hasOpen = false;
+      this->hasClose = false;
+    } else if (depth == 3 && key != nullptr && strcmp(key, "dailyBar") == 0) {
+      this->inDailyBar = true;
+    }
+  }
+
+  void SnapshotParser::onContainerEnd(uint8_t depth, bool isArray) {
+    if (depth == 3) {
+      this->inDailyBar = false;
+    } else if (depth == 2) {
+      if (this->symbol[0] != '\0' && this->hasOpen && this->hasClose) {
+        this->callback(this->context, this->symbol, this->openPrice,
+                       this->closePrice);
+      }
+    }
+  }
+
+  void SnapshotParser::onValue(uint8_t depth, const char* key,
+                               JsonValueType type, const char* text) {
+    if (depth != 3 || !this->inDailyBar || type != JsonValueType::NUMBER ||
+        this->valueTruncated()) {
+      return;
+    }
+    // The number text is converted directly, so no cents are lost to float
+    if (strcmp(key, "o") == 0) {
+      this->hasOpen = parseFixedPoint(text, this->openPrice);
+    } else if (strcmp(key, "c") == 0) {
+      this->hasClose = parseFixedPoint(text, this->closePrice);
+    }
+  }
+} // StockTicker
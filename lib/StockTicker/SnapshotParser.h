@@ -0,0 +1,62 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_SNAPSHOTPARSER_H
+#define PICO2W_STOCK_TICKER_SNAPSHOTPARSER_H
+
+#include <Arduino.h>
+#include <FixedPoint.h>
+#include <JsonStreamTokenizer.h>
+
+namespace StockTicker {
+  /**
+   * @brief Called once per symbol in a snapshots response.
+   *
+   * @param context The context pointer given to the parser.
+   * @param id The symbol of the stock.
+   * @param openPrice The start of day price. (dailyBar.o) In
+   *  1/FIXED_POINT_SCALE units.
+   * @param closePrice The end of day / current price. (dailyBar.c) In
+   *  1/FIXED_POINT_SCALE units.
+   */
+  typedef void (*SnapshotCallback)(void* context, const char* id,
+                                   int64_t openPrice, int64_t closePrice);
+
+  /**
+   * @brief Streaming parser for the body of /v2/stocks/snapshots.
+   *
+   * The response looks like {"AAPL": {"dailyBar": {"o": 1.0, "c": 2.0, ...},
+   * "latestTrade": {...}, ...}, ...}. Only dailyBar.o and dailyBar.c are kept,
+   * everything else is skipped as it streams past, so memory use does not
+   * depend on the number of symbols or the size of the response.
+   */
+  class SnapshotParser : public JsonStreamTokenizer {
+    public:
+      SnapshotParser(SnapshotCallback callback, void* context) {
+        this->callback = callback;
+        this->context = context;
+      }
+      ~SnapshotParser() override = default;
+
+    protected:
+      void onContainerStart(uint8_t depth, const char* key,
+                            bool isArray) override;
+      void onContainerEnd(uint8_t depth, bool isArray) override;
+      void onValue(uint8_t depth, const char* key, JsonValueType type,
+                   const char* text) override;
+
+    private:
+      SnapshotCallback callback = nullptr;
+      void* context = nullptr;
+
+      char symbol[JSON_TOKEN_MAX_LEN];
+      bool inDailyBar = false;
+      bool hasOpen = false;
+      bool hasClose = false;
+      int64_t openPrice = 0;
+      int64_t closePrice = 0;
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_SNAPSHOTPARSER_H
@@ -0,0 +1,117 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <Sparkline.h>
+
+namespace StockTicker {
+  /**
+   * @brief Quantize a change to a sample, clamped to what fits.
+   *
+   * @param changePercent The change from the reference price, as a percentage
+   *  in 1/FIXED_POINT_SCALE units.
+   * @return int16_t The change in basis points.
+   */
+  int16_t sparklineSample(int64_t changePercent) {
+    // 1 basis point is 0.01%, or 100 units
+    const int64_t basisPoints = changePercent / 100;
+    return constrain(basisPoints, static_cast<int64_t>(INT16_MIN + 1),
+                     static_cast<int64_t>(INT16_MAX));
+  }
+
+  /**
+   * @brief Remove all samples.
+   */
+  void SparklineBuffer::clear() {
+    this->head = SPARKLINE_WIDTH - 1;
+    this->count = 0;
+    this->newestLive = false;
+    this->dirty = true;
+  }
+
+  /**
+   * @brief Add a finished sample, ex. the close of a bar. The oldest sample
+   *  is dropped once full.
+   *
+   * @param sample The sample, see sparklineSample().
+   */
+  void SparklineBuffer::push(int16_t sample) {
+    this->head = (this->head + 1) % SPARKLINE_WIDTH;
+    this->samples[this->head] = sample;
+    if (this->count < SPARKLINE_WIDTH) {
+      this->count++;
+    }
+    this->newestLive = false;
+    this->dirty = true;
+  }
+
+  /**
+   * @brief Add the latest price. It replaces the newest sample until
+   *  SPARKLINE_SAMPLE_PERIOD has passed since that sample was started, so the
+   *  last column follows the price and the others are evenly spaced.
+   *
+   * @param sample The sample, see sparklineSample().
+   * @param now The current time, in milliseconds.
+   */
+  void SparklineBuffer::update(int16_t sample, uint32_t now) {
+    if (this->newestLive && now - this->newestTime < SPARKLINE_SAMPLE_PERIOD) {
+      if (this->samples[this->head] != sample) {
+        this->samples[this->head] = sample;
+        this->dirty = true;
+      }
+      return;
+    }
+    this->push(sample);
+    this->newestLive = true;
+    this->newestTime = now;
+  }
+
+  /**
+   * @brief Draw the samples scaled to the height, newest on the right. Each
+   *  column is joined to the one before it so steep moves stay visible.
+   *
+   * @param out Where to write the columns.
+   */
+  void SparklineBuffer::render(SparklineColumns& out) const {
+    memset(out.columns, 0, SPARKLINE_WIDTH);
+    this->dirty = false;
+    if (this->count == 0) {
+      return;
+    }
+    const uint8_t oldest =
+      (this->head + SPARKLINE_WIDTH - this->count + 1) % SPARKLINE_WIDTH;
+    int16_t low = INT16_MAX;
+    int16_t high = INT16_MIN;
+    for (uint8_t i = 0; i < this->count; i++) {
+      const int16_t sample = this->samples[(oldest + i) % SPARKLINE_WIDTH];
+      low = min(low, sample);
+      high = max(high, sample);
+    }
+    // Center small ranges instead of stretching them
+    int32_t range = high - low;
+    if (range < SPARKLINE_MIN_RANGE) {
+      low -= (SPARKLINE_MIN_RANGE - range) / 2;
+      range = SPARKLINE_MIN_RANGE;
+    }
+    uint8_t lastLevel = 0;
+    for (uint8_t i = 0; i < this->count; i++) {
+      const int16_t sample = this->samples[(oldest + i) % SPARKLINE_WIDTH];
+      const uint8_t level =
+        (static_cast<int32_t>(sample - low) * (SPARKLINE_HEIGHT - 1) +
+         range / 2) /
+        range;
+      uint8_t from = level;
+      uint8_t to = level;
+      if (i > 0) {
+        from = min(level, lastLevel);
+        to = max(level, lastLevel);
+      }
+      uint8_t column = 0;
+      for (uint8_t l = from; l <= to; l++) {
+        column |= 1 << (SPARKLINE_HEIGHT - 1 - l); // Level 0 is the bottom
+      }
+      out.columns[SPARKLINE_WIDTH - this->count + i] = column;
+      lastLevel = level;
+    }
+  }
+} // StockTicker
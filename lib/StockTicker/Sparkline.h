@@ -0,0 +1,66 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_SPARKLINE_H
+#define PICO2W_STOCK_TICKER_SPARKLINE_H
+
+#include <Arduino.h>
+
+namespace StockTicker {
+  // Samples kept per symbol, also the width of the sparkline in columns
+  const uint8_t SPARKLINE_WIDTH = 16;
+  const uint8_t SPARKLINE_HEIGHT = 8;
+  // Time covered by each sample, the same as the bars requested at startup
+  const uint32_t SPARKLINE_SAMPLE_PERIOD = 30 * 60 * 1000;
+  const char* const SPARKLINE_BARS_TIMEFRAME = "30Min";
+  // Smaller moves than this (in basis points) are drawn flatter, so noise
+  // doesn't fill the whole height
+  const int16_t SPARKLINE_MIN_RANGE = 20;
+
+  // One byte per column, the lowest bit is the top row
+  // clang-format off
+  struct SparklineColumns {
+    uint8_t columns[SPARKLINE_WIDTH];
+  };
+  // clang-format on
+
+  int16_t sparklineSample(int64_t changePercent);
+
+  /**
+   * @brief Fixed-size ring buffer of one symbol's recent price moves, as
+   *  basis points from the reference price, that renders itself as columns
+   *  of pixels.
+   */
+  class SparklineBuffer {
+    public:
+      SparklineBuffer() = default;
+      ~SparklineBuffer() = default;
+
+      void clear();
+      void push(int16_t sample);
+      void update(int16_t sample, uint32_t now);
+      void render(SparklineColumns& out) const;
+
+      /**
+       * @brief Check if samples changed since the last render().
+       *
+       * @return true if it needs to be rendered again.
+       */
+      bool isDirty() const {
+        return this->dirty;
+      }
+
+    protected:
+      int16_t samples[SPARKLINE_WIDTH];
+      // Index of the newest sample
+      uint8_t head = SPARKLINE_WIDTH - 1;
+      uint8_t count = 0;
+      // Whether the newest sample is still being updated, and since when
+      bool newestLive = false;
+      uint32_t newestTime = 0;
+      mutable bool dirty = false;
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_SPARKLINE_H
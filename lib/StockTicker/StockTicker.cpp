@@ -5,28 +5,99 @@
 #include <StockTicker.h>
 
 namespace StockTicker {
+  /**
+   * @brief Find the next symbol in a comma-separated symbols string. Empty
+   *  symbols are skipped, like strtok_r() does, but nothing is copied.
+   *
+   * @param rest Where to look from, moved past the symbol found.
+   * @param len Where to store the length of the symbol.
+   * @return const char* The start of the symbol, or nullptr if there are no
+   *  more symbols.
+   */
+  static const char* nextSymbol(const char*& rest, size_t& len) {
+    while (*rest == ',') {
+      rest++;
+    }
+    if (*rest == '\0') {
+      return nullptr;
+    }
+    const char* start = rest;
+    while (*rest != '\0' && *rest != ',') {
+      rest++;
+    }
+    len = rest - start;
+    return start;
+  }
+
   uint16_t stockSymbolsCount(const char* symbolsString) {
-    char str[MAX_SYMBOLS_STRING_LEN];
-    strncpy(str, symbolsString, MAX_SYMBOLS_STRING_LEN);
-    char* token;
-    char* rest = str;
+    const char* rest = symbolsString;
+    size_t tokenLen;
     uint16_t symbolCount = 0;
-    while ((token = strtok_r(rest, ",", &rest))) {
-      if (strlen(token) < MAX_ID_LEN) {
-        //        strncpy(allSymbolPrices[this->symbolCount].id, token,
-        //        MAX_ID_LEN);
-        //        // If price is negative than no data yet
-        //        allSymbolPrices[this->symbolCount].price = -1;
-        //        Serial1.printf("Symbol '%s' initialized at index %d\n", token,
-        //                       this->symbolCount);
+    while (nextSymbol(rest, tokenLen)) {
+      if (tokenLen < MAX_ID_LEN) {
         symbolCount++;
-      } else {
-        //        Serial1.printf("Symbol '%s' is too long, skipping.\n", token);
       }
     }
     return symbolCount;
   }
 
+  /**
+   * @brief Append text to a null terminated buffer, truncating it if needed.
+   *
+   * @param buf The buffer, with room for at least pos + 1 characters.
+   * @param len The size of buf.
+   * @param pos Where to append, the current length of the text in buf.
+   * @param text The text to append.
+   * @return The new length of the text in buf, never more than len - 1.
+   */
+  static size_t appendText(char* buf, size_t len, size_t pos,
+                           const char* text) {
+    while (*text != '\0' && pos < len - 1) {
+      buf[pos++] = *text++;
+    }
+    buf[pos] = '\0';
+    return pos;
+  }
+
+  /**
+   * @brief Get the name of an endpoint, for logging.
+   *
+   * @param endpoint The endpoint.
+   * @return const char*
+   */
+  static const char* endpointName(RequestEndpoint endpoint) {
+    switch (endpoint) {
+      case RequestEndpoint::SNAPSHOTS:
+        return "snapshots";
+      case RequestEndpoint::LATEST_TRADES:
+        return "latest trades";
+      case RequestEndpoint::BARS:
+        return "bars";
+    }
+    return "unknown";
+  }
+
+  /**
+   * @brief Convert the name of a data source, as used in the settings, to a
+   *  DataSource.
+   *
+   * @param name Either "snapshots", "latestTrades" or "stream".
+   * @param dataSource Where to store the data source.
+   * @return true if the name is valid.
+   */
+  bool dataSourceFromString(const char* name, DataSource& dataSource) {
+    if (strcmp(name, "snapshots") == 0) {
+      dataSource = DataSource::SNAPSHOTS;
+    } else if (strcmp(name, "latestTrades") == 0) {
+      dataSource = DataSource::LATEST_TRADES;
+    } else if (strcmp(name, "stream") == 0) {
+      dataSource = DataSource::STREAM;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
   /**
    * @brief Initialize with parameters
    *
@@ -42,258 +113,1424 @@ namespace StockTicker {
    *  account. The default is "iex".
    * @param request The time between each request in milliseconds. The default
    *  is 60 seconds.
+   * @param source Which endpoint to fetch prices from. The default is
+   *  DataSource::SNAPSHOTS.
    */
   void StockTicker::begin(const char* apiKeyId, const char* apiSecretKey,
                           const char* symbolsString,
                           const char* feed /* = "iex" */,
-                          uint32_t request /* = 60 * 1000*/) {
+                          uint32_t request /* = 60 * 1000*/,
+                          DataSource source /* = DataSource::SNAPSHOTS */) {
     this->apcaApiKeyId = apiKeyId;
     this->apcaApiSecretKey = apiSecretKey;
     this->sourceFeed = feed;
     this->requestPeriod = request;
-    // Parse comma-separated symbols string
+    this->dataSource = source;
+    this->hasReferencePrices = false;
+    this->needsBars = true;
+    this->retryPolicy.reset();
+    // Storage for exactly the symbols configured. The settings already
+    // checked they're within the limits, and each id plus its terminator
+    // takes no more room than it did in the symbols string.
     this->symbols = symbolsString;
-    memset(this->allSymbolPrices, 0, sizeof(this->allSymbolPrices));
-    // Temp string for strtok_r
-    char str[MAX_SYMBOLS_STRING_LEN];
-    strncpy(str, this->symbols, MAX_SYMBOLS_STRING_LEN);
-    char* token;
-    char* rest = str;
+    this->allocateSymbolStorage(
+      min(stockSymbolsCount(this->symbols), MAX_SYMBOLS),
+      min(strlen(this->symbols) + 1, MAX_SYMBOLS_STRING_LEN));
+    // Parse comma-separated symbols string, straight into the pool since a
+    // temporary copy of it would be big for the stack
+    const char* token;
+    const char* rest = this->symbols;
+    size_t tokenLen;
+    size_t poolLen = 0;
     this->symbolCount = 0;
-    while ((token = strtok_r(rest, ",", &rest)) &&
-           this->symbolCount < MAX_SYMBOLS) {
-      if (strlen(token) < MAX_ID_LEN) {
-        strncpy(this->allSymbolPrices[this->symbolCount].id, token, MAX_ID_LEN);
+    this->pricesChanged = false;
+    memset(this->lastResponseHashes, 0, sizeof(this->lastResponseHashes));
+    while ((token = nextSymbol(rest, tokenLen)) &&
+           this->symbolCount < this->symbolCapacity) {
+      if (tokenLen < MAX_ID_LEN &&
+          poolLen + tokenLen < this->symbolIdPoolSize) {
+        char* id = this->symbolIdPool + poolLen;
+        memcpy(id, token, tokenLen);
+        id[tokenLen] = '\0';
+        this->symbolIdOffsets[this->symbolCount] = poolLen;
+        poolLen += tokenLen + 1;
+        this->symbolIndex.insert(id, this->symbolCount);
         // If price is negative than no data yet
-        allSymbolPrices[this->symbolCount].price = -1;
-        Serial1.printf("Symbol '%s' initialized at index %d\n", token,
-                       this->symbolCount);
+        this->symbolPrices[this->symbolCount] = -1;
+        this->symbolChanges[this->symbolCount] = 0;
+        this->symbolChangePercents[this->symbolCount] = 0;
+        this->symbolReferencePrices[this->symbolCount] = 0;
+        this->displayedPrices[this->symbolCount] = {-1, 0, 0};
+        this->sparklines[this->symbolCount].clear();
+        this->symbolHasBars[this->symbolCount] = false;
+        memset(&this->displayedSparklines[this->symbolCount], 0,
+               sizeof(SparklineColumns));
+        this->symbolCached[this->symbolCount] = false;
+        LOG_DEBUG("Symbol '%s' initialized at index %d", id, this->symbolCount);
         this->symbolCount++;
       } else {
-        Serial1.printf("Symbol '%s' is too long, skipping.\n", token);
+        LOG_WARN("Symbol '%.*s' is too long, skipping.",
+                 static_cast<int>(tokenLen), token);
+      }
+    }
+    // Show the last known prices until the first fetch finishes
+    this->loadCachedPrices();
+    this->rebuildDisplayStr();
+
+    // Split the symbols into batches that each fit in one URL
+    size_t batchLen = 0;
+    this->batchStarts[0] = 0;
+    this->batchCount = 1;
+    for (uint16_t i = 0; i < this->symbolCount; i++) {
+      const size_t idLen = strlen(this->symbolId(i));
+      if (i > 0 && batchLen + 1 + idLen >= MAX_BATCH_SYMBOLS_LEN) {
+        this->batchStarts[this->batchCount++] = i;
+        batchLen = idLen;
+      } else {
+        batchLen += (i > 0 ? 1 : 0) + idLen;
+      }
+    }
+    this->batchStarts[this->batchCount] = this->symbolCount;
+    LOG_INFO("Requesting %d symbols in %d batches", this->symbolCount,
+             this->batchCount);
+
+    // The request only changes when switching between endpoints, so build it
+    // once and reuse the connection
+    char headers[MAX_REQUEST_LEN];
+    snprintf(headers, MAX_REQUEST_LEN,
+             "Accept: application/json\r\n"
+             "Accept-Encoding: gzip\r\n"
+             "Apca-Api-Key-Id: %s\r\n"
+             "Apca-Api-Secret-Key: %s\r\n",
+             this->apcaApiKeyId, this->apcaApiSecretKey);
+    // Reference prices are needed first in either mode
+    this->requestEndpoint = RequestEndpoint::SNAPSHOTS;
+    if (!this->httpClient.begin(this->dataHost, this->dataPort, "/",
+                                headers) ||
+        !this->setRequestPath(RequestEndpoint::SNAPSHOTS, 0)) {
+      LOG_ERROR("Request is too long, check symbols");
+    }
+
+    // wss://stream.data.alpaca.markets/v2/{FEED}
+    char streamPath[MAX_STREAM_PATH_LEN];
+    snprintf(streamPath, MAX_STREAM_PATH_LEN, "/v2/%s", this->sourceFeed);
+    this->streamClient.begin(this->streamHost, this->streamPort, streamPath,
+                             StockTicker::onStreamMessage, this);
+    this->streamState = StreamState::DISCONNECTED;
+    this->nextRequestTime = millis(); // Update as soon as possible
+  }
+
+  /**
+   * @brief Build the path of the request for one batch of symbols on one of
+   *  the endpoints.
+   *
+   * https://data.alpaca.markets/v2/stocks/snapshots?symbols={SYMBOLS}&feed={FEED}
+   * or
+   * https://data.alpaca.markets/v2/stocks/trades/latest?symbols={SYMBOLS}&feed={FEED}
+   * or
+   * https://data.alpaca.markets/v2/stocks/bars?symbols={SYMBOLS}&timeframe=30Min&limit=10000&feed={FEED}
+   *
+   * Bars start from the beginning of the current day when no start is given,
+   * which is what the sparklines cover.
+   *
+   * @param endpoint The endpoint.
+   * @param batch The batch of symbols to request.
+   * @param path Where to write the path, MAX_URL_LEN long.
+   */
+  void StockTicker::formatRequestPath(RequestEndpoint endpoint, uint8_t batch,
+                                      char* path) const {
+    const char* start = "/v2/stocks/snapshots?symbols=";
+    if (endpoint == RequestEndpoint::LATEST_TRADES) {
+      start = "/v2/stocks/trades/latest?symbols=";
+    } else if (endpoint == RequestEndpoint::BARS) {
+      start = "/v2/stocks/bars?symbols=";
+    }
+    size_t len = appendText(path, MAX_URL_LEN, 0, start);
+    const uint16_t first = this->batchStarts[batch];
+    for (uint16_t i = first; i < this->batchStarts[batch + 1]; i++) {
+      if (i > first) {
+        len = appendText(path, MAX_URL_LEN, len, ",");
       }
+      len = appendText(path, MAX_URL_LEN, len, this->symbolId(i));
+    }
+    if (endpoint == RequestEndpoint::BARS) {
+      char limit[8];
+      snprintf(limit, sizeof(limit), "%u", MAX_BARS_PER_REQUEST);
+      len = appendText(path, MAX_URL_LEN, len, "&timeframe=");
+      len = appendText(path, MAX_URL_LEN, len, SPARKLINE_BARS_TIMEFRAME);
+      len = appendText(path, MAX_URL_LEN, len, "&limit=");
+      len = appendText(path, MAX_URL_LEN, len, limit);
+    }
+    len = appendText(path, MAX_URL_LEN, len, "&feed=");
+    appendText(path, MAX_URL_LEN, len, this->sourceFeed);
+  }
+
+  /**
+   * @brief Point the request at one batch of symbols on one of the endpoints.
+   *
+   * @param endpoint The endpoint.
+   * @param batch The batch of symbols to request.
+   * @return true if the request fit.
+   */
+  bool StockTicker::setRequestPath(RequestEndpoint endpoint, uint8_t batch) {
+    char path[MAX_URL_LEN];
+    this->formatRequestPath(endpoint, batch, path);
+    if (!this->httpClient.setPath(path)) {
+      return false;
+    }
+    this->requestEndpoint = endpoint;
+    switch (endpoint) {
+      case RequestEndpoint::SNAPSHOTS:
+        this->activeParser = &this->snapshotParser;
+        break;
+      case RequestEndpoint::LATEST_TRADES:
+        this->activeParser = &this->latestTradesParser;
+        break;
+      case RequestEndpoint::BARS:
+        this->activeParser = &this->barsParser;
+        break;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Take every array with an entry per symbol from the symbol storage,
+   *  sized for symbolCapacity symbols and a symbolIdPoolSize long pool.
+   *
+   * @param storage Where to take them from, or a BlockCarver without a block
+   *  to measure how big the storage has to be.
+   */
+  void StockTicker::carveSymbolStorage(BlockCarver& storage) {
+    const uint16_t capacity = this->symbolCapacity;
+    // Most aligned first, so there's less padding
+    this->symbolPrices = storage.take<int64_t>(capacity);
+    this->symbolChanges = storage.take<int64_t>(capacity);
+    this->symbolChangePercents = storage.take<int64_t>(capacity);
+    this->symbolReferencePrices = storage.take<int64_t>(capacity);
+    this->displayedPrices = storage.take<PriceValues>(capacity);
+    this->incomingPrices = storage.take<PriceValues>(capacity);
+    this->priceTable.begin(storage, capacity);
+    this->symbolIndex.begin(storage, capacity);
+    this->sparklines = storage.take<SparklineBuffer>(capacity);
+    this->displayedSparklines = storage.take<SparklineColumns>(capacity);
+    this->incomingSparklines = storage.take<SparklineColumns>(capacity);
+    this->displaySegments = storage.take<DisplaySegment>(capacity);
+    this->symbolIdOffsets = storage.take<uint16_t>(capacity);
+    this->symbolHasBars = storage.take<bool>(capacity);
+    this->symbolCheckpoints = storage.take<SymbolCheckpoint>(capacity);
+    this->symbolCached = storage.take<bool>(capacity);
+    this->symbolIdPool = storage.take<char>(this->symbolIdPoolSize);
+    this->displayStrSize = capacity * MAX_SYMBOL_DISPLAY_STR_LEN + 1;
+    this->displayStr = storage.take<char>(this->displayStrSize);
+  }
+
+  /**
+   * @brief Replace the symbol storage with one sized for the symbols being
+   *  configured, in one allocation.
+   *
+   * @param capacity How many symbols.
+   * @param poolSize How long the pool of ids has to be, with terminators.
+   */
+  void StockTicker::allocateSymbolStorage(uint16_t capacity, size_t poolSize) {
+    this->freeSymbolStorage();
+    this->symbolCapacity = capacity;
+    this->symbolIdPoolSize = poolSize;
+    BlockCarver measure(nullptr);
+    this->carveSymbolStorage(measure);
+    this->symbolStorage = static_cast<uint8_t*>(malloc(measure.size()));
+    if (this->symbolStorage == nullptr) {
+      LOG_ERROR("No memory for %u symbols, %u bytes", capacity,
+                static_cast<unsigned>(measure.size()));
+      // Still give the display string somewhere to be
+      this->symbolCapacity = 0;
+      this->symbolIdPoolSize = 0;
+      this->carveSymbolStorage(measure);
+      this->symbolStorage = static_cast<uint8_t*>(malloc(measure.size()));
     }
-    this->nextRequestTime = 0; // Update as soon as possible
+    Telemetry::metrics.set(Telemetry::MetricGauge::SYMBOL_STORAGE,
+                           measure.size());
+    LOG_INFO("Symbol storage is %u bytes for %u symbols",
+             static_cast<unsigned>(measure.size()), this->symbolCapacity);
+    BlockCarver carver(this->symbolStorage);
+    this->carveSymbolStorage(carver);
+    this->symbolIndex.clear();
+    this->displayStr[0] = '\0';
+    this->displayStrLen = 0;
+  }
+
+  /**
+   * @brief Free the symbol storage, leaving no symbols.
+   */
+  void StockTicker::freeSymbolStorage() {
+    BlockCarver none(nullptr);
+    this->symbolCapacity = 0;
+    this->symbolIdPoolSize = 0;
+    this->carveSymbolStorage(none); // Every pointer back to nullptr
+    this->symbolIndex.clear();
+    this->symbolCount = 0;
+    this->displayStrLen = 0;
+    free(this->symbolStorage);
+    this->symbolStorage = nullptr;
   }
 
-#define RESCHEDULE_MACRO()                                                     \
-  {                                                                            \
-    Serial1.printf("Next request in %d seconds", this->requestPeriod / 1000);  \
-    this->nextRequestTime = millis() + this->requestPeriod;                    \
+  /**
+   * @brief Deinitialize. Closes the connection to the API and frees the
+   *  symbol storage.
+   */
+  void StockTicker::end() {
+    this->httpClient.end();
+    this->streamClient.close();
+    this->streamState = StreamState::DISCONNECTED;
+    this->freeSymbolStorage();
   }
+
   /**
    * @brief Update the StockTicker.
    *
    * This function should be called periodically to update the StockTicker. It
    * will check if it's time to make a request to the API and update the symbol
    * prices accordingly.
+   *
+   * Fetching is split into steps (send the request, read the headers, parse
+   * the body a piece at a time) and each call only does a bounded amount of
+   * work, so the caller's loop keeps running during a fetch. Symbols are
+   * requested in batches that are pipelined on the same connection, so
+   * later batches are on the way while the first ones are parsed.
+   *
+   * In DataSource::STREAM mode, this fetches one snapshot for the reference
+   * prices and then handles the stream instead.
    */
   void StockTicker::update() {
-    if (this->nextRequestTime > millis()) {
+    if (this->cancelRequested) {
+      this->cancelRequested = false;
+      this->httpClient.cancel();
+      this->fetchState = FetchState::IDLE;
+      this->streamClient.close();
+      this->streamState = StreamState::DISCONNECTED;
+    }
+    if (this->fetchState == FetchState::IDLE) {
+      this->savePricesIfDue(); // Never in the middle of a fetch
+    }
+    const uint32_t stepStartTime = micros();
+    if (this->dataSource == DataSource::STREAM && this->hasReferencePrices &&
+        !this->needsBars && this->fetchState == FetchState::IDLE) {
+      this->pollStream();
+      const uint32_t stepTime = micros() - stepStartTime;
+      if (stepTime > this->longestStepTime) {
+        this->longestStepTime = stepTime;
+      }
+      return;
+    }
+    if (this->fetchState != FetchState::IDLE) {
+      this->queueNextBatch();
+    }
+    switch (this->fetchState) {
+      case FetchState::IDLE:
+        this->startFetch();
+        break;
+      case FetchState::REQUESTING:
+        this->pollRequest();
+        break;
+      case FetchState::PARSING:
+        this->pollParse();
+        break;
+      case FetchState::VERIFYING:
+        this->pollVerify();
+        break;
+      case FetchState::LOGGING_ERROR_BODY:
+        this->pollErrorBody();
+        break;
+      case FetchState::FINISHING:
+        this->pollFinishResponse();
+        break;
+    }
+    const uint32_t stepTime = micros() - stepStartTime;
+    if (stepTime > this->longestStepTime) {
+      this->longestStepTime = stepTime;
+    }
+  }
+
+  /**
+   * @brief Abort the fetch in progress, if any. Takes effect on the next
+   *  update(), so it is safe to call from the other core.
+   */
+  void StockTicker::cancel() {
+    this->cancelRequested = true;
+  }
+
+  /**
+   * @brief Render the latest prices published by update() into the display
+   *  string. Call this from the core that reads the display string, which may
+   *  be a different core from the one calling update().
+   *
+   * @return true if the display string changed.
+   */
+  bool StockTicker::updateDisplay() {
+    if (!this->priceTable.readIfChanged(this->incomingPrices,
+                                        this->incomingSparklines,
+                                        this->symbolCount)) {
+      return false;
+    }
+    LOG_DEBUG(
+      "Price handoff %lu of %lu published, %lu reader retries",
+      static_cast<unsigned long>(this->priceTable.getHandoffCount()),
+      static_cast<unsigned long>(this->priceTable.getPublishCount()),
+      static_cast<unsigned long>(this->priceTable.getReaderRetryCount()));
+    this->updateDisplayStr();
+    return true;
+  }
+
+  void StockTicker::startFetch() {
+    // Compares the difference so it still works when millis() wraps
+    if (static_cast<int32_t>(this->nextRequestTime - millis()) > 0) {
       return; // Not time to request yet
     }
-    Serial1.println("Time to request data from Alpaca Markets API");
+    LOG_DEBUG("Time to request data from Alpaca Markets API");
 
     if (WiFi.status() != WL_CONNECTED) {
-      Serial1.println("No WiFi connection, cannot update stock prices.");
+      LOG_WARN("No WiFi connection, cannot update stock prices.");
       this->status = StockTickerStatus::ERROR_NO_WIFI;
-      RESCHEDULE_MACRO()
+      this->fetchStatusCode = HTTP_ERROR_CONNECTION_FAILED;
+      this->scheduleNextRequest();
       return;
     }
 
-#ifdef LOG_FREE_MEMORY
-    Serial1.printf("Free memory before request: heap %d kb, stack %d kb\n",
-                   rp2040.getFreeHeap() / 1024, rp2040.getFreeStack() / 1024);
-#endif
-    { // Scope to destroy client and parser to print free memory after request
-      // https://data.alpaca.markets/v2/stocks/snapshots?symbols={SYMBOLS}&feed={FEED}
-      HTTPClient httpsClient;
-      httpsClient.setInsecure();
-      httpsClient.useHTTP10(true);
-      const size_t MAX_URL_LEN = 80 + MAX_SYMBOLS_STRING_LEN;
-      char url[MAX_URL_LEN];
-      snprintf(
-        url, MAX_URL_LEN,
-        "https://data.alpaca.markets/v2/stocks/snapshots?symbols=%s&feed=%s",
-        this->symbols, this->sourceFeed);
-      Serial1.printf("Requesting %s\n", url);
-      if (httpsClient.begin(url)) {
-        httpsClient.addHeader("Accept", "application/json");
-        httpsClient.addHeader("Apca-Api-Key-Id", this->apcaApiKeyId);
-        httpsClient.addHeader("Apca-Api-Secret-Key", this->apcaApiSecretKey);
-        int32_t statusCode = httpsClient.GET();
-#ifdef LOG_FREE_MEMORY
-        Serial1.printf(
-          "Free memory after sending request: heap %d kb, stack %d kb\n",
-          rp2040.getFreeHeap() / 1024, rp2040.getFreeStack() / 1024);
-#endif
-#ifdef BUFFER_JSON_READING
-        ReadBufferingClient bufferedClient(httpsClient.getStream(), 256);
-#endif
-        if (statusCode == 200) { // OK
-          JsonDocument doc;
+    Telemetry::metrics.add(Telemetry::MetricCounter::FETCHES);
+    Telemetry::metrics.sampleMemory();
+    // In latest trades mode, a (much bigger) snapshot is only requested when
+    // the reference prices are missing or old
+    RequestEndpoint endpoint = RequestEndpoint::LATEST_TRADES;
+    if (this->dataSource == DataSource::SNAPSHOTS ||
+        !this->hasReferencePrices ||
+        millis() - this->referencePriceTime >= REFERENCE_PRICE_MAX_AGE) {
+      endpoint = RequestEndpoint::SNAPSHOTS;
+    }
+    if (this->hasReferencePrices && this->needsBars) {
+      // Only tried once, the sparklines fill up from the prices otherwise
+      endpoint = RequestEndpoint::BARS;
+      this->needsBars = false;
+    }
+    // The rest of the batches are pipelined by queueNextBatch()
+    this->setRequestPath(endpoint, 0);
+    this->currentBatch = 0;
+    this->batchesRequested = 1;
+    this->fetchStartTime = millis();
+    this->longestStepTime = 0;
+    this->fetchBodyBytes = 0;
+    this->fetchParseTime = 0;
+    this->fetchStatusCode = 0;
+    this->retryPolicy.onAttempt();
+    this->httpClient.startGet();
+    this->fetchState = FetchState::REQUESTING;
+  }
+
+  void StockTicker::pollRequest() {
+    const HttpRequestState state = this->httpClient.poll();
+    if (state == HttpRequestState::ERROR) {
+      this->setErrorStatus(this->httpClient.getStatusCode());
+      this->httpClient.finishResponse();
+      this->fetchState = FetchState::FINISHING;
+      return;
+    }
+    if (state != HttpRequestState::READING_BODY) {
+      return; // Still connecting, sending, or reading headers
+    }
+    LOG_DEBUG("Requested %s batch %d of %d over %s connection",
+              endpointName(this->requestEndpoint), this->currentBatch + 1,
+              this->batchCount,
+              this->httpClient.lastRequestReusedConnection() ? "reused"
+                                                             : "new");
+    const HttpTimings timings = this->httpClient.takeTimings();
+    if (timings.connect != 0) {
+      Telemetry::metrics.add(Telemetry::MetricCounter::NEW_CONNECTIONS);
+      Telemetry::metrics.record(Telemetry::MetricTiming::CONNECT,
+                                timings.connect);
+    }
+    if (timings.firstByte != 0) {
+      Telemetry::metrics.record(Telemetry::MetricTiming::FIRST_BYTE,
+                                timings.firstByte);
+    }
+    Telemetry::metrics.add(Telemetry::MetricCounter::RESPONSES);
+    Telemetry::metrics.sampleMemory(); // The TLS handshake is the deepest
+    this->responseStartTime = micros();
+    this->responseParseTime = 0;
+    this->responseHash = FNV_OFFSET_BASIS;
+    // The server may not compress, ex. small bodies, so it's up to each
+    // response
+    if (this->httpClient.isGzipEncoded()) {
+      this->inflater.begin(&this->httpClient);
+      this->responseBody = &this->inflater;
+    } else {
+      this->responseBody = &this->httpClient;
+    }
+    const int32_t statusCode = this->httpClient.getStatusCode();
+    if (statusCode == 200) { // OK
 #ifdef LOG_JSON_PARSED
-          Serial1.println("JSON read:");
-  #ifdef BUFFER_JSON_READING
-          ReadLoggingStream loggingStream(bufferedClient, Serial1);
-  #else
-          ReadLoggingStream loggingStream(httpsClient.getStream(), Serial1);
-  #endif
-          DeserializationError error = deserializeJson(doc, loggingStream);
-          Serial1.println("");
-#else
-  #ifdef BUFFER_JSON_READING
-          DeserializationError error = deserializeJson(doc, bufferedClient);
-  #else
-          DeserializationError error =
-            deserializeJson(doc, httpsClient.getStream());
-  #endif
+      Serial1.println("JSON read:");
 #endif
-#ifdef LOG_FREE_MEMORY
-          Serial1.printf(
-            "Free memory after JSON parse: heap %d kb, stack %d kb\n",
-            rp2040.getFreeHeap() / 1024, rp2040.getFreeStack() / 1024);
+      this->activeParser->reset();
+      this->checkpointBatch();
+      this->fetchState = FetchState::PARSING;
+    } else {
+      this->setErrorStatus(statusCode);
+      this->fetchState = FetchState::LOGGING_ERROR_BODY;
+    }
+  }
+
+  void StockTicker::pollParse() {
+    const uint32_t parseStartTime = micros();
+    for (size_t i = 0; i < MAX_BYTES_PARSED_PER_UPDATE; i++) {
+      const int c = this->responseBody->read();
+      if (c < 0) {
+        break;
+      }
+      this->fetchBodyBytes++;
+      this->responseHash = (this->responseHash ^ c) * FNV_PRIME;
+#ifdef LOG_JSON_PARSED
+      Serial1.write(c);
 #endif
-          if (error) {
-            Serial1.printf("Failed to parse JSON: %s\n", error.c_str());
-            this->status = StockTickerStatus::ERROR_BAD_JSON_RESPONSE;
-          } else {
-            for (JsonPair snapshot : doc.as<JsonObject>()) {
-              const char* symbol = snapshot.key().c_str();
-              JsonObject daily_bar = snapshot.value()["dailyBar"];
-              float open_price = daily_bar["o"];  // Start of day price
-              float close_price = daily_bar["c"]; // End of day / current price
-              this->updateSymbolPriceInMemory(
-                symbol, close_price, close_price - open_price,
-                ((close_price - open_price) / open_price) * 100.0f);
-            }
-            this->updateDisplayStr();
-          }
-        } else {
-          Serial1.printf("Bad status code: %d\n", statusCode);
-          switch (statusCode) {
-            case HTTPC_ERROR_CONNECTION_FAILED: {
-              Serial1.println("Connection failed, check WiFi connection");
-              this->status = StockTickerStatus::ERROR_CONNECTION_FAILED;
-              break;
-            }
-            case HTTPC_ERROR_SEND_HEADER_FAILED: {
-              Serial1.println("Failed to send header, check WiFi connection");
-              this->status = StockTickerStatus::ERROR_SEND_HEADER_FAILED;
-              break;
-            }
-            case HTTPC_ERROR_SEND_PAYLOAD_FAILED: {
-              Serial1.println("Failed to send payload, check WiFi connection");
-              this->status = StockTickerStatus::ERROR_SEND_PAYLOAD_FAILED;
-              break;
-            }
-            case 400: {
-              Serial1.println("Bad request, check API key and secret");
-              this->status = StockTickerStatus::ERROR_BAD_REQUEST;
-              break;
-            }
-            case 403: {
-              Serial1.println("Forbidden, check API key and secret");
-              this->status = StockTickerStatus::ERROR_FORBIDDEN;
-              break;
-            }
-            case 429: {
-              Serial1.println("Too many requests, check request period");
-              this->status = StockTickerStatus::ERROR_TOO_MANY_REQUESTS;
-              break;
-            }
-            case 500: {
-              Serial1.println("Internal server error, check Alpaca Markets' "
-                              "Slack or Community Forum and try again later");
-              this->status = StockTickerStatus::ERROR_INTERNAL_SERVER_ERROR;
-              break;
-            }
-            default: {
-              Serial1.printf("Unknown error, status code: %d\n", statusCode);
-              this->status = StockTickerStatus::ERROR_UNKNOWN;
-              break;
-            }
-          }
-          Serial1.println("Response: ");
-#ifdef BUFFER_JSON_READING
-          while (bufferedClient.available()) {
-            Serial1.write(bufferedClient.read());
-          }
-#else
-          while (httpsClient.getStream().available()) {
-            Serial1.write(httpsClient.getStream().read());
-          }
+      if (this->activeParser->feed(static_cast<char>(c)) !=
+          JsonStreamStatus::IN_PROGRESS) {
+        break;
+      }
+    }
+    this->fetchParseTime += micros() - parseStartTime;
+    this->responseParseTime += micros() - parseStartTime;
+    JsonStreamStatus result = this->activeParser->getStatus();
+    if (result == JsonStreamStatus::IN_PROGRESS) {
+      if (this->responseBody == &this->inflater &&
+          this->inflater.getStatus() != InflateStatus::IN_PROGRESS) {
+        // Corrupt, or the compressed stream ended early
+        result = JsonStreamStatus::ERROR_INCOMPLETE_INPUT;
+      } else if (this->httpClient.bodyComplete()) {
+        result = JsonStreamStatus::ERROR_INCOMPLETE_INPUT;
+      } else if (this->httpClient.poll() == HttpRequestState::ERROR) {
+        this->setErrorStatus(this->httpClient.getStatusCode());
+        this->httpClient.finishResponse();
+        this->fetchState = FetchState::FINISHING;
+        return;
+      } else {
+        return; // Wait for more of the body
+      }
+    }
+#ifdef LOG_JSON_PARSED
+    Serial1.println("");
 #endif
-          return;
+    if (result != JsonStreamStatus::DONE) {
+      LOG_ERROR("Failed to parse JSON: %d", static_cast<int>(result));
+    } else if (this->responseBody == &this->inflater &&
+               this->inflater.getStatus() != InflateStatus::DONE) {
+      // Only trusted once the CRC and size in the trailer check out
+      this->fetchState = FetchState::VERIFYING;
+      return;
+    }
+    this->finishBatch(result == JsonStreamStatus::DONE);
+  }
+
+  /**
+   * @brief Read the rest of a gzip body after its JSON, ex. the end of the
+   *  last block, so the inflater gets to the trailer and checks the CRC-32
+   *  and size of everything that was parsed.
+   */
+  void StockTicker::pollVerify() {
+    for (size_t i = 0; i < MAX_BYTES_PARSED_PER_UPDATE; i++) {
+      if (this->inflater.read() < 0) {
+        break;
+      }
+    }
+    const InflateStatus inflateStatus = this->inflater.getStatus();
+    if (inflateStatus == InflateStatus::IN_PROGRESS) {
+      if (this->httpClient.bodyComplete()) {
+        LOG_ERROR("Compressed body ended before its trailer");
+        this->finishBatch(false);
+      } else if (this->httpClient.poll() == HttpRequestState::ERROR) {
+        this->setErrorStatus(this->httpClient.getStatusCode());
+        this->httpClient.finishResponse();
+        this->fetchState = FetchState::FINISHING;
+      }
+      return; // Otherwise wait for more of the body
+    }
+    if (inflateStatus == InflateStatus::ERROR) {
+      LOG_ERROR("Compressed body is corrupt, rejecting the batch");
+    }
+    this->finishBatch(inflateStatus == InflateStatus::DONE);
+  }
+
+  /**
+   * @brief Save what the symbols of the current batch have before its body
+   *  is parsed into them, see rollbackBatch().
+   */
+  void StockTicker::checkpointBatch() {
+    for (uint16_t i = this->batchStarts[this->currentBatch];
+         i < this->batchStarts[this->currentBatch + 1]; i++) {
+      this->symbolCheckpoints[i] = {this->symbolReferencePrices[i],
+                                    this->sparklines[i],
+                                    this->symbolHasBars[i]};
+    }
+  }
+
+  /**
+   * @brief Finish the response to the current batch: keep what it wrote to
+   *  the symbols and publish it, or throw it away if the body was bad.
+   *
+   * @param valid Whether the whole body was parsed, and checked if it was
+   *  compressed.
+   */
+  void StockTicker::finishBatch(bool valid) {
+    Telemetry::metrics.record(Telemetry::MetricTiming::BODY,
+                              micros() - this->responseStartTime);
+    Telemetry::metrics.record(Telemetry::MetricTiming::PARSE,
+                              this->responseParseTime);
+    Telemetry::metrics.sampleMemory();
+    if (!valid) {
+      this->status = StockTickerStatus::ERROR_BAD_JSON_RESPONSE;
+      this->fetchStatusCode = HTTP_ERROR_BAD_RESPONSE;
+      this->rollbackBatch();
+    } else {
+      // Only counted, by now the body was already parsed and its symbols
+      // compared one by one, which is what skips the unchanged ones. Even
+      // an identical latest trade changes with the reference price.
+      uint32_t& lastHash = this->lastResponseHashes[static_cast<uint8_t>(
+        this->requestEndpoint)][this->currentBatch];
+      if (this->responseHash == lastHash) {
+        Telemetry::metrics.add(Telemetry::MetricCounter::RESPONSES_IDENTICAL);
+      }
+      lastHash = this->responseHash;
+      if (this->requestEndpoint == RequestEndpoint::BARS) {
+        this->finishBars();
+      }
+      // Prices were already written by StockTicker::onSnapshot() or
+      // StockTicker::onLatestTrade(). Publishing after every batch that
+      // changed something merges them into the display, which only
+      // re-renders the symbols that changed.
+      this->publishPrices();
+      if (this->currentBatch + 1 >= this->batchCount) {
+        if (this->requestEndpoint == RequestEndpoint::SNAPSHOTS) {
+          this->hasReferencePrices = true;
+          this->referencePriceTime = millis();
         }
-      } else {
-        Serial1.println("Failed to initialize request");
+        this->status = StockTickerStatus::OK;
+        this->fetchStatusCode = 200;
+      }
+    }
+    LOG_INFO("Parsed %s batch %d of %d, %lu bytes in %lu us so far",
+             endpointName(this->requestEndpoint),
+             this->currentBatch + 1, this->batchCount,
+             static_cast<unsigned long>(this->fetchBodyBytes),
+             static_cast<unsigned long>(this->fetchParseTime));
+    this->httpClient.finishResponse();
+    this->fetchState = FetchState::FINISHING;
+  }
+
+  /**
+   * @brief Undo what a rejected batch already wrote to its symbols while it
+   *  was parsed, so a later publish doesn't show it. The prices go back to
+   *  the last published ones, which every earlier batch is part of, and the
+   *  rest to what checkpointBatch() saved.
+   */
+  void StockTicker::rollbackBatch() {
+    const PriceValues* published = this->priceTable.getPublished();
+    for (uint16_t i = this->batchStarts[this->currentBatch];
+         i < this->batchStarts[this->currentBatch + 1]; i++) {
+      const PriceValues& values = published[i];
+      this->symbolPrices[i] = values.price > 0 ? values.price : -1;
+      this->symbolChanges[i] = values.change;
+      this->symbolChangePercents[i] = values.changePercent;
+      const SymbolCheckpoint& checkpoint = this->symbolCheckpoints[i];
+      this->symbolReferencePrices[i] = checkpoint.referencePrice;
+      this->sparklines[i] = checkpoint.sparkline;
+      this->symbolHasBars[i] = checkpoint.hasBars;
+    }
+    this->pricesChanged = false;
+  }
+
+  void StockTicker::pollErrorBody() {
+    // Logged a chunk at a time, the error messages are short anyways
+    char chunk[Telemetry::LOG_MAX_STRING_LEN];
+    size_t len = 0;
+    while (len < sizeof(chunk)) {
+      const int c = this->responseBody->read();
+      if (c < 0) {
+        break;
+      }
+      chunk[len++] = c;
+    }
+    if (len > 0) {
+      LOG_WARN("Response: %.*s", static_cast<int>(len), chunk);
+    }
+    if (this->httpClient.bodyComplete() ||
+        (this->responseBody == &this->inflater &&
+         this->inflater.getStatus() != InflateStatus::IN_PROGRESS) ||
+        this->httpClient.poll() == HttpRequestState::ERROR) {
+      this->httpClient.finishResponse();
+      this->fetchState = FetchState::FINISHING;
+    }
+  }
+
+  /**
+   * @brief Pipeline the request for the next batch as soon as the connection
+   *  can take it, so its response is already on the way when the current one
+   *  is done.
+   */
+  void StockTicker::queueNextBatch() {
+    if (this->batchesRequested >= this->batchCount ||
+        this->fetchStatusCode != 0 || !this->httpClient.canQueueGet()) {
+      return;
+    }
+    char path[MAX_URL_LEN];
+    this->formatRequestPath(this->requestEndpoint, this->batchesRequested,
+                            path);
+    if (this->httpClient.queueGet(path)) {
+      this->batchesRequested++;
+    }
+  }
+
+  /**
+   * @brief Wait for the client to be done with the current response, then
+   *  go on to the next batch. Its response is usually already pipelined,
+   *  otherwise it is requested again, ex. if the server closed the
+   *  connection before answering it.
+   */
+  void StockTicker::pollFinishResponse() {
+    const HttpRequestState state = this->httpClient.poll();
+    if (state == HttpRequestState::FINISHING) {
+      return;
+    }
+    if (state == HttpRequestState::ERROR) {
+      // Only a pipelined request failing to send gets here
+      if (this->fetchStatusCode == 0) {
+        this->setErrorStatus(this->httpClient.getStatusCode());
+      }
+      this->httpClient.finishResponse();
+      this->finishFetch();
+      return;
+    }
+    if (this->fetchStatusCode != 0) {
+      // Done, or a batch failed so the rest aren't needed
+      if (state != HttpRequestState::IDLE) {
+        this->httpClient.cancel();
+      }
+      this->finishFetch();
+      return;
+    }
+    this->currentBatch++;
+    if (state == HttpRequestState::IDLE) {
+      this->setRequestPath(this->requestEndpoint, this->currentBatch);
+      this->batchesRequested = this->currentBatch + 1;
+      this->httpClient.startGet();
+    }
+    this->fetchState = FetchState::REQUESTING;
+  }
+
+  void StockTicker::finishFetch() {
+    LOG_INFO("Poll took %lu ms, longest step took %lu us",
+             millis() - this->fetchStartTime,
+             static_cast<unsigned long>(this->longestStepTime));
+    Telemetry::metrics.add(Telemetry::MetricCounter::BYTES_RECEIVED,
+                           this->httpClient.takeBytesReceived());
+    this->countStatus();
+    this->fetchState = FetchState::IDLE;
+    if (this->hasReferencePrices && this->needsBars &&
+        this->fetchStatusCode == 200) {
+      // Right after the first reference prices, fill in the sparklines
+      this->retryPolicy.onResult(200, this->httpClient.getRateLimitInfo(),
+                                 this->requestPeriod);
+      this->nextRequestTime = millis();
+      return;
+    }
+    // Also in DataSource::STREAM mode, so the retry policy sees the success
+    // and doesn't stay backed off for the next reference price fetch
+    this->scheduleNextRequest();
+    if (this->dataSource == DataSource::STREAM && this->hasReferencePrices) {
+      // Done with REST, don't keep a second TLS connection open
+      this->httpClient.cancel();
+      LOG_INFO("Reference prices fetched, switching to the stream");
+    }
+  }
+
+  /**
+   * @brief Set when the next request is made from how the last one went,
+   *  see RetryPolicy.
+   */
+  void StockTicker::scheduleNextRequest() {
+    const uint32_t delay = this->retryPolicy.onResult(
+      this->fetchStatusCode, this->httpClient.getRateLimitInfo(),
+      this->requestPeriod);
+    LOG_INFO("Next request in %lu seconds",
+             static_cast<unsigned long>(delay / 1000));
+    this->nextRequestTime = millis() + delay;
+  }
+
+  /**
+   * @brief Set the status from a failed request.
+   *
+   * @param statusCode The HTTP status code, or a negative HTTP_ERROR_* value.
+   */
+  void StockTicker::setErrorStatus(int32_t statusCode) {
+    LOG_WARN("Bad status code: %d", statusCode);
+    // Decides how long to back off before retrying
+    this->fetchStatusCode = statusCode;
+    switch (statusCode) {
+      case HTTP_ERROR_NOT_INITIALIZED: {
+        LOG_ERROR("Request was not initialized, check symbols");
         this->status = StockTickerStatus::ERROR_INIT_REQUEST_FAILED;
+        break;
+      }
+      case HTTP_ERROR_CONNECTION_FAILED:
+        // Fallthrough
+      case HTTP_ERROR_CONNECTION_LOST:
+        // Fallthrough
+      case HTTP_ERROR_READ_TIMEOUT: {
+        LOG_ERROR("Connection failed, check WiFi connection");
+        this->status = StockTickerStatus::ERROR_CONNECTION_FAILED;
+        break;
+      }
+      case HTTP_ERROR_SEND_FAILED: {
+        LOG_ERROR("Failed to send header, check WiFi connection");
+        this->status = StockTickerStatus::ERROR_SEND_HEADER_FAILED;
+        break;
+      }
+      case 400: {
+        LOG_ERROR("Bad request, check API key and secret");
+        this->status = StockTickerStatus::ERROR_BAD_REQUEST;
+        break;
+      }
+      case 403: {
+        LOG_ERROR("Forbidden, check API key and secret");
+        this->status = StockTickerStatus::ERROR_FORBIDDEN;
+        break;
+      }
+      case 429: {
+        LOG_WARN("Too many requests, check request period");
+        this->status = StockTickerStatus::ERROR_TOO_MANY_REQUESTS;
+        break;
+      }
+      case 500: {
+        LOG_ERROR("Internal server error, check Alpaca Markets' "
+                  "Slack or Community Forum and try again later");
+        this->status = StockTickerStatus::ERROR_INTERNAL_SERVER_ERROR;
+        break;
+      }
+      default: {
+        LOG_ERROR("Unknown error, status code: %d", statusCode);
+        this->status = StockTickerStatus::ERROR_UNKNOWN;
+        break;
       }
     }
-#ifdef LOG_FREE_MEMORY
-    Serial1.printf("Free memory after request: heap %d kb, stack %d kb\n",
-                   rp2040.getFreeHeap() / 1024, rp2040.getFreeStack() / 1024);
-#endif
+  }
 
-    this->status = StockTickerStatus::OK;
-    RESCHEDULE_MACRO()
+  /**
+   * @brief Count how a fetch, or a stream connection, ended.
+   */
+  void StockTicker::countStatus() {
+    const uint8_t i = static_cast<uint8_t>(this->status);
+    if (i < STATUS_COUNT) {
+      this->statusCounts[i]++;
+    }
+  }
+
+  /**
+   * @brief Print the metrics, see Metrics::print(), and how many fetches
+   *  ended with each status.
+   *
+   * @param out Where to print, ex. Serial1.
+   */
+  void StockTicker::printMetrics(Print& out) const {
+    static const char* const statusNames[STATUS_COUNT] = {
+      "ok",
+      "no_wifi",
+      "init_request_failed",
+      "connection_failed",
+      "send_header_failed",
+      "send_payload_failed",
+      "bad_json_response",
+      "bad_request",
+      "forbidden",
+      "too_many_requests",
+      "internal_server_error",
+      "unknown"};
+    Telemetry::metrics.print(out);
+    for (uint8_t i = 0; i < STATUS_COUNT; i++) {
+      if (this->statusCounts[i] > 0) {
+        out.printf("status_%s: %lu\n", statusNames[i],
+                   static_cast<unsigned long>(this->statusCounts[i]));
+      }
+    }
   }
-#undef RESCHEDULE_MACRO
 
   /**
    * @brief Updates the symbol with new price, change, and change percent
-   * data.
+   * data. Unchanged prices are only counted, so they don't get published or
+   * rendered again.
    *
    * @param id The symbol of the stock.
    * @param price The new price of the stock.
    * @param change The change in price of the stock.
    * @param changePercent The change percent of the stock.
    */
-  void StockTicker::updateSymbolPriceInMemory(const char* id, float price,
-                                              float change,
-                                              float changePercent) {
-    for (auto& allSymbolPrice : this->allSymbolPrices) {
-      if (strcmp(allSymbolPrice.id, id) == 0) {
-        allSymbolPrice.price = price;
-        allSymbolPrice.change = change;
-        allSymbolPrice.changePercent = changePercent;
-        Serial1.printf("Updated symbol %s in symbol data list (price: %.2f, "
-                       "change: %.2f, changePercent: %.2f%%)\n",
-                       allSymbolPrice.id, price, change, changePercent);
+  void StockTicker::updateSymbolPriceInMemory(const char* id, int64_t price,
+                                              int64_t change,
+                                              int64_t changePercent) {
+    const int16_t slot = this->symbolIndex.find(id);
+    if (slot >= 0) {
+      if (this->symbolPrices[slot] == price &&
+          this->symbolChanges[slot] == change &&
+          this->symbolChangePercents[slot] == changePercent) {
+        Telemetry::metrics.add(
+          Telemetry::MetricCounter::SYMBOL_UPDATES_SKIPPED);
+        // Still moves the sparkline on once its newest sample is old enough
+        if (price > 0) {
+          this->sparklines[slot].update(sparklineSample(changePercent),
+                                        millis());
+        }
         return;
       }
+      Telemetry::metrics.add(Telemetry::MetricCounter::SYMBOL_UPDATES_APPLIED);
+      this->pricesChanged = true;
+      this->symbolPrices[slot] = price;
+      this->symbolChanges[slot] = change;
+      this->symbolChangePercents[slot] = changePercent;
+      if (price > 0) {
+        this->sparklines[slot].update(sparklineSample(changePercent),
+                                      millis());
+      }
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+      char priceStr[24];
+      char changeStr[24];
+      char changePercentStr[24];
+      formatFixedPoint(price, 2, false, priceStr, sizeof(priceStr));
+      formatFixedPoint(change, 2, false, changeStr, sizeof(changeStr));
+      formatFixedPoint(changePercent, 2, false, changePercentStr,
+                       sizeof(changePercentStr));
+      LOG_DEBUG("Updated symbol %s in symbol data list (price: %s, "
+                "change: %s, changePercent: %s%%)",
+                this->symbolId(slot), priceStr, changeStr, changePercentStr);
+#endif
+      return;
+    }
+    LOG_WARN("Symbol %s not found in symbol data list", id);
+  }
+
+  /**
+   * @brief Called by the snapshot parser for every symbol in the response.
+   *
+   * @param context The StockTicker the parser belongs to.
+   * @param id The symbol of the stock.
+   * @param openPrice The start of day price.
+   * @param closePrice The end of day / current price.
+   */
+  void StockTicker::onSnapshot(void* context, const char* id,
+                               int64_t openPrice, int64_t closePrice) {
+    StockTicker* stockTicker = static_cast<StockTicker*>(context);
+    const int16_t slot = stockTicker->symbolIndex.find(id);
+    if (slot >= 0) {
+      stockTicker->symbolReferencePrices[slot] = openPrice;
+    }
+    const int64_t change = closePrice - openPrice;
+    stockTicker->updateSymbolPriceInMemory(
+      id, closePrice, change, fixedPointPercent(change, openPrice));
+  }
+
+  /**
+   * @brief Called by the latest trades parser for every symbol in the
+   *  response. The change is relative to the reference price from the last
+   *  snapshot.
+   *
+   * @param context The StockTicker the parser belongs to.
+   * @param id The symbol of the stock.
+   * @param price The price of the latest trade.
+   */
+  void StockTicker::onLatestTrade(void* context, const char* id,
+                                  int64_t price) {
+    StockTicker* stockTicker = static_cast<StockTicker*>(context);
+    const int16_t slot = stockTicker->symbolIndex.find(id);
+    // No reference if the symbol was missing from the snapshot
+    const int64_t referencePrice =
+      slot >= 0 ? stockTicker->symbolReferencePrices[slot] : 0;
+    const int64_t change = referencePrice > 0 ? price - referencePrice : 0;
+    stockTicker->updateSymbolPriceInMemory(
+      id, price, change, fixedPointPercent(change, referencePrice));
+  }
+
+  /**
+   * @brief Called by the bars parser for every bar in the response, oldest
+   *  first. The first bar of a symbol replaces what its sparkline had.
+   *
+   * @param context The StockTicker the parser belongs to.
+   * @param id The symbol of the stock.
+   * @param closePrice The close price of the bar.
+   */
+  void StockTicker::onBar(void* context, const char* id, int64_t closePrice) {
+    StockTicker* stockTicker = static_cast<StockTicker*>(context);
+    const int16_t slot = stockTicker->symbolIndex.find(id);
+    if (slot < 0) {
+      return;
+    }
+    if (!stockTicker->symbolHasBars[slot]) {
+      stockTicker->symbolHasBars[slot] = true;
+      stockTicker->sparklines[slot].clear();
+    }
+    const int64_t referencePrice = stockTicker->symbolReferencePrices[slot];
+    const int64_t change = referencePrice > 0 ? closePrice - referencePrice : 0;
+    stockTicker->sparklines[slot].push(
+      sparklineSample(fixedPointPercent(change, referencePrice)));
+  }
+
+  /**
+   * @brief After a batch of bars, put the latest price back on the end of
+   *  the sparklines that got bars, so they keep following it.
+   */
+  void StockTicker::finishBars() {
+    if (this->barsParser.hasNextPage()) {
+      LOG_WARN("More bars than fit in one response, some sparklines "
+               "are incomplete");
+    }
+    const uint32_t now = millis();
+    for (uint16_t i = this->batchStarts[this->currentBatch];
+         i < this->batchStarts[this->currentBatch + 1]; i++) {
+      if (this->symbolHasBars[i] && this->symbolPrices[i] > 0) {
+        this->sparklines[i].update(
+          sparklineSample(this->symbolChangePercents[i]), now);
+      }
+    }
+  }
+
+  /**
+   * @brief Do the next step of the stream connection: connect, authenticate,
+   *  subscribe, then handle trades as they arrive. Reconnects with backoff if
+   *  anything fails.
+   */
+  void StockTicker::pollStream() {
+    switch (this->streamState) {
+      case StreamState::WAITING_TO_RECONNECT:
+        if (millis() - this->streamStateTime < this->streamReconnectDelay) {
+          return;
+        }
+        // Fallthrough
+      case StreamState::DISCONNECTED:
+        if (WiFi.status() != WL_CONNECTED) {
+          LOG_WARN("No WiFi connection, cannot connect to stream.");
+          this->status = StockTickerStatus::ERROR_NO_WIFI;
+          this->reconnectStream(WEBSOCKET_ERROR_CONNECTION_FAILED);
+          return;
+        }
+        LOG_INFO("Connecting to stream at %s", this->streamHost);
+        this->retryPolicy.onAttempt();
+        this->streamClient.connect();
+        this->setStreamState(StreamState::CONNECTING);
+        return; // Connecting blocks, so leave it for the next update()
+      default:
+        break;
+    }
+
+    // Messages are handled by the callbacks during poll()
+    const WebSocketState state = this->streamClient.poll();
+    if (this->pricesChanged) {
+      this->publishPrices();
+    }
+    if (this->streamState == StreamState::WAITING_TO_RECONNECT) {
+      return; // The server sent an error
+    }
+    if (state == WebSocketState::ERROR || state == WebSocketState::CLOSED) {
+      LOG_WARN("Stream connection failed: %d", this->streamClient.getError());
+      this->status = StockTickerStatus::ERROR_CONNECTION_FAILED;
+      this->reconnectStream(this->streamClient.getError());
+      return;
+    }
+    if (this->streamState != StreamState::STREAMING &&
+        millis() - this->streamStateTime > STREAM_SETUP_TIMEOUT) {
+      LOG_WARN("Stream setup timed out");
+      this->status = StockTickerStatus::ERROR_CONNECTION_FAILED;
+      this->reconnectStream(WEBSOCKET_ERROR_TIMEOUT);
+    }
+  }
+
+  /**
+   * @brief Close the stream and connect again after a delay from the retry
+   *  policy. Subscriptions don't survive a reconnect, so they are sent again.
+   *
+   * @param error A negative WEBSOCKET_ERROR_* value, or the code of an error
+   *  message from the server.
+   */
+  void StockTicker::reconnectStream(int32_t error) {
+    this->countStatus();
+    this->streamClient.close();
+    const HttpRateLimitInfo noRateLimitInfo = {-1, -1, 0, 0};
+    this->streamReconnectDelay =
+      this->retryPolicy.onResult(error, noRateLimitInfo, 0);
+    LOG_INFO("Reconnecting to stream in %lu seconds",
+             static_cast<unsigned long>(this->streamReconnectDelay / 1000));
+    this->setStreamState(StreamState::WAITING_TO_RECONNECT);
+  }
+
+  void StockTicker::sendStreamAuth() {
+    char message[MAX_STREAM_MESSAGE_LEN];
+    snprintf(message, MAX_STREAM_MESSAGE_LEN,
+             "{\"action\":\"auth\",\"key\":\"%s\",\"secret\":\"%s\"}",
+             this->apcaApiKeyId, this->apcaApiSecretKey);
+    this->streamClient.sendText(message);
+    this->setStreamState(StreamState::AUTHENTICATING);
+  }
+
+  void StockTicker::sendStreamSubscribe() {
+    // One message per batch of symbols keeps the buffer small, ex.
+    // {"action":"subscribe","trades":["AAPL","MSFT"]}
+    const size_t size = MAX_STREAM_MESSAGE_LEN;
+    char message[size];
+    for (uint8_t batch = 0; batch < this->batchCount; batch++) {
+      const uint16_t first = this->batchStarts[batch];
+      size_t len = appendText(message, size, 0,
+                              "{\"action\":\"subscribe\",\"trades\":[");
+      for (uint16_t i = first; i < this->batchStarts[batch + 1]; i++) {
+        len = appendText(message, size, len, i > first ? ",\"" : "\"");
+        len = appendText(message, size, len, this->symbolId(i));
+        len = appendText(message, size, len, "\"");
+      }
+      appendText(message, size, len, "]}");
+      this->streamClient.sendText(message);
+    }
+    this->setStreamState(StreamState::SUBSCRIBING);
+  }
+
+  /**
+   * @brief Called by the stream client with each piece of a message.
+   *
+   * @param context The StockTicker the client belongs to.
+   * @param data The next piece of the message.
+   * @param len The length of data.
+   * @param first True for the first piece of a message.
+   * @param last True for the last piece of a message.
+   */
+  void StockTicker::onStreamMessage(void* context, const char* data,
+                                    size_t len, bool first, bool last) {
+    StockTicker* stockTicker = static_cast<StockTicker*>(context);
+    if (first) {
+      stockTicker->streamParser.reset();
+    }
+#ifdef LOG_JSON_PARSED
+    Serial1.write(data, len);
+    if (last) {
+      Serial1.println("");
+    }
+#endif
+    const JsonStreamStatus result = stockTicker->streamParser.feed(data, len);
+    if (last && result != JsonStreamStatus::DONE) {
+      LOG_WARN("Failed to parse stream message: %d", static_cast<int>(result));
+    }
+  }
+
+  /**
+   * @brief Called by the stream parser for every trade. The change is
+   *  relative to the reference price from the snapshot.
+   *
+   * @param context The StockTicker the parser belongs to.
+   * @param id The symbol of the stock.
+   * @param price The price of the trade.
+   */
+  void StockTicker::onStreamTrade(void* context, const char* id,
+                                  int64_t price) {
+    StockTicker::onLatestTrade(context, id, price);
+  }
+
+  /**
+   * @brief Called by the stream parser for every control message, to move
+   *  through authenticating and subscribing.
+   *
+   * @param context The StockTicker the parser belongs to.
+   * @param type The type of the message.
+   * @param msg The message.
+   * @param code The error code, if an error.
+   */
+  void StockTicker::onStreamControl(void* context, const char* type,
+                                    const char* msg, int32_t code) {
+    StockTicker* stockTicker = static_cast<StockTicker*>(context);
+    if (strcmp(type, "success") == 0) {
+      if (strcmp(msg, "connected") == 0) {
+        LOG_INFO("Connected to stream, authenticating");
+        stockTicker->sendStreamAuth();
+      } else if (strcmp(msg, "authenticated") == 0) {
+        LOG_INFO("Authenticated to stream, subscribing");
+        stockTicker->sendStreamSubscribe();
+      }
+    } else if (strcmp(type, "subscription") == 0) {
+      LOG_INFO("Subscribed to trades");
+      const HttpRateLimitInfo noRateLimitInfo = {-1, -1, 0, 0};
+      stockTicker->retryPolicy.onResult(200, noRateLimitInfo, 0);
+      stockTicker->setStreamState(StreamState::STREAMING);
+      stockTicker->status = StockTickerStatus::OK;
+    } else if (strcmp(type, "error") == 0) {
+      LOG_ERROR("Stream error %d: %s", code, msg);
+      switch (code) {
+        case 401: // Not authenticated
+          // Fallthrough
+        case 402: // Auth failed
+          // Fallthrough
+        case 409: // Insufficient subscription
+          stockTicker->status = StockTickerStatus::ERROR_FORBIDDEN;
+          break;
+        case 405: // Symbol limit exceeded
+          // Fallthrough
+        case 406: // Connection limit exceeded
+          // Fallthrough
+        case 429:
+          stockTicker->status = StockTickerStatus::ERROR_TOO_MANY_REQUESTS;
+          break;
+        case 500:
+          stockTicker->status = StockTickerStatus::ERROR_INTERNAL_SERVER_ERROR;
+          break;
+        default:
+          stockTicker->status = StockTickerStatus::ERROR_UNKNOWN;
+          break;
+      }
+      stockTicker->reconnectStream(code);
+    }
+  }
+
+  /**
+   * @brief Publish the prices in memory for updateDisplay(), if any of them
+   *  or their sparklines changed since the last time.
+   */
+  void StockTicker::publishPrices() {
+    bool sparklinesChanged = false;
+    for (uint16_t i = 0; i < this->symbolCount && !sparklinesChanged; i++) {
+      sparklinesChanged = this->sparklines[i].isDirty();
+    }
+    if (!this->pricesChanged && !sparklinesChanged) {
+      Telemetry::metrics.add(Telemetry::MetricCounter::PUBLISHES_SKIPPED);
+      return;
+    }
+    this->pricesChanged = false;
+    PriceValues* values = this->priceTable.beginWrite();
+    for (uint16_t i = 0; i < this->symbolCount; i++) {
+      values[i].price = this->symbolPrices[i];
+      values[i].change = this->symbolChanges[i];
+      values[i].changePercent = this->symbolChangePercents[i];
+    }
+    // Only the sparklines that changed are drawn again, the rest are still
+    // in the table from before
+    SparklineColumns* columns = this->priceTable.writeSparklines();
+    for (uint16_t i = 0; i < this->symbolCount; i++) {
+      if (this->sparklines[i].isDirty()) {
+        this->sparklines[i].render(columns[i]);
+      }
+    }
+    this->priceTable.endWrite();
+    this->pricesToSave = true;
+  }
+
+  /**
+   * @brief Load the prices saved by savePricesIfDue() straight into
+   *  displayedPrices, marked as cached. Only call this from begin().
+   */
+  void StockTicker::loadCachedPrices() {
+    const uint32_t startTime = millis();
+    uint16_t loaded = 0;
+    if (this->priceCache.beginRead()) {
+      char id[MAX_ID_LEN];
+      PriceValues values;
+      while (this->priceCache.readRecord(id, values)) {
+        // The symbols may have changed since it was saved
+        const int16_t slot = this->symbolIndex.find(id);
+        if (slot >= 0 && values.price > 0 && !this->symbolCached[slot]) {
+          this->displayedPrices[slot] = values;
+          this->symbolCached[slot] = true;
+          loaded++;
+        }
+      }
+    }
+    this->priceCache.endRead();
+    this->cachedSymbolCount = loaded;
+    LOG_INFO("Loaded %d cached prices in %lu ms", loaded, millis() - startTime);
+  }
+
+  /**
+   * @brief Save the fetched prices to flash if they changed and it has been
+   *  at least PRICE_CACHE_SAVE_PERIOD since the last save, to limit wear.
+   *  Symbols without fetched prices yet aren't saved.
+   */
+  void StockTicker::savePricesIfDue() {
+    if (!this->pricesToSave ||
+        (this->hasSavedPrices &&
+         millis() - this->lastPriceSaveTime < PRICE_CACHE_SAVE_PERIOD)) {
+      return;
+    }
+    const uint32_t startTime = millis();
+    this->pricesToSave = false;
+    this->hasSavedPrices = true;
+    this->lastPriceSaveTime = startTime;
+    if (!this->priceCache.beginWrite()) {
+      this->priceCache.endWrite();
+      return;
+    }
+    for (uint16_t i = 0; i < this->symbolCount; i++) {
+      if (this->symbolPrices[i] > 0) {
+        this->priceCache.writeRecord(
+          this->symbolId(i),
+          {this->symbolPrices[i], this->symbolChanges[i],
+           this->symbolChangePercents[i]});
+      }
     }
-    Serial1.printf("Symbol %s not found in symbol data list\n", id);
+    const bool saved = this->priceCache.endWrite();
+    LOG_INFO("%s prices to flash in %lu ms",
+             saved ? "Saved" : "Failed to save", millis() - startTime);
   }
 
   /**
-   * @brief Updates the stock string to display.
+   * @brief Lay out the whole display string from displayedPrices.
+   */
+  void StockTicker::rebuildDisplayStr() {
+    this->displayStrLen = 0;
+    for (uint16_t i = 0; i < this->symbolCount; i++) {
+      DisplaySegment& segment = this->displaySegments[i];
+      segment.offset = this->displayStrLen;
+      segment.length =
+        this->formatSegment(i, this->displayStr + this->displayStrLen,
+                            this->displayStrSize - this->displayStrLen);
+      this->displayStrLen += segment.length;
+    }
+    this->displayStr[this->displayStrLen] = '\0';
+  }
+
+  /**
+   * @brief Updates the stock string to display from the last prices handed
+   *  off to updateDisplay(). Only the segments of symbols whose prices
+   *  changed are rewritten.
    */
   void StockTicker::updateDisplayStr() {
-    memset(displayStr, 0, MAX_DISPLAY_STR_LEN);
-    char* ptr = displayStr;
+    const uint32_t startTime = micros();
+    uint32_t bytesRewritten = 0;
+    char segmentStr[MAX_SYMBOL_DISPLAY_STR_LEN];
+    // Drawn straight from here by sparklineColumn(), the text doesn't change
+    memcpy(this->displayedSparklines, this->incomingSparklines,
+           this->symbolCount * sizeof(SparklineColumns));
     for (uint16_t i = 0; i < this->symbolCount; i++) {
-      size_t charsWritten = 0;
-      if (allSymbolPrices[i].price > 0) {
-        char sign = '+';
-        if (allSymbolPrices[i].change < 0) {
-          sign = '-';
+      if (this->symbolCached[i]) {
+        if (this->incomingPrices[i].price <= 0) {
+          continue; // Keep showing the cached price until one is fetched
         }
-        charsWritten =
-          snprintf(ptr, MAX_SYMBOL_DISPLAY_STR_LEN,
-                   "%s: $%.2f %+.2f%% (%c$%.2f)    ", allSymbolPrices[i].id,
-                   allSymbolPrices[i].price, allSymbolPrices[i].changePercent,
-                   sign, abs(allSymbolPrices[i].change));
+        // Fetched, so re-render even if the price is the same
+        this->symbolCached[i] = false;
+        this->cachedSymbolCount--;
+      } else if (memcmp(&this->incomingPrices[i], &this->displayedPrices[i],
+                        sizeof(PriceValues)) == 0) {
+        continue; // Unchanged
+      }
+      this->displayedPrices[i] = this->incomingPrices[i];
+      const size_t len =
+        this->formatSegment(i, segmentStr, MAX_SYMBOL_DISPLAY_STR_LEN);
+      const DisplaySegment& segment = this->displaySegments[i];
+      // Text after the segment only moves if the length changed
+      bytesRewritten += len;
+      if (len != segment.length) {
+        bytesRewritten +=
+          this->displayStrLen - (segment.offset + segment.length);
+      }
+      this->replaceSegment(i, segmentStr, len);
+    }
+    this->lastRenderBytes = bytesRewritten;
+    this->lastRenderTime = micros() - startTime;
+    Telemetry::metrics.add(Telemetry::MetricCounter::RENDERS);
+    Telemetry::metrics.record(Telemetry::MetricTiming::RENDER,
+                              this->lastRenderTime);
+    // Only the start of the string fits in a log record
+    LOG_DEBUG("Display string updated, %lu bytes rewritten in %lu us: %s",
+              static_cast<unsigned long>(this->lastRenderBytes),
+              static_cast<unsigned long>(this->lastRenderTime), displayStr);
+  }
+
+  /**
+   * @brief Format one symbol's segment of the display string.
+   *
+   * @param i The index of the symbol.
+   * @param buf Where to write the segment, always null terminated.
+   * @param len The size of buf.
+   * @return The length of the segment, never more than len - 1.
+   */
+  size_t StockTicker::formatSegment(uint16_t i, char* buf, size_t len) const {
+    if (len == 0) {
+      return 0;
+    }
+    len = min(len, MAX_SYMBOL_DISPLAY_STR_LEN);
+    const PriceValues& values = this->displayedPrices[i];
+    // Same as "%s: $%.2f %+.2f%% (%c$%.2f) \x01    " but without floats or
+    // printf, the \x01 is where the sparkline is drawn
+    size_t pos = appendText(buf, len, 0, this->symbolId(i));
+    if (values.price > 0) {
+      pos = appendText(buf, len, pos, ": $");
+      pos += formatFixedPoint(values.price, 2, false, buf + pos, len - pos);
+      pos = appendText(buf, len, pos, " ");
+      pos += formatFixedPoint(values.changePercent, 2, true, buf + pos,
+                              len - pos);
+      pos = appendText(buf, len, pos, values.change < 0 ? "% (-$" : "% (+$");
+      const int64_t absChange =
+        values.change < 0 ? -values.change : values.change;
+      pos += formatFixedPoint(absChange, 2, false, buf + pos, len - pos);
+      // No sparkline for cached prices, the samples aren't saved
+      pos = appendText(buf, len, pos, this->symbolCached[i] ? ") (cached)    "
+                                                            : ") \x01    ");
+    } else {
+      // No data yet cause price is negative
+      pos = appendText(buf, len, pos, ": No data yet...    ");
+    }
+    return pos;
+  }
+
+  /**
+   * @brief Replace one symbol's segment of the display string, moving the
+   *  segments after it if the length changed.
+   *
+   * @param i The index of the symbol.
+   * @param text The new text of the segment.
+   * @param len The length of text.
+   */
+  void StockTicker::replaceSegment(uint16_t i, const char* text, size_t len) {
+    DisplaySegment& segment = this->displaySegments[i];
+    const size_t tailStart = segment.offset + segment.length;
+    const size_t tailLen = this->displayStrLen - tailStart;
+    // Keep room for the null terminator
+    const size_t maxLen =
+      this->displayStrSize - 1 - segment.offset - tailLen;
+    len = min(len, maxLen);
+    if (len != segment.length) {
+      memmove(this->displayStr + segment.offset + len,
+              this->displayStr + tailStart, tailLen + 1);
+      const int16_t delta = len - segment.length;
+      for (uint16_t j = i + 1; j < this->symbolCount; j++) {
+        this->displaySegments[j].offset += delta;
+      }
+      this->displayStrLen += delta;
+      segment.length = len;
+    }
+    memcpy(this->displayStr + segment.offset, text, len);
+  }
+
+  /**
+   * @brief Draw a column of the sparkline at a marker in the display string,
+   *  for MD_MAX72XX_Scrolling::setColumnProvider(). Only call this from the
+   *  core that calls updateDisplay().
+   *
+   * @param context The StockTicker.
+   * @param textIndex Where the marker is in the display string.
+   * @param column The column of the sparkline, 0 is the oldest.
+   * @return uint8_t The pixels of the column, bit 0 is the top row.
+   */
+  uint8_t StockTicker::sparklineColumn(void* context, size_t textIndex,
+                                       uint8_t column) {
+    const StockTicker* stockTicker = static_cast<StockTicker*>(context);
+    if (column >= SPARKLINE_WIDTH || stockTicker->symbolCount == 0) {
+      return 0;
+    }
+    // Find the last segment starting at or before the marker
+    uint16_t low = 0;
+    uint16_t high = stockTicker->symbolCount - 1;
+    while (low < high) {
+      const uint16_t mid = (low + high + 1) / 2;
+      if (stockTicker->displaySegments[mid].offset <= textIndex) {
+        low = mid;
       } else {
-        // No data yet cause price is negative
-        charsWritten =
-          snprintf(ptr, MAX_SYMBOL_DISPLAY_STR_LEN, "%s: No data yet...    ",
-                   allSymbolPrices[i].id);
+        high = mid - 1;
       }
-      ptr += charsWritten;
     }
-    Serial1.println("Display string updated:");
-    Serial1.println(displayStr);
+    return stockTicker->displayedSparklines[low].columns[column];
   }
 } // StockTicker
@@ -5,35 +5,75 @@
 #ifndef PICO2W_STOCK_TICKER_STOCKTICKER_H
 #define PICO2W_STOCK_TICKER_STOCKTICKER_H
 
-#ifndef LOG_FREE_MEMORY
-// #define LOG_FREE_MEMORY
-#endif
 #ifndef LOG_JSON_PARSED
 // #define LOG_JSON_PARSED
 #endif
-#ifndef BUFFER_JSON_READING
-  #define BUFFER_JSON_READING
-#endif
 
 #include <Arduino.h>
-#include <ArduinoJson.h>
-#include <HTTPClient.h>
-#include <StreamUtils.h>
+#include <BarsParser.h>
+#include <BlockCarver.h>
+#include <FixedPoint.h>
+#include <GzipInflater.h>
+#include <HttpKeepAliveClient.h>
+#include <LatestTradesParser.h>
+#include <Log.h>
+#include <Metrics.h>
+#include <PriceCache.h>
+#include <PriceTable.h>
+#include <RetryPolicy.h>
+#include <SnapshotParser.h>
+#include <Sparkline.h>
+#include <SymbolIndex.h>
+#include <SystemStats.h>
+#include <TickerLimits.h>
+#include <TradeStreamParser.h>
+#include <WebSocketClient.h>
 #include <WiFi.h>
 
 namespace StockTicker {
-  const size_t MAX_ID_LEN = 32;
-  const size_t MAX_SYMBOLS_STRING_LEN = 256;
-  const uint16_t MAX_SYMBOLS = 64;
   const size_t MAX_SYMBOL_DISPLAY_STR_LEN = 64;
-  const size_t MAX_DISPLAY_STR_LEN = MAX_SYMBOLS * MAX_SYMBOL_DISPLAY_STR_LEN;
+  // Symbols are requested in batches of at most this many characters (ids
+  // and commas), so each URL fits in the request
+  const size_t MAX_BATCH_SYMBOLS_LEN = 256;
+  const size_t MAX_URL_LEN = 96 + MAX_BATCH_SYMBOLS_LEN;
+  // Every batch but the last is longer than MAX_BATCH_SYMBOLS_LEN - MAX_ID_LEN
+  const uint8_t MAX_REQUEST_BATCHES =
+    MAX_SYMBOLS_STRING_LEN / (MAX_BATCH_SYMBOLS_LEN - MAX_ID_LEN) + 1;
+  const char* const ALPACA_DATA_HOST = "data.alpaca.markets";
+  const char* const ALPACA_STREAM_HOST = "stream.data.alpaca.markets";
+  const size_t MAX_STREAM_PATH_LEN = 32;
+  // Big enough to subscribe to a batch of symbols at once
+  const size_t MAX_STREAM_MESSAGE_LEN = 64 + 2 * MAX_BATCH_SYMBOLS_LEN;
+  // How long authenticating and subscribing can take, in milliseconds
+  const uint32_t STREAM_SETUP_TIMEOUT = 10000;
+  // Bounds the time spent in each StockTicker::update() while parsing
+  const size_t MAX_BYTES_PARSED_PER_UPDATE = 256;
+  // 32 bit FNV-1a, to spot responses that didn't change
+  const uint32_t FNV_OFFSET_BASIS = 2166136261;
+  const uint32_t FNV_PRIME = 16777619;
+  // How long reference prices are kept in DataSource::LATEST_TRADES mode
+  // before they are fetched again, in milliseconds
+  const uint32_t REFERENCE_PRICE_MAX_AGE = 60 * 60 * 1000;
+  // Least time between saves of the prices to flash, in milliseconds
+  const uint32_t PRICE_CACHE_SAVE_PERIOD = 10 * 60 * 1000;
+  // Most bars asked for in one request, the most the API allows
+  const uint16_t MAX_BARS_PER_REQUEST = 10000;
+
+  // Where each symbol's text is in the display string
+  // clang-format off
+  struct DisplaySegment {
+    uint16_t offset;
+    uint16_t length;
+  };
+  // clang-format on
 
+  // What a symbol had before the batch it's in was parsed, to undo a
+  // rejected one
   // clang-format off
-  struct SymbolPrice {
-    char id[MAX_ID_LEN];
-    float price;
-    float change;
-    float changePercent;
+  struct SymbolCheckpoint {
+    int64_t referencePrice;
+    SparklineBuffer sparkline;
+    bool hasBars;
   };
   // clang-format on
 
@@ -54,8 +94,65 @@ namespace StockTicker {
     ERROR_INTERNAL_SERVER_ERROR,
     ERROR_UNKNOWN
   };
+  const uint8_t STATUS_COUNT =
+    static_cast<uint8_t>(StockTickerStatus::ERROR_UNKNOWN) + 1;
+
+  /**
+   * @brief Which Market Data API endpoint prices are fetched from.
+   */
+  enum class DataSource : uint8_t {
+    // Full snapshots every time, /v2/stocks/snapshots
+    SNAPSHOTS,
+    // Only the latest trade, /v2/stocks/trades/latest, compared to reference
+    // prices from a snapshot fetched every REFERENCE_PRICE_MAX_AGE
+    LATEST_TRADES,
+    // Trades pushed over a WebSocket as they happen, compared to reference
+    // prices from a snapshot fetched once when starting
+    STREAM
+  };
+
+  /**
+   * @brief Which endpoint a request is for.
+   */
+  enum class RequestEndpoint : uint8_t {
+    // /v2/stocks/snapshots
+    SNAPSHOTS,
+    // /v2/stocks/trades/latest
+    LATEST_TRADES,
+    // /v2/stocks/bars, once at startup for the sparklines
+    BARS
+  };
+  const uint8_t REQUEST_ENDPOINT_COUNT = 3;
+
+  /**
+   * @brief Steps of the connection to the real-time stream in
+   *  DataSource::STREAM mode, see StockTicker::pollStream().
+   */
+  enum class StreamState : uint8_t {
+    DISCONNECTED,
+    CONNECTING,
+    AUTHENTICATING,
+    SUBSCRIBING,
+    STREAMING,
+    WAITING_TO_RECONNECT
+  };
+
+  /**
+   * @brief Steps of fetching prices, see StockTicker::update().
+   */
+  enum class FetchState : uint8_t {
+    IDLE,
+    REQUESTING,
+    PARSING,
+    // The JSON of a gzip body is parsed, reading the rest of it so the
+    // trailer is checked
+    VERIFYING,
+    LOGGING_ERROR_BODY,
+    FINISHING
+  };
 
   uint16_t stockSymbolsCount(const char* symbolsString);
+  bool dataSourceFromString(const char* name, DataSource& dataSource);
 
   /**
    * @brief StockTicker class to fetch and display stock prices from Alpaca
@@ -64,19 +161,22 @@ namespace StockTicker {
   class StockTicker {
     public:
       StockTicker() = default;
-      ~StockTicker() = default;
+      ~StockTicker() {
+        free(this->symbolStorage);
+      }
+      // Owns the symbol storage
+      StockTicker(const StockTicker&) = delete;
+      StockTicker& operator=(const StockTicker&) = delete;
 
       void begin(const char* apiKeyId, const char* apiSecretKey,
                  const char* symbolsString, const char* feed = "iex",
-                 uint32_t request = 60 * 1000);
-      /**
-       * @brief Deinitialize.
-       */
-      void end() {
-        // Nothing to do here, no dynamic memory allocation
-      };
+                 uint32_t request = 60 * 1000,
+                 DataSource source = DataSource::SNAPSHOTS);
+      void end();
 
       void update();
+      void cancel();
+      bool updateDisplay();
 
       /**
        * @brief Get a pointer to the string to display.
@@ -84,7 +184,17 @@ namespace StockTicker {
        * @return const char*
        */
       const char* getDisplayStr() const {
-        return this->displayStr;
+        return this->displayStr != nullptr ? this->displayStr : "";
+      }
+
+      /**
+       * @brief Get the length of the string to display, kept up to date as it
+       *  is rewritten so it doesn't have to be measured.
+       *
+       * @return size_t
+       */
+      size_t getDisplayStrLen() const {
+        return this->displayStrLen;
       }
 
       /**
@@ -96,34 +206,282 @@ namespace StockTicker {
         return this->status;
       }
 
+      /**
+       * @brief Get how many bytes of the display string the last
+       *  updateDisplay() rewrote.
+       *
+       * @return uint32_t
+       */
+      uint32_t getLastRenderBytes() const {
+        return this->lastRenderBytes;
+      }
+
+      /**
+       * @brief Get how long the last updateDisplay() took to render, in
+       *  microseconds.
+       *
+       * @return uint32_t
+       */
+      uint32_t getLastRenderTime() const {
+        return this->lastRenderTime;
+      }
+
+      /**
+       * @brief Check if any symbol still shows a price loaded from flash at
+       *  begin() instead of a fetched one. Only call this from the core that
+       *  calls updateDisplay().
+       *
+       * @return true if some prices are cached.
+       */
+      bool hasCachedPrices() const {
+        return this->cachedSymbolCount > 0;
+      }
+
+      /**
+       * @brief Get the table used to hand prices from update() to
+       *  updateDisplay(), for its counters.
+       *
+       * @return const PriceTable&
+       */
+      const PriceTable& getPriceTable() const {
+        return this->priceTable;
+      }
+
+      /**
+       * @brief Use a different server for the REST endpoints, ex. a local
+       *  stand-in that serves recorded responses. Call before begin().
+       *
+       * @param host The host, must stay valid while the StockTicker is used.
+       * @param port The port.
+       */
+      void setDataServer(const char* host, uint16_t port) {
+        this->dataHost = host;
+        this->dataPort = port;
+      }
+
+      /**
+       * @brief Use a different server for DataSource::STREAM, ex. a local
+       *  stand-in that replays recorded messages. Call before begin().
+       *
+       * @param host The host, must stay valid while the StockTicker is used.
+       * @param port The port.
+       */
+      void setStreamServer(const char* host, uint16_t port) {
+        this->streamHost = host;
+        this->streamPort = port;
+      }
+
+      /**
+       * @brief Fetch and stream over other connections instead of the built
+       *  in WiFiClientSecure ones, ex. scripted ones in host tests. Call
+       *  before begin().
+       *
+       * @param dataClient The connection for the REST endpoints.
+       * @param streamClient The connection for DataSource::STREAM.
+       */
+      void setClients(Client* dataClient, Client* streamClient) {
+        this->httpClient.setClient(dataClient);
+        this->streamClient.setClient(streamClient);
+      }
+
       /**
        * @brief Signal an immediate refresh of the stock prices on the next
        *  StockTicker::StockTicker.update();
        */
       void refreshOnNextUpdate() {
-        this->nextRequestTime = 0; // Force immediate refresh
+        this->nextRequestTime = millis(); // Force immediate refresh
       }
 
+      static uint8_t sparklineColumn(void* context, size_t textIndex,
+                                     uint8_t column);
+
+      void printMetrics(Print& out) const;
+
     protected:
       const char* apcaApiKeyId;
       const char* apcaApiSecretKey;
 
       const char* symbols;
-      SymbolPrice allSymbolPrices[MAX_SYMBOLS];
       uint16_t symbolCount = 0;
+      // Every array below with an entry per symbol is carved from this one
+      // block, allocated by begin() for the symbols configured instead of
+      // for MAX_SYMBOLS. See carveSymbolStorage().
+      uint8_t* symbolStorage = nullptr;
+      uint16_t symbolCapacity = 0;
+      size_t symbolIdPoolSize = 0;
+      // Null terminated ids packed back to back, never longer than the
+      // symbols string they come from
+      char* symbolIdPool = nullptr;
+      uint16_t* symbolIdOffsets = nullptr;
+      SymbolIndex symbolIndex;
+      // Only touched by update(), in 1/FIXED_POINT_SCALE units
+      int64_t* symbolPrices = nullptr;
+      int64_t* symbolChanges = nullptr;
+      int64_t* symbolChangePercents = nullptr;
+      // What the change is relative to, the start of day price
+      int64_t* symbolReferencePrices = nullptr;
+      // Recent changes, also only touched by update()
+      SparklineBuffer* sparklines = nullptr;
+      bool* symbolHasBars = nullptr;
+      // Only the entries of the batch being parsed are used
+      SymbolCheckpoint* symbolCheckpoints = nullptr;
+
+      void carveSymbolStorage(BlockCarver& storage);
+      void allocateSymbolStorage(uint16_t capacity, size_t poolSize);
+      void freeSymbolStorage();
+
+      /**
+       * @brief Get the id of a symbol.
+       *
+       * @param i The index of the symbol.
+       * @return const char*
+       */
+      const char* symbolId(uint16_t i) const {
+        return this->symbolIdPool + this->symbolIdOffsets[i];
+      }
+
+      void updateSymbolPriceInMemory(const char* id, int64_t price,
+                                     int64_t change, int64_t changePercent);
 
-      void updateSymbolPriceInMemory(const char* id, float price, float change,
-                                     float changePercent);
+      HttpKeepAliveClient httpClient;
+      GzipInflater inflater;
+      // The body of the current response, the HttpKeepAliveClient itself or
+      // the inflater if it's compressed
+      Stream* responseBody = &this->httpClient;
+      const char* dataHost = ALPACA_DATA_HOST;
+      uint16_t dataPort = 443;
+      SnapshotParser snapshotParser{StockTicker::onSnapshot, this};
+      LatestTradesParser latestTradesParser{StockTicker::onLatestTrade, this};
+      BarsParser barsParser{StockTicker::onBar, this};
+      JsonStreamTokenizer* activeParser = &this->snapshotParser;
+      DataSource dataSource = DataSource::SNAPSHOTS;
+      RequestEndpoint requestEndpoint = RequestEndpoint::SNAPSHOTS;
+      // Symbol index each batch starts at, the last entry is symbolCount
+      uint16_t batchStarts[MAX_REQUEST_BATCHES + 1];
+      uint8_t batchCount = 0;
+      // The batch whose response is being read
+      uint8_t currentBatch = 0;
+      uint8_t batchesRequested = 0;
+      bool hasReferencePrices = false;
+      uint32_t referencePriceTime = 0;
+      // The bars for the sparklines are fetched once, right after the first
+      // reference prices
+      bool needsBars = false;
+      // Set when updateSymbolPriceInMemory() changes a price, until
+      // publishPrices()
+      bool pricesChanged = false;
+
+      FetchState fetchState = FetchState::IDLE;
+      uint32_t fetchStartTime = 0;
+      // Longest time a single update() took during the last fetch, in us
+      uint32_t longestStepTime = 0;
+      // Size of the last response body and time spent parsing it, in us
+      uint32_t fetchBodyBytes = 0;
+      uint32_t fetchParseTime = 0;
+      // When the body of the current response started, and time spent
+      // parsing it so far, in us
+      uint32_t responseStartTime = 0;
+      uint32_t responseParseTime = 0;
+      // FNV-1a hash of the body of the current response, and of the last
+      // response to each request
+      uint32_t responseHash = 0;
+      uint32_t lastResponseHashes[REQUEST_ENDPOINT_COUNT][MAX_REQUEST_BATCHES];
+      // How many fetches ended with each StockTickerStatus
+      uint32_t statusCounts[STATUS_COUNT] = {};
+      // 200 once the fetch succeeded, otherwise why it failed
+      int32_t fetchStatusCode = 0;
+      RetryPolicy retryPolicy;
+
+      void formatRequestPath(RequestEndpoint endpoint, uint8_t batch,
+                             char* path) const;
+      bool setRequestPath(RequestEndpoint endpoint, uint8_t batch);
+      void queueNextBatch();
+
+      WebSocketClient streamClient;
+      TradeStreamParser streamParser{StockTicker::onStreamTrade,
+                                     StockTicker::onStreamControl, this};
+      const char* streamHost = ALPACA_STREAM_HOST;
+      uint16_t streamPort = 443;
+      StreamState streamState = StreamState::DISCONNECTED;
+      uint32_t streamStateTime = 0;
+      uint32_t streamReconnectDelay = 0;
+
+      void setStreamState(StreamState newState) {
+        this->streamState = newState;
+        this->streamStateTime = millis();
+      }
+
+      void pollStream();
+      void reconnectStream(int32_t error);
+      void sendStreamAuth();
+      void sendStreamSubscribe();
+      static void onStreamMessage(void* context, const char* data, size_t len,
+                                  bool first, bool last);
+      static void onStreamTrade(void* context, const char* id, int64_t price);
+      static void onStreamControl(void* context, const char* type,
+                                  const char* msg, int32_t code);
+
+      void startFetch();
+      void pollRequest();
+      void pollParse();
+      void pollVerify();
+      void checkpointBatch();
+      void finishBatch(bool valid);
+      void rollbackBatch();
+      void pollErrorBody();
+      void pollFinishResponse();
+      void finishFetch();
+      void scheduleNextRequest();
+      void setErrorStatus(int32_t statusCode);
+      void countStatus();
+      static void onSnapshot(void* context, const char* id,
+                             int64_t openPrice, int64_t closePrice);
+      static void onLatestTrade(void* context, const char* id, int64_t price);
+      static void onBar(void* context, const char* id, int64_t closePrice);
+      void finishBars();
 
       const char* sourceFeed;
       uint32_t requestPeriod;
       uint32_t nextRequestTime = 0;
 
-      StockTickerStatus status = StockTickerStatus::OK;
+      // Written by update() and read by the caller, maybe on another core
+      volatile StockTickerStatus status = StockTickerStatus::OK;
+      volatile bool cancelRequested = false;
+
+      // Prices go from the symbol columns (only touched by update()) through
+      // priceTable to displayedPrices (only touched by updateDisplay())
+      PriceTable priceTable;
+      PriceValues* displayedPrices = nullptr;
+      PriceValues* incomingPrices = nullptr;
+      SparklineColumns* displayedSparklines = nullptr;
+      SparklineColumns* incomingSparklines = nullptr;
+      void publishPrices();
+
+      // Last known prices, saved by update() and loaded by begin()
+      PriceCache priceCache;
+      bool pricesToSave = false;
+      bool hasSavedPrices = false;
+      uint32_t lastPriceSaveTime = 0;
+      // Which displayedPrices came from the cache, only touched by
+      // updateDisplay()
+      bool* symbolCached = nullptr;
+      uint16_t cachedSymbolCount = 0;
+
+      void loadCachedPrices();
+      void savePricesIfDue();
 
-      char displayStr[MAX_DISPLAY_STR_LEN];
+      // MAX_SYMBOL_DISPLAY_STR_LEN for each symbol, plus the terminator
+      char* displayStr = nullptr;
+      size_t displayStrSize = 0;
+      size_t displayStrLen = 0;
+      DisplaySegment* displaySegments = nullptr;
+      uint32_t lastRenderBytes = 0;
+      uint32_t lastRenderTime = 0;
 
+      void rebuildDisplayStr();
       void updateDisplayStr();
+      size_t formatSegment(uint16_t i, char* buf, size_t len) const;
+      void replaceSegment(uint16_t i, const char* text, size_t len);
   };
 } // StockTicker
 
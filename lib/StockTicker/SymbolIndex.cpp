@@ -0,0 +1,102 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <SymbolIndex.h>
+
+namespace StockTicker {
+  /**
+   * @brief Take the index's storage. The index is empty afterwards, unless
+   *  only measuring.
+   *
+   * @param storage Where to take the storage from.
+   * @param maxKeys The most keys that will be inserted.
+   */
+  void SymbolIndex::begin(BlockCarver& storage, uint16_t maxKeys) {
+    uint32_t tableSize = 2;
+    while (tableSize < 2u * maxKeys) {
+      tableSize *= 2;
+    }
+    this->tableMask = tableSize - 1;
+    this->table = storage.take<uint16_t>(tableSize);
+    this->tags = storage.take<uint8_t>(tableSize);
+    this->keys = storage.take<const char*>(maxKeys);
+    this->slots = storage.take<uint16_t>(maxKeys);
+    this->maxKeys = maxKeys;
+    this->keyCount = 0;
+  }
+
+  /**
+   * @brief Remove all keys.
+   */
+  void SymbolIndex::clear() {
+    if (this->table != nullptr) {
+      memset(this->table, 0, (this->tableMask + 1) * sizeof(uint16_t));
+    }
+    this->keyCount = 0;
+  }
+
+  /**
+   * @brief Add a key to the index.
+   *
+   * @param key The symbol, not copied so it must outlive the index.
+   * @param slot The slot the symbol is stored in.
+   * @return true if added, false if the key is already in the index or the
+   *  index is full.
+   */
+  bool SymbolIndex::insert(const char* key, uint16_t slot) {
+    if (this->keyCount >= this->maxKeys || this->find(key) >= 0) {
+      return false;
+    }
+    const uint32_t h = hash(key);
+    uint16_t i = h & this->tableMask;
+    while (this->table[i] != 0) {
+      i = (i + 1) & this->tableMask;
+    }
+    this->keys[this->keyCount] = key;
+    this->slots[this->keyCount] = slot;
+    this->keyCount++;
+    this->table[i] = this->keyCount;
+    this->tags[i] = h >> 24;
+    return true;
+  }
+
+  /**
+   * @brief Find the slot of a symbol.
+   *
+   * @param key The symbol to look for.
+   * @return The slot, or -1 if the symbol is not in the index.
+   */
+  int16_t SymbolIndex::find(const char* key) const {
+    if (this->keyCount == 0) {
+      return -1;
+    }
+    const uint32_t h = hash(key);
+    const uint8_t tag = h >> 24;
+    uint16_t i = h & this->tableMask;
+    // Never full since at most half of the table is used, so this ends
+    while (this->table[i] != 0) {
+      const uint16_t entry = this->table[i] - 1;
+      if (this->tags[i] == tag && strcmp(this->keys[entry], key) == 0) {
+        return this->slots[entry];
+      }
+      i = (i + 1) & this->tableMask;
+    }
+    return -1;
+  }
+
+  /**
+   * @brief 32-bit FNV-1a hash of a string.
+   *
+   * @param key The string to hash.
+   * @return uint32_t
+   */
+  uint32_t SymbolIndex::hash(const char* key) {
+    uint32_t h = 2166136261u;
+    while (*key != '\0') {
+      h ^= static_cast<uint8_t>(*key++);
+      h *= 16777619u;
+    }
+    return h;
+  }
+} // StockTicker
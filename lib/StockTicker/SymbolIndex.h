@@ -0,0 +1,51 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_SYMBOLINDEX_H
+#define PICO2W_STOCK_TICKER_SYMBOLINDEX_H
+
+#include <Arduino.h>
+#include <BlockCarver.h>
+#include <TickerLimits.h>
+
+namespace StockTicker {
+  static_assert(MAX_SYMBOLS < 32768, "Symbol index entries are 16 bits");
+
+  /**
+   * @brief Open-addressing hash table that maps symbols to their slot in
+   *  StockTicker's symbol columns.
+   *
+   * Built once in StockTicker::begin(), so a lookup only hashes the key and
+   * compares it to the (usually one) entry with the same hash, instead of
+   * comparing it to every slot. The table is at least twice the number of
+   * keys so probe sequences stay short.
+   */
+  class SymbolIndex {
+    public:
+      SymbolIndex() = default;
+      ~SymbolIndex() = default;
+
+      void begin(BlockCarver& storage, uint16_t maxKeys);
+      void clear();
+      bool insert(const char* key, uint16_t slot);
+      int16_t find(const char* key) const;
+
+      static uint32_t hash(const char* key);
+
+    protected:
+      // 0 is empty, otherwise index into keys + 1
+      uint16_t* table = nullptr;
+      // Top 8 bits of each entry's hash, to skip most string compares
+      uint8_t* tags = nullptr;
+      // The table size is a power of two, this is the size - 1
+      uint16_t tableMask = 0;
+      // Not copied, must stay valid as long as the index is used
+      const char** keys = nullptr;
+      uint16_t* slots = nullptr;
+      uint16_t maxKeys = 0;
+      uint16_t keyCount = 0;
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_SYMBOLINDEX_H
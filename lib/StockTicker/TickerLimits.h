@@ -0,0 +1,19 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_TICKERLIMITS_H
+#define PICO2W_STOCK_TICKER_TICKERLIMITS_H
+
+#include <Arduino.h>
+
+// Limits on the symbols configuration, shared by the StockTicker storage and
+// Settings::TickerSettings validation so the two can't disagree
+namespace StockTicker {
+  const size_t MAX_ID_LEN = 32;
+  // Longer than fits in one URL, see StockTicker::MAX_BATCH_SYMBOLS_LEN
+  const size_t MAX_SYMBOLS_STRING_LEN = 1536;
+  const uint16_t MAX_SYMBOLS = 256;
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_TICKERLIMITS_H
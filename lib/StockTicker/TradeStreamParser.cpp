@@ -0,0 +1,59 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <TradeStreamParser.h>
+
+namespace StockTicker {
+  void TradeStreamParser::onContainerStart(uint8_t depth, const char* key,
+                                           bool isArray) {
+    if (depth == 2 && !isArray) {
+      // Start of a message
+      this->type[0] = '\0';
+      this->symbol[0] = '\0';
+      this->msg[0] = '\0';
+      this->code = 0;
+      this->hasPrice = false;
+    }
+  }
+
+  void TradeStreamParser::onContainerEnd(uint8_t depth, bool isArray) {
+    if (depth != 2 || isArray) {
+      return;
+    }
+    if (strcmp(this->type, "t") == 0) {
+      if (this->symbol[0] != '\0' && this->hasPrice) {
+        this->tradeCallback(this->context, this->symbol, this->price);
+      }
+    } else if (this->type[0] != '\0') {
+      this->controlCallback(this->context, this->type, this->msg, this->code);
+    }
+  }
+
+  void TradeStreamParser::onValue(uint8_t depth, const char* key,
+                                  JsonValueType type, const char* text) {
+    if (depth != 2 || key == nullptr) {
+      return;
+    }
+    if (type == JsonValueType::STRING) {
+      if (strcmp(key, "T") == 0) {
+        strncpy(this->type, text, STREAM_MESSAGE_TYPE_MAX_LEN - 1);
+        this->type[STREAM_MESSAGE_TYPE_MAX_LEN - 1] = '\0';
+      } else if (strcmp(key, "S") == 0) {
+        // A cut off id could be another symbol's, so the trade is skipped
+        strncpy(this->symbol, text, JSON_TOKEN_MAX_LEN);
+        if (this->valueTruncated()) {
+          this->symbol[0] = '\0';
+        }
+      } else if (strcmp(key, "msg") == 0) {
+        strncpy(this->msg, text, JSON_TOKEN_MAX_LEN);
+      }
+    } else if (type == JsonValueType::NUMBER && !this->valueTruncated()) {
+      if (strcmp(key, "p") == 0) {
+        this->hasPrice = parseFixedPoint(text, this->price);
+      } else if (strcmp(key, "code") == 0) {
+        this->code = atoi(text);
+      }
+    }
+  }
+} // StockTicker
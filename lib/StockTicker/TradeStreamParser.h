@@ -0,0 +1,77 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_TRADESTREAMPARSER_H
+#define PICO2W_STOCK_TICKER_TRADESTREAMPARSER_H
+
+#include <Arduino.h>
+#include <FixedPoint.h>
+#include <JsonStreamTokenizer.h>
+
+namespace StockTicker {
+  const size_t STREAM_MESSAGE_TYPE_MAX_LEN = 16;
+
+  /**
+   * @brief Called for every trade message ("T": "t") in the stream.
+   *
+   * @param context The context pointer given to the parser.
+   * @param id The symbol of the stock. (S)
+   * @param price The price of the trade. (p) In 1/FIXED_POINT_SCALE units.
+   */
+  typedef void (*StreamTradeCallback)(void* context, const char* id,
+                                      int64_t price);
+
+  /**
+   * @brief Called for every control message in the stream, ex. "success",
+   *  "error" or "subscription".
+   *
+   * @param context The context pointer given to the parser.
+   * @param type The type of the message. (T)
+   * @param msg The message, or an empty string if there is none. (msg)
+   * @param code The error code, or 0 if there is none. (code)
+   */
+  typedef void (*StreamControlCallback)(void* context, const char* type,
+                                        const char* msg, int32_t code);
+
+  /**
+   * @brief Streaming parser for the messages of the real-time stock data
+   *  stream.
+   *
+   * Every WebSocket message is an array of objects, ex. [{"T": "t", "S":
+   * "AAPL", "p": 1.0, ...}, {"T": "success", "msg": "authenticated"}].
+   * reset() before each message.
+   */
+  class TradeStreamParser : public JsonStreamTokenizer {
+    public:
+      TradeStreamParser(StreamTradeCallback tradeCallback,
+                        StreamControlCallback controlCallback,
+                        void* context) {
+        this->tradeCallback = tradeCallback;
+        this->controlCallback = controlCallback;
+        this->context = context;
+      }
+      ~TradeStreamParser() override = default;
+
+    protected:
+      void onContainerStart(uint8_t depth, const char* key,
+                            bool isArray) override;
+      void onContainerEnd(uint8_t depth, bool isArray) override;
+      void onValue(uint8_t depth, const char* key, JsonValueType type,
+                   const char* text) override;
+
+    private:
+      StreamTradeCallback tradeCallback = nullptr;
+      StreamControlCallback controlCallback = nullptr;
+      void* context = nullptr;
+
+      char type[STREAM_MESSAGE_TYPE_MAX_LEN];
+      char symbol[JSON_TOKEN_MAX_LEN];
+      char msg[JSON_TOKEN_MAX_LEN];
+      int32_t code = 0;
+      bool hasPrice = false;
+      int64_t price = 0;
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_TRADESTREAMPARSER_H
@@ -0,0 +1,456 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <WebSocketClient.h>
+
+namespace StockTicker {
+  const uint8_t OPCODE_CONTINUATION = 0x0;
+  const uint8_t OPCODE_TEXT = 0x1;
+  const uint8_t OPCODE_BINARY = 0x2;
+  const uint8_t OPCODE_CLOSE = 0x8;
+  const uint8_t OPCODE_PING = 0x9;
+  const uint8_t OPCODE_PONG = 0xA;
+  // Base64 of a 16 byte nonce
+  const size_t WEBSOCKET_KEY_LEN = 24;
+
+  /**
+   * @brief Base64 encode the 16 bytes of a Sec-WebSocket-Key.
+   *
+   * @param src The 16 bytes to encode.
+   * @param dst Where to write the WEBSOCKET_KEY_LEN characters, not null
+   *  terminated.
+   */
+  static void encodeWebSocketKey(const uint8_t* src, char* dst) {
+    static const char alphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t j = 0;
+    for (size_t i = 0; i < 15; i += 3) {
+      const uint32_t n = (src[i] << 16) | (src[i + 1] << 8) | src[i + 2];
+      dst[j++] = alphabet[(n >> 18) & 0x3F];
+      dst[j++] = alphabet[(n >> 12) & 0x3F];
+      dst[j++] = alphabet[(n >> 6) & 0x3F];
+      dst[j++] = alphabet[n & 0x3F];
+    }
+    // One byte left over
+    dst[j++] = alphabet[src[15] >> 2];
+    dst[j++] = alphabet[(src[15] & 0x03) << 4];
+    dst[j++] = '=';
+    dst[j++] = '=';
+  }
+
+  /**
+   * @brief Initialize and build the opening handshake.
+   *
+   * @param host The host to connect to, must stay valid until the client is
+   *  no longer used.
+   * @param port The port to connect to, usually 443.
+   * @param path The path to request, ex. "/v2/iex".
+   * @param callback Called with the pieces of every received message.
+   * @param context Passed to callback.
+   * @return true if the handshake fit in WEBSOCKET_MAX_HANDSHAKE_LEN.
+   */
+  bool WebSocketClient::begin(const char* host, uint16_t port,
+                              const char* path,
+                              WebSocketMessageCallback callback,
+                              void* context) {
+    this->close();
+    this->host = host;
+    this->port = port;
+    this->callback = callback;
+    this->context = context;
+    this->secureClient.setInsecure();
+    // The key is filled in for every connection by connect()
+    const int len = snprintf(this->handshake, WEBSOCKET_MAX_HANDSHAKE_LEN,
+                             "GET %s HTTP/1.1\r\n"
+                             "Host: %s\r\n"
+                             "Upgrade: websocket\r\n"
+                             "Connection: Upgrade\r\n"
+                             "Sec-WebSocket-Version: 13\r\n"
+                             "Sec-WebSocket-Key: %*s\r\n"
+                             "\r\n",
+                             path, host, static_cast<int>(WEBSOCKET_KEY_LEN),
+                             "");
+    if (len < 0 || static_cast<size_t>(len) >= WEBSOCKET_MAX_HANDSHAKE_LEN) {
+      this->handshakeLen = 0;
+      return false;
+    }
+    this->handshakeLen = len;
+    return true;
+  }
+
+  /**
+   * @brief Start opening the connection. The connection is made on the next
+   *  poll().
+   */
+  void WebSocketClient::connect() {
+    this->disconnect();
+    if (this->handshakeLen == 0) {
+      this->fail(WEBSOCKET_ERROR_NOT_INITIALIZED);
+      return;
+    }
+    this->error = 0;
+    this->setState(WebSocketState::CONNECTING);
+  }
+
+  /**
+   * @brief Do the next bounded piece of work: connect, read the handshake
+   *  response, or read frames and pass messages to the callback.
+   *
+   * @return WebSocketState The state after this step.
+   */
+  WebSocketState WebSocketClient::poll() {
+    switch (this->state) {
+      case WebSocketState::CONNECTING: {
+        // Blocking, for the TLS handshake
+        if (!this->client->connect(this->host, this->port)) {
+          this->fail(WEBSOCKET_ERROR_CONNECTION_FAILED);
+          break;
+        }
+        // A new random key for every connection
+        uint8_t nonce[16];
+        for (size_t i = 0; i < sizeof(nonce); i += 4) {
+          const uint32_t r = Telemetry::randomWord();
+          memcpy(nonce + i, &r, 4);
+        }
+        // The key is the last header, right before the final "\r\n\r\n"
+        encodeWebSocketKey(nonce, this->handshake + this->handshakeLen - 4 -
+                                    WEBSOCKET_KEY_LEN);
+        if (this->client->write(reinterpret_cast<uint8_t*>(this->handshake),
+                               this->handshakeLen) != this->handshakeLen) {
+          this->fail(WEBSOCKET_ERROR_SEND_FAILED);
+          break;
+        }
+        this->headLineLen = 0;
+        this->hasStatusLine = false;
+        this->setState(WebSocketState::HANDSHAKING);
+        break;
+      }
+      case WebSocketState::HANDSHAKING:
+        this->pollHandshake();
+        break;
+      case WebSocketState::OPEN:
+        this->pollFrames();
+        break;
+      default:
+        break;
+    }
+    return this->state;
+  }
+
+  /**
+   * @brief Send a text message in one frame.
+   *
+   * @param text The message.
+   * @return true if it was sent. The connection is failed otherwise.
+   */
+  bool WebSocketClient::sendText(const char* text) {
+    if (this->state != WebSocketState::OPEN) {
+      return false;
+    }
+    return this->sendFrame(OPCODE_TEXT, reinterpret_cast<const uint8_t*>(text),
+                           strlen(text));
+  }
+
+  /**
+   * @brief Close the connection, telling the server if it is open.
+   */
+  void WebSocketClient::close() {
+    if (this->state == WebSocketState::OPEN) {
+      this->sendFrame(OPCODE_CLOSE, nullptr, 0);
+    }
+    this->disconnect();
+    this->state = WebSocketState::CLOSED;
+  }
+
+  void WebSocketClient::fail(int32_t errorCode) {
+    this->disconnect();
+    this->error = errorCode;
+    this->state = WebSocketState::ERROR;
+  }
+
+  void WebSocketClient::disconnect() {
+    this->client->stop();
+    this->rxPos = 0;
+    this->rxLen = 0;
+    this->frameState = FrameState::HEADER;
+    this->inMessage = false;
+    this->pingSent = false;
+  }
+
+  bool WebSocketClient::fillRx() {
+    if (this->rxPos < this->rxLen) {
+      return true;
+    }
+    const int avail = this->client->available();
+    if (avail <= 0) {
+      return false;
+    }
+    const int n = this->client->read(
+      this->rxBuf, min(static_cast<size_t>(avail), WEBSOCKET_RX_BUFFER_LEN));
+    if (n <= 0) {
+      return false;
+    }
+    this->rxPos = 0;
+    this->rxLen = n;
+    this->lastRxTime = millis();
+    this->pingSent = false;
+    return true;
+  }
+
+  /**
+   * @brief Send one masked frame, as required for frames from a client.
+   *
+   * @param frameOpcode The OPCODE_* of the frame.
+   * @param payload The payload, may be nullptr if len is 0.
+   * @param len The length of payload, less than 65536.
+   * @return true if the whole frame was written.
+   */
+  bool WebSocketClient::sendFrame(uint8_t frameOpcode, const uint8_t* payload,
+                                  size_t len) {
+    if (len > 0xFFFF) {
+      return false;
+    }
+    uint8_t header[8];
+    size_t headerLen = 0;
+    header[headerLen++] = 0x80 | frameOpcode; // Always the final frame
+    if (len < 126) {
+      header[headerLen++] = 0x80 | len;
+    } else {
+      header[headerLen++] = 0x80 | 126;
+      header[headerLen++] = len >> 8;
+      header[headerLen++] = len & 0xFF;
+    }
+    const uint32_t maskKey = Telemetry::randomWord();
+    const uint8_t* mask = header + headerLen;
+    memcpy(header + headerLen, &maskKey, 4);
+    headerLen += 4;
+    bool ok = this->client->write(header, headerLen) == headerLen;
+    // Mask a piece at a time to keep the stack small
+    uint8_t masked[64];
+    for (size_t pos = 0; ok && pos < len; pos += sizeof(masked)) {
+      const size_t n = min(len - pos, sizeof(masked));
+      for (size_t i = 0; i < n; i++) {
+        masked[i] = payload[pos + i] ^ mask[(pos + i) & 3];
+      }
+      ok = this->client->write(masked, n) == n;
+    }
+    if (!ok) {
+      this->fail(WEBSOCKET_ERROR_SEND_FAILED);
+    }
+    return ok;
+  }
+
+  void WebSocketClient::pollHandshake() {
+    for (size_t i = 0; i < WEBSOCKET_RX_BUFFER_LEN; i++) {
+      if (!this->fillRx()) {
+        if (!this->client->connected()) {
+          this->fail(WEBSOCKET_ERROR_CONNECTION_LOST);
+        } else if (millis() - this->stateStartTime > this->handshakeTimeout) {
+          this->fail(WEBSOCKET_ERROR_TIMEOUT);
+        }
+        return;
+      }
+      const char c = static_cast<char>(this->rxBuf[this->rxPos++]);
+      if (c == '\r') {
+        continue;
+      }
+      if (c != '\n') {
+        if (this->headLineLen < WEBSOCKET_MAX_HEADER_LINE_LEN - 1) {
+          this->headLine[this->headLineLen++] = c; // Overlong lines truncated
+        }
+        continue;
+      }
+      this->headLine[this->headLineLen] = '\0';
+      this->headLineLen = 0;
+      if (!this->handleHeadLine()) {
+        return; // Open, or failed
+      }
+    }
+  }
+
+  /**
+   * @brief Handle one line of the handshake response. Only the status is
+   *  checked, Sec-WebSocket-Accept isn't since that needs SHA-1 and the
+   *  server isn't authenticated anyway. (setInsecure())
+   *
+   * @return true if more lines are expected.
+   */
+  bool WebSocketClient::handleHeadLine() {
+    const char* line = this->headLine;
+    if (!this->hasStatusLine) {
+      // Ex. "HTTP/1.1 101 Switching Protocols"
+      if (strncmp(line, "HTTP/1.1 101", 12) != 0) {
+        LOG_WARN("WebSocket handshake failed: %s", line);
+        this->fail(WEBSOCKET_ERROR_HANDSHAKE_FAILED);
+        return false;
+      }
+      this->hasStatusLine = true;
+      return true;
+    }
+    if (line[0] == '\0') { // End of headers
+      this->frameState = FrameState::HEADER;
+      this->inMessage = false;
+      this->lastRxTime = millis();
+      this->setState(WebSocketState::OPEN);
+      return false;
+    }
+    return true;
+  }
+
+  void WebSocketClient::pollFrames() {
+    // At most one buffer's worth per call
+    size_t budget = WEBSOCKET_RX_BUFFER_LEN;
+    while (budget > 0 && this->state == WebSocketState::OPEN) {
+      if (!this->fillRx()) {
+        if (!this->client->connected()) {
+          this->fail(WEBSOCKET_ERROR_CONNECTION_LOST);
+          return;
+        }
+        break;
+      }
+      if (this->frameState == FrameState::PAYLOAD) {
+        const size_t before = this->rxPos;
+        this->handlePayload();
+        budget -= min(budget, this->rxPos - before);
+      } else {
+        if (!this->handleFrameByte(this->rxBuf[this->rxPos++])) {
+          this->fail(WEBSOCKET_ERROR_PROTOCOL);
+          return;
+        }
+        budget--;
+      }
+    }
+    if (this->state != WebSocketState::OPEN) {
+      return;
+    }
+    const uint32_t quietTime = millis() - this->lastRxTime;
+    if (quietTime > 2 * this->pingInterval) {
+      this->fail(WEBSOCKET_ERROR_TIMEOUT);
+    } else if (quietTime > this->pingInterval && !this->pingSent) {
+      this->pingSent = this->sendFrame(OPCODE_PING, nullptr, 0);
+    }
+  }
+
+  /**
+   * @brief Handle one byte of a frame header.
+   *
+   * @param c The byte.
+   * @return false if the frame is invalid.
+   */
+  bool WebSocketClient::handleFrameByte(uint8_t c) {
+    switch (this->frameState) {
+      case FrameState::HEADER:
+        if (c & 0x70) {
+          return false; // No extensions were negotiated
+        }
+        this->finalFrame = c & 0x80;
+        this->opcode = c & 0x0F;
+        this->frameState = FrameState::LENGTH;
+        return true;
+      case FrameState::LENGTH:
+        if (c & 0x80) {
+          return false; // Frames from the server must not be masked
+        }
+        this->payloadRemaining = 0;
+        if ((c & 0x7F) >= 126) {
+          this->extendedLengthBytes = (c & 0x7F) == 126 ? 2 : 8;
+          this->frameState = FrameState::EXTENDED_LENGTH;
+          return true;
+        }
+        this->payloadRemaining = c & 0x7F;
+        break;
+      case FrameState::EXTENDED_LENGTH:
+        if (this->payloadRemaining > 0x00FFFFFF) {
+          return false; // Way too long for anything we subscribe to
+        }
+        this->payloadRemaining = (this->payloadRemaining << 8) | c;
+        if (--this->extendedLengthBytes > 0) {
+          return true;
+        }
+        break;
+      default:
+        return false;
+    }
+
+    // Header done, check the frame makes sense before its payload
+    if (this->opcode >= OPCODE_CLOSE) {
+      if (!this->finalFrame ||
+          this->payloadRemaining > WEBSOCKET_MAX_CONTROL_PAYLOAD_LEN) {
+        return false;
+      }
+      this->controlPayloadLen = 0;
+    } else if (this->opcode == OPCODE_TEXT || this->opcode == OPCODE_BINARY) {
+      if (this->inMessage) {
+        return false; // The last message wasn't finished
+      }
+      this->inMessage = true;
+      this->messageStarted = false;
+    } else if (this->opcode != OPCODE_CONTINUATION || !this->inMessage) {
+      return false;
+    }
+    this->frameState = FrameState::PAYLOAD;
+    if (this->payloadRemaining == 0) {
+      this->handlePayload();
+    }
+    return true;
+  }
+
+  /**
+   * @brief Handle as much of the current frame's payload as is in the
+   *  receive buffer.
+   */
+  void WebSocketClient::handlePayload() {
+    const size_t n = min(static_cast<size_t>(this->payloadRemaining),
+                         this->rxLen - this->rxPos);
+    const uint8_t* data = this->rxBuf + this->rxPos;
+    this->rxPos += n;
+    this->payloadRemaining -= n;
+    const bool frameDone = this->payloadRemaining == 0;
+    if (frameDone) {
+      this->frameState = FrameState::HEADER;
+    }
+
+    if (this->opcode >= OPCODE_CLOSE) {
+      memcpy(this->controlPayload + this->controlPayloadLen, data, n);
+      this->controlPayloadLen += n;
+      if (frameDone) {
+        this->handleControlFrame();
+      }
+      return;
+    }
+
+    const bool first = !this->messageStarted;
+    const bool last = frameDone && this->finalFrame;
+    if (n == 0 && !first && !last) {
+      return;
+    }
+    this->messageStarted = true;
+    if (last) {
+      this->inMessage = false;
+    }
+    // Last, since the callback may send or close
+    this->callback(this->context, reinterpret_cast<const char*>(data), n,
+                   first, last);
+  }
+
+  void WebSocketClient::handleControlFrame() {
+    switch (this->opcode) {
+      case OPCODE_PING:
+        this->sendFrame(OPCODE_PONG, this->controlPayload,
+                        this->controlPayloadLen);
+        break;
+      case OPCODE_PONG:
+        break; // Receiving it already reset the ping timer
+      case OPCODE_CLOSE:
+        // Echo the status code back, then the server closes the connection
+        this->sendFrame(OPCODE_CLOSE, this->controlPayload,
+                        min(this->controlPayloadLen, static_cast<size_t>(2)));
+        this->fail(WEBSOCKET_ERROR_CLOSED_BY_SERVER);
+        break;
+      default:
+        this->fail(WEBSOCKET_ERROR_PROTOCOL);
+        break;
+    }
+  }
+} // StockTicker
@@ -0,0 +1,176 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_WEBSOCKETCLIENT_H
+#define PICO2W_STOCK_TICKER_WEBSOCKETCLIENT_H
+
+#include <Arduino.h>
+#include <Log.h>
+#include <SystemStats.h>
+#include <WiFiClientSecure.h>
+
+namespace StockTicker {
+  const size_t WEBSOCKET_RX_BUFFER_LEN = 256;
+  const size_t WEBSOCKET_MAX_HANDSHAKE_LEN = 256;
+  const size_t WEBSOCKET_MAX_HEADER_LINE_LEN = 128;
+  // Control frames (ping, pong, close) can't be longer than this
+  const size_t WEBSOCKET_MAX_CONTROL_PAYLOAD_LEN = 125;
+
+  // Values of WebSocketClient::getError()
+  const int32_t WEBSOCKET_ERROR_CONNECTION_FAILED = -1;
+  const int32_t WEBSOCKET_ERROR_HANDSHAKE_FAILED = -2;
+  const int32_t WEBSOCKET_ERROR_CONNECTION_LOST = -3;
+  const int32_t WEBSOCKET_ERROR_TIMEOUT = -4;
+  const int32_t WEBSOCKET_ERROR_PROTOCOL = -5;
+  const int32_t WEBSOCKET_ERROR_SEND_FAILED = -6;
+  const int32_t WEBSOCKET_ERROR_CLOSED_BY_SERVER = -7;
+  const int32_t WEBSOCKET_ERROR_NOT_INITIALIZED = -8;
+
+  /**
+   * @brief State of the connection of a WebSocketClient.
+   */
+  enum class WebSocketState : uint8_t {
+    CLOSED,
+    CONNECTING,
+    HANDSHAKING,
+    OPEN,
+    ERROR
+  };
+
+  /**
+   * @brief Called with each piece of a text or binary message as it arrives.
+   *
+   * @param context The context pointer given to WebSocketClient::begin().
+   * @param data The next piece of the message.
+   * @param len The length of data, may be 0.
+   * @param first True for the first piece of a message.
+   * @param last True for the last piece of a message.
+   */
+  typedef void (*WebSocketMessageCallback)(void* context, const char* data,
+                                           size_t len, bool first, bool last);
+
+  /**
+   * @brief Minimal non-blocking WebSocket (RFC 6455) client over TLS.
+   *
+   * Like HttpKeepAliveClient, every call to poll() does a bounded amount of
+   * work, except opening the connection. Messages are never buffered whole:
+   * each piece is passed to the callback straight from the receive buffer,
+   * so they can be fed to a streaming parser. Pings are answered, and a ping
+   * is sent when the connection has been quiet for pingInterval.
+   */
+  class WebSocketClient {
+    public:
+      WebSocketClient() = default;
+      ~WebSocketClient() = default;
+
+      /**
+       * @brief Connect over another connection instead of the built in
+       *  WiFiClientSecure, ex. a scripted one in host tests. Call before
+       *  begin().
+       *
+       * @param client The connection, must stay valid while this client is
+       *  used.
+       */
+      void setClient(Client* client) {
+        this->client = client;
+      }
+
+      bool begin(const char* host, uint16_t port, const char* path,
+                 WebSocketMessageCallback callback, void* context);
+      void connect();
+      WebSocketState poll();
+      bool sendText(const char* text);
+      void close();
+
+      /**
+       * @brief Get the state of the connection.
+       *
+       * @return WebSocketState
+       */
+      WebSocketState getState() const {
+        return this->state;
+      }
+
+      /**
+       * @brief Get why the state is ERROR, a WEBSOCKET_ERROR_* value.
+       *
+       * @return int32_t
+       */
+      int32_t getError() const {
+        return this->error;
+      }
+
+      /**
+       * @brief How long connecting and the handshake can take, in
+       *  milliseconds.
+       */
+      uint32_t handshakeTimeout = 10000;
+      /**
+       * @brief How long the connection can be quiet before sending a ping, in
+       *  milliseconds. It is closed if still quiet after twice this long.
+       */
+      uint32_t pingInterval = 30000;
+
+    protected:
+      enum class FrameState : uint8_t {
+        HEADER,
+        LENGTH,
+        EXTENDED_LENGTH,
+        PAYLOAD
+      };
+
+      WiFiClientSecure secureClient;
+      Client* client = &this->secureClient;
+      const char* host = nullptr;
+      uint16_t port = 443;
+      char handshake[WEBSOCKET_MAX_HANDSHAKE_LEN];
+      size_t handshakeLen = 0;
+
+      WebSocketMessageCallback callback = nullptr;
+      void* context = nullptr;
+
+      WebSocketState state = WebSocketState::CLOSED;
+      int32_t error = 0;
+      uint32_t stateStartTime = 0;
+      uint32_t lastRxTime = 0;
+      bool pingSent = false;
+
+      uint8_t rxBuf[WEBSOCKET_RX_BUFFER_LEN];
+      size_t rxPos = 0;
+      size_t rxLen = 0;
+
+      char headLine[WEBSOCKET_MAX_HEADER_LINE_LEN];
+      size_t headLineLen = 0;
+      bool hasStatusLine = false;
+
+      FrameState frameState = FrameState::HEADER;
+      uint8_t opcode = 0;
+      bool finalFrame = false;
+      uint8_t extendedLengthBytes = 0;
+      uint32_t payloadRemaining = 0;
+      // Whether the next data frame continues a message
+      bool inMessage = false;
+      bool messageStarted = false;
+      uint8_t controlPayload[WEBSOCKET_MAX_CONTROL_PAYLOAD_LEN];
+      size_t controlPayloadLen = 0;
+
+      void setState(WebSocketState newState) {
+        this->state = newState;
+        this->stateStartTime = millis();
+      }
+
+      void fail(int32_t errorCode);
+      void disconnect();
+      bool fillRx();
+      bool sendFrame(uint8_t frameOpcode, const uint8_t* payload, size_t len);
+      void pollHandshake();
+      bool handleHeadLine();
+      void pollFrames();
+      bool handleFrameByte(uint8_t c);
+      void handlePayload();
+      void handleControlFrame();
+  };
+} // StockTicker
+
+#endif // PICO2W_STOCK_TICKER_WEBSOCKETCLIENT_H
@@ -0,0 +1,213 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <Log.h>
+#include <stdarg.h>
+
+namespace Telemetry {
+  Logger logger;
+
+  static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0,
+                "LOG_BUFFER_SIZE must be a power of 2");
+  static_assert(LOG_MAX_RECORD_LEN < LOG_BUFFER_SIZE,
+                "A record must fit in the buffer");
+
+  /**
+   * @brief Print records right away (false), or only buffer them and print
+   *  them in drain() (true). Turning it off prints everything buffered
+   *  first.
+   *
+   * @param deferred Whether to defer printing.
+   */
+  void Logger::setDeferred(bool deferred) {
+    if (!deferred) {
+      this->flush();
+    }
+    this->deferred = deferred;
+  }
+
+  /**
+   * @brief Print buffered records to Serial1, only as much as fits in its
+   *  transmit FIFO so it never waits. Call it whenever loop() has time.
+   */
+  void Logger::drain() {
+    while (true) {
+      if (this->linePos < this->lineLen) {
+        this->writeLine(false);
+        if (this->linePos < this->lineLen) {
+          return;
+        }
+      }
+      uint8_t record[LOG_MAX_RECORD_LEN];
+      if (!this->pop(record)) {
+        // Records are dropped when the buffer is full, so they came after
+        // everything that was in it
+        const uint32_t dropped = this->droppedCount;
+        if (dropped == this->droppedReported) {
+          return;
+        }
+        this->lineLen = snprintf(this->line, LOG_MAX_LINE_LEN,
+                                 "%lu log records dropped\n",
+                                 static_cast<unsigned long>(
+                                   dropped - this->droppedReported));
+        this->linePos = 0;
+        this->droppedReported = dropped;
+        continue;
+      }
+      this->lineLen = this->format(record, this->line);
+      this->linePos = 0;
+    }
+  }
+
+  /**
+   * @brief Print every buffered record to Serial1, waiting on it as needed.
+   *  Call it before rebooting, or before printing to Serial1 directly.
+   */
+  void Logger::flush() {
+    while (true) {
+      this->writeLine(true);
+      this->drain();
+      if (this->linePos >= this->lineLen && this->head == this->tail) {
+        break;
+      }
+    }
+    Serial1.flush();
+  }
+
+  /**
+   * @brief printf into a buffer, with the arguments decoded by
+   *  formatArgs().
+   *
+   * @param out Where to print.
+   * @param size Room in out.
+   * @param format printf style format.
+   * @param ... The arguments.
+   * @return int What vsnprintf returned.
+   */
+  int Logger::printArgs(char* out, size_t size, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int written = vsnprintf(out, size, format, args);
+    va_end(args);
+    return written;
+  }
+
+  /**
+   * @brief Buffer a finished record, or print it right away if not deferred.
+   *  Dropped if the buffer is full.
+   *
+   * @param record The record, its arguments already copied in after the
+   *  header.
+   * @param len Its length.
+   * @param level How important it is.
+   * @param format printf style format.
+   * @param formatter Prints the arguments.
+   */
+  void Logger::commit(uint8_t* record, size_t len, LogLevel level,
+                      const char* format, ArgsFormatter formatter) {
+    const RecordHeader header = {static_cast<uint16_t>(len), level,
+                                 static_cast<uint32_t>(millis()), format,
+                                 formatter};
+    memcpy(record, &header, sizeof(header));
+    while (this->lock.test_and_set(std::memory_order_acquire)) {
+    }
+    if (!this->deferred) {
+      // Not this->line, drain() may be printing it from the other core
+      char line[LOG_MAX_LINE_LEN];
+      const size_t lineLen = this->format(record, line);
+      Serial1.write(reinterpret_cast<const uint8_t*>(line), lineLen);
+    } else if (LOG_BUFFER_SIZE - (this->head - this->tail) < len) {
+      this->droppedCount++;
+    } else {
+      for (size_t i = 0; i < len; i++) {
+        this->buffer[(this->head + i) & (LOG_BUFFER_SIZE - 1)] = record[i];
+      }
+      this->head += len;
+    }
+    this->lock.clear(std::memory_order_release);
+  }
+
+  /**
+   * @brief Take the oldest record out of the buffer.
+   *
+   * @param record Where to copy it, LOG_MAX_RECORD_LEN bytes.
+   * @return true A record was taken.
+   * @return false The buffer is empty.
+   */
+  bool Logger::pop(uint8_t* record) {
+    while (this->lock.test_and_set(std::memory_order_acquire)) {
+    }
+    const bool empty = this->head == this->tail;
+    if (!empty) {
+      uint16_t len = 0;
+      for (size_t i = 0; i < sizeof(len); i++) {
+        record[i] = this->buffer[(this->tail + i) & (LOG_BUFFER_SIZE - 1)];
+      }
+      memcpy(&len, record, sizeof(len));
+      for (size_t i = sizeof(len); i < len; i++) {
+        record[i] = this->buffer[(this->tail + i) & (LOG_BUFFER_SIZE - 1)];
+      }
+      this->tail += len;
+    }
+    this->lock.clear(std::memory_order_release);
+    return !empty;
+  }
+
+  /**
+   * @brief Format a record into a line, ex. "[12.345] Parsed batch 1\n".
+   *
+   * @param record The record.
+   * @param out Where to put the line, LOG_MAX_LINE_LEN bytes.
+   * @return size_t The length of the line.
+   */
+  size_t Logger::format(const uint8_t* record, char* out) const {
+    RecordHeader header;
+    memcpy(&header, record, sizeof(header));
+    const char* prefix = "";
+    switch (header.level) {
+      case LogLevel::ERROR:
+        prefix = "Error: ";
+        break;
+      case LogLevel::WARN:
+        prefix = "Warning: ";
+        break;
+      default:
+        break;
+    }
+    // Leave room for the newline
+    const size_t room = LOG_MAX_LINE_LEN - 1;
+    size_t len = snprintf(out, room, "[%lu.%03lu] %s",
+                          static_cast<unsigned long>(header.time / 1000),
+                          static_cast<unsigned long>(header.time % 1000),
+                          prefix);
+    const int written = header.formatter(record + sizeof(header),
+                                         header.format, out + len, room - len);
+    if (written > 0) {
+      len = min(len + static_cast<size_t>(written), room - 1);
+    }
+    out[len++] = '\n';
+    return len;
+  }
+
+  /**
+   * @brief Print the rest of the current line to Serial1.
+   *
+   * @param block Whether to wait for room in the transmit FIFO, otherwise
+   *  only what fits is printed.
+   */
+  void Logger::writeLine(bool block) {
+    while (this->linePos < this->lineLen) {
+      size_t count = this->lineLen - this->linePos;
+      if (!block) {
+        const int room = Serial1.availableForWrite();
+        if (room <= 0) {
+          return;
+        }
+        count = min(count, static_cast<size_t>(room));
+      }
+      this->linePos += Serial1.write(
+        reinterpret_cast<const uint8_t*>(this->line + this->linePos), count);
+    }
+  }
+} // Telemetry
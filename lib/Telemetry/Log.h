@@ -0,0 +1,293 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_LOG_H
+#define PICO2W_STOCK_TICKER_LOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <tuple>
+#include <type_traits>
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// Set in build_flags to change which logs are compiled in, ex.
+// -D LOG_LEVEL=LOG_LEVEL_DEBUG
+#ifndef LOG_LEVEL
+  #define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Only looks at a format and its arguments, so the compiler checks them like
+// printf's without evaluating them
+#define LOG_CHECK_FORMAT(...)                                           \
+  ((void)sizeof((::Telemetry::checkFormat(__VA_ARGS__), 0)))
+
+// Logs above LOG_LEVEL compile to nothing. Their arguments aren't evaluated,
+// only looked at so values computed just for them don't warn as unused.
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+  #define LOG_ERROR(...)                                                \
+    (LOG_CHECK_FORMAT(__VA_ARGS__),                                     \
+     ::Telemetry::logger.log(::Telemetry::LogLevel::ERROR, __VA_ARGS__))
+#else
+  #define LOG_ERROR(...) LOG_CHECK_FORMAT(__VA_ARGS__)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+  #define LOG_WARN(...)                                                 \
+    (LOG_CHECK_FORMAT(__VA_ARGS__),                                     \
+     ::Telemetry::logger.log(::Telemetry::LogLevel::WARN, __VA_ARGS__))
+#else
+  #define LOG_WARN(...) LOG_CHECK_FORMAT(__VA_ARGS__)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+  #define LOG_INFO(...)                                                 \
+    (LOG_CHECK_FORMAT(__VA_ARGS__),                                     \
+     ::Telemetry::logger.log(::Telemetry::LogLevel::INFO, __VA_ARGS__))
+#else
+  #define LOG_INFO(...) LOG_CHECK_FORMAT(__VA_ARGS__)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+  #define LOG_DEBUG(...)                                                \
+    (LOG_CHECK_FORMAT(__VA_ARGS__),                                     \
+     ::Telemetry::logger.log(::Telemetry::LogLevel::DEBUG, __VA_ARGS__))
+#else
+  #define LOG_DEBUG(...) LOG_CHECK_FORMAT(__VA_ARGS__)
+#endif
+
+namespace Telemetry {
+  /**
+   * @brief Does nothing, the LOG_* macros only name it in sizeof() to have
+   *  their formats checked against their arguments.
+   *
+   * @param format printf style format.
+   * @param ... The arguments for the format.
+   */
+  __attribute__((format(printf, 1, 2))) inline void
+  checkFormat(const char* format, ...) {}
+
+  // Must be a power of 2
+  const size_t LOG_BUFFER_SIZE = 4096;
+  // Longest record and longest line, anything after is cut off
+  const size_t LOG_MAX_RECORD_LEN = 320;
+  const size_t LOG_MAX_LINE_LEN = 320;
+  // Strings are cut off after this many characters
+  const size_t LOG_MAX_STRING_LEN = 255;
+
+  enum class LogLevel : uint8_t {
+    ERROR = LOG_LEVEL_ERROR,
+    WARN = LOG_LEVEL_WARN,
+    INFO = LOG_LEVEL_INFO,
+    DEBUG = LOG_LEVEL_DEBUG
+  };
+
+  /**
+   * @brief Deferred logger for Serial1, use it through the LOG_* macros with
+   *  printf style formats.
+   *
+   * Logging only copies the format's address and the raw arguments (strings
+   * by value) into a RAM ring buffer, so it doesn't wait on the UART. Each
+   * record also keeps a function that knows the types of its arguments, to
+   * hand them back to vsnprintf in drain(), a little at a time, when loop()
+   * has nothing else to do. If the buffer fills up, new records are dropped
+   * and counted instead of blocking.
+   *
+   * Until setDeferred(true), ex. during setup(), records are printed right
+   * away instead, so they stay in order with direct Serial1 prints.
+   *
+   * Safe to log from both cores, but not from interrupts. drain() and flush()
+   * must only be called from one core.
+   */
+  class Logger {
+    public:
+      Logger() = default;
+      ~Logger() = default;
+
+      /**
+       * @brief Log a record, see the LOG_* macros.
+       *
+       * @param level How important it is.
+       * @param format printf style format, must be a string literal since only
+       *  its address is kept.
+       * @param args The arguments for the format.
+       */
+      template <typename... Args>
+      void log(LogLevel level, const char* format, Args... args) {
+        static_assert(sizeof(RecordHeader) + (0 + ... + encodedSize<Args>()) <=
+                        LOG_MAX_RECORD_LEN,
+                      "Too many arguments for one log record");
+        uint8_t record[LOG_MAX_RECORD_LEN];
+        size_t len = sizeof(RecordHeader);
+        // Strings share whatever room the other arguments leave
+        [[maybe_unused]] size_t stringRoom =
+          LOG_MAX_RECORD_LEN - len - (0 + ... + encodedSize<Args>());
+        (this->encodeArg(record, len, stringRoom,
+                         static_cast<ArgValue<Args>>(args)),
+         ...);
+        this->commit(record, len, level, format,
+                     &Logger::formatArgs<ArgValue<Args>...>);
+      }
+
+      void setDeferred(bool deferred);
+      void drain();
+      void flush();
+
+      /**
+       * @brief Get how many records were dropped because the buffer was
+       *  full.
+       *
+       * @return uint32_t
+       */
+      uint32_t getDroppedCount() const {
+        return this->droppedCount;
+      }
+
+    protected:
+      // Prints the arguments after a record's header with its format
+      typedef int (*ArgsFormatter)(const uint8_t* args, const char* format,
+                                   char* out, size_t size);
+
+      // clang-format off
+      struct RecordHeader {
+        uint16_t len;
+        LogLevel level;
+        uint32_t time;
+        const char* format;
+        ArgsFormatter formatter;
+      };
+      // clang-format on
+
+      // How an argument is kept: enums as their underlying type, so they
+      // can be passed through "...", and strings by value
+      template <typename T, bool = std::is_enum<T>::value>
+      struct ArgValueOf {
+        typedef typename std::conditional<
+          std::is_convertible<T, const char*>::value, const char*, T>::type
+          type;
+      };
+      template <typename T>
+      struct ArgValueOf<T, true> {
+        typedef typename std::underlying_type<T>::type type;
+      };
+      template <typename T>
+      using ArgValue = typename ArgValueOf<T>::type;
+
+      uint8_t buffer[LOG_BUFFER_SIZE];
+      // Only ever go up, the buffer index is these modulo LOG_BUFFER_SIZE
+      uint32_t head = 0;
+      uint32_t tail = 0;
+      std::atomic_flag lock = ATOMIC_FLAG_INIT;
+      bool deferred = false;
+      volatile uint32_t droppedCount = 0;
+      uint32_t droppedReported = 0;
+
+      // The line being printed by drain(), only touched by drain() and
+      // flush()
+      char line[LOG_MAX_LINE_LEN];
+      size_t lineLen = 0;
+      size_t linePos = 0;
+
+      /**
+       * @brief Get how many bytes an argument takes in a record, not
+       *  counting the characters of a string.
+       *
+       * @return size_t
+       */
+      template <typename T>
+      static constexpr size_t encodedSize() {
+        // Strings are a length, the characters and a null terminator
+        return std::is_same<ArgValue<T>, const char*>::value
+                 ? 2
+                 : sizeof(ArgValue<T>);
+      }
+
+      /**
+       * @brief Copy one argument into a record. Strings are cut off at
+       *  LOG_MAX_STRING_LEN or the room left for them.
+       *
+       * @param record The record.
+       * @param len Length of the record so far, moved past the argument.
+       * @param stringRoom Room left for the characters of strings.
+       * @param arg The argument.
+       */
+      template <typename T>
+      static void encodeArg(uint8_t* record, size_t& len, size_t& stringRoom,
+                            T arg) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Log arguments must be numbers, pointers or strings");
+        if constexpr (std::is_same<T, const char*>::value) {
+          if (arg == nullptr) {
+            arg = "(null)";
+          }
+          const size_t strLen =
+            strnlen(arg, min(LOG_MAX_STRING_LEN, stringRoom));
+          record[len++] = strLen;
+          memcpy(record + len, arg, strLen);
+          len += strLen;
+          record[len++] = '\0';
+          stringRoom -= strLen;
+        } else {
+          memcpy(record + len, &arg, sizeof(arg));
+          len += sizeof(arg);
+        }
+      }
+
+      /**
+       * @brief Read one argument back out of a record.
+       *
+       * @param args The arguments of the record.
+       * @param pos Where the argument starts, moved past it.
+       * @return T The argument, strings point into the record.
+       */
+      template <typename T>
+      static T decodeArg(const uint8_t* args, size_t& pos) {
+        if constexpr (std::is_same<T, const char*>::value) {
+          const char* str = reinterpret_cast<const char*>(args + pos + 1);
+          pos += 1 + args[pos] + 1;
+          return str;
+        } else {
+          T value;
+          memcpy(&value, args + pos, sizeof(value));
+          pos += sizeof(value);
+          return value;
+        }
+      }
+
+      /**
+       * @brief Print the arguments of a record with its format, the
+       *  ArgsFormatter of records logged with these argument types.
+       *
+       * @param args The arguments of the record.
+       * @param format printf style format.
+       * @param out Where to print.
+       * @param size Room in out.
+       * @return int What vsnprintf returned.
+       */
+      template <typename... Args>
+      static int formatArgs([[maybe_unused]] const uint8_t* args,
+                            const char* format, char* out, size_t size) {
+        [[maybe_unused]] size_t pos = 0;
+        // Braced, so they're decoded in order
+        const std::tuple<Args...> values{decodeArg<Args>(args, pos)...};
+        return std::apply(
+          [&](Args... values) {
+            return printArgs(out, size, format, values...);
+          },
+          values);
+      }
+
+      static int printArgs(char* out, size_t size, const char* format, ...);
+      void commit(uint8_t* record, size_t len, LogLevel level,
+                  const char* format, ArgsFormatter formatter);
+      bool pop(uint8_t* record);
+      size_t format(const uint8_t* record, char* out) const;
+      void writeLine(bool block);
+  };
+
+  extern Logger logger;
+} // Telemetry
+
+#endif // PICO2W_STOCK_TICKER_LOG_H
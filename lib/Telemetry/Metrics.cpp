@@ -0,0 +1,156 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <Metrics.h>
+
+namespace Telemetry {
+  Metrics metrics;
+
+  static const char* const TIMING_NAMES[] = {
+    "connect",      "first_byte",    "body",         "parse", "render",
+    "scroll_frame", "settings_load", "settings_save"};
+  static const char* const COUNTER_NAMES[] = {"fetches",
+                                              "responses",
+                                              "new_connections",
+                                              "bytes_received",
+                                              "renders",
+                                              "responses_identical",
+                                              "symbol_updates_applied",
+                                              "symbol_updates_skipped",
+                                              "publishes_skipped",
+                                              "display_spi_bytes"};
+  static const char* const GAUGE_NAMES[] = {
+    "free_heap",       "free_stack_core0", "free_stack_core1",
+    "json_arena_peak", "symbol_storage"};
+  static_assert(sizeof(TIMING_NAMES) / sizeof(TIMING_NAMES[0]) ==
+                  static_cast<uint8_t>(MetricTiming::COUNT),
+                "Name every timing");
+  static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) ==
+                  static_cast<uint8_t>(MetricCounter::COUNT),
+                "Name every counter");
+  static_assert(sizeof(GAUGE_NAMES) / sizeof(GAUGE_NAMES[0]) ==
+                  static_cast<uint8_t>(MetricGauge::COUNT),
+                "Name every gauge");
+
+  /**
+   * @brief Add a timing to its histogram.
+   *
+   * @param timing Which one.
+   * @param micros How long it took, in microseconds.
+   */
+  void Metrics::record(MetricTiming timing, uint32_t micros) {
+    Histogram& histogram = this->histograms[static_cast<uint8_t>(timing)];
+    uint8_t bucket = 0;
+    while (bucket < HISTOGRAM_BUCKETS - 1 &&
+           micros >= HISTOGRAM_BOUNDS[bucket]) {
+      bucket++;
+    }
+    histogram.buckets[bucket]++;
+    histogram.count++;
+    histogram.sum += micros;
+    if (micros > histogram.max) {
+      histogram.max = micros;
+    }
+  }
+
+  /**
+   * @brief Add to a counter.
+   *
+   * @param counter Which one.
+   * @param amount How much to add.
+   */
+  void Metrics::add(MetricCounter counter, uint32_t amount /* = 1 */) {
+    this->counters[static_cast<uint8_t>(counter)] += amount;
+  }
+
+  /**
+   * @brief Set a gauge, keeping track of its lowest and highest value.
+   *
+   * @param gauge Which one.
+   * @param value The new value.
+   */
+  void Metrics::set(MetricGauge gauge, uint32_t value) {
+    Gauge& g = this->gauges[static_cast<uint8_t>(gauge)];
+    g.last = value;
+    if (!g.set || value < g.low) {
+      g.low = value;
+    }
+    if (!g.set || value > g.high) {
+      g.high = value;
+    }
+    g.set = true;
+  }
+
+  /**
+   * @brief Sample the free heap and the free stack of the current core, to
+   *  find their low-water marks. Call it where memory use peaks.
+   */
+  void Metrics::sampleMemory() {
+    this->set(MetricGauge::FREE_HEAP, freeHeapBytes());
+    this->set(currentCore() == 0 ? MetricGauge::FREE_STACK_CORE0
+                                 : MetricGauge::FREE_STACK_CORE1,
+              freeStackBytes());
+  }
+
+  /**
+   * @brief Clear every metric.
+   */
+  void Metrics::reset() {
+    memset(this->histograms, 0, sizeof(this->histograms));
+    for (uint8_t i = 0; i < static_cast<uint8_t>(MetricCounter::COUNT); i++) {
+      this->counters[i] = 0;
+    }
+    memset(this->gauges, 0, sizeof(this->gauges));
+  }
+
+  /**
+   * @brief Print a summary of every metric, one per line. Percentiles are
+   *  the upper bound of the bucket they fall in.
+   *
+   * @param out Where to print, ex. Serial1.
+   */
+  void Metrics::print(Print& out) const {
+    for (uint8_t i = 0; i < static_cast<uint8_t>(MetricCounter::COUNT); i++) {
+      out.printf("%s: %lu\n", COUNTER_NAMES[i],
+                 static_cast<unsigned long>(this->counters[i]));
+    }
+    for (uint8_t i = 0; i < static_cast<uint8_t>(MetricGauge::COUNT); i++) {
+      const Gauge& g = this->gauges[i];
+      if (g.set) {
+        out.printf("%s: %lu (low %lu, high %lu)\n", GAUGE_NAMES[i],
+                   static_cast<unsigned long>(g.last),
+                   static_cast<unsigned long>(g.low),
+                   static_cast<unsigned long>(g.high));
+      }
+    }
+    for (uint8_t i = 0; i < static_cast<uint8_t>(MetricTiming::COUNT); i++) {
+      const Histogram& h = this->histograms[i];
+      if (h.count == 0) {
+        continue;
+      }
+      // Bucket holding the median and the 90th percentile
+      uint8_t p50 = HISTOGRAM_BUCKETS - 1;
+      uint8_t p90 = HISTOGRAM_BUCKETS - 1;
+      uint32_t seen = 0;
+      for (int8_t b = HISTOGRAM_BUCKETS - 1; b >= 0; b--) {
+        seen += h.buckets[b];
+        if (seen * 10 <= h.count) {
+          p90 = b - 1;
+        }
+        if (seen * 2 <= h.count) {
+          p50 = b - 1;
+        }
+      }
+      out.printf("%s: n %lu, avg %lu us, p50 <=%lu us, p90 <=%lu us, max "
+                 "%lu us\n",
+                 TIMING_NAMES[i], static_cast<unsigned long>(h.count),
+                 static_cast<unsigned long>(h.sum / h.count),
+                 static_cast<unsigned long>(
+                   p50 < HISTOGRAM_BUCKETS - 1 ? HISTOGRAM_BOUNDS[p50] : h.max),
+                 static_cast<unsigned long>(
+                   p90 < HISTOGRAM_BUCKETS - 1 ? HISTOGRAM_BOUNDS[p90] : h.max),
+                 static_cast<unsigned long>(h.max));
+    }
+  }
+} // Telemetry
@@ -0,0 +1,156 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_METRICS_H
+#define PICO2W_STOCK_TICKER_METRICS_H
+
+#include <Arduino.h>
+#include <SystemStats.h>
+
+namespace Telemetry {
+  // Upper bounds of the histogram buckets, in microseconds. The last bucket
+  // has no upper bound.
+  const uint8_t HISTOGRAM_BUCKETS = 12;
+  const uint32_t HISTOGRAM_BOUNDS[HISTOGRAM_BUCKETS - 1] = {
+    100,    300,     1000,    3000,    10000,  30000,
+    100000, 300000, 1000000, 3000000, 10000000};
+
+  /**
+   * @brief Timings kept as histograms, in microseconds.
+   */
+  enum class MetricTiming : uint8_t {
+    // DNS, TCP connect and TLS handshake, only on new connections
+    CONNECT,
+    // From the request being sent to the first byte of the response
+    FIRST_BYTE,
+    // From the end of the headers to the end of the body
+    BODY,
+    // CPU time spent parsing one body
+    PARSE,
+    // StockTicker::updateDisplay() re-rendering the display string
+    RENDER,
+    // One frame of the scrolling display, including sending the last one
+    SCROLL_FRAME,
+    SETTINGS_LOAD,
+    SETTINGS_SAVE,
+    COUNT
+  };
+
+  /**
+   * @brief Counters that only go up.
+   */
+  enum class MetricCounter : uint8_t {
+    FETCHES,
+    RESPONSES,
+    NEW_CONNECTIONS,
+    // Headers included
+    BYTES_RECEIVED,
+    RENDERS,
+    // Responses byte for byte the same as the last one for the same request.
+    // Only counted, they're still parsed: the hash is known once the whole
+    // body was, and it's the symbol by symbol comparison that skips work.
+    RESPONSES_IDENTICAL,
+    // Symbols in responses whose prices changed, or were the same
+    SYMBOL_UPDATES_APPLIED,
+    SYMBOL_UPDATES_SKIPPED,
+    // Responses with nothing new to hand off to the display
+    PUBLISHES_SKIPPED,
+    // Sent to the display's modules by the scrolling display's frames
+    DISPLAY_SPI_BYTES,
+    COUNT
+  };
+
+  /**
+   * @brief Gauges that keep their last, lowest and highest value.
+   */
+  enum class MetricGauge : uint8_t {
+    FREE_HEAP,
+    FREE_STACK_CORE0,
+    FREE_STACK_CORE1,
+    // Most of Settings::jsonArena used by one settings load or save
+    JSON_ARENA_PEAK,
+    // Bytes allocated by StockTicker::begin() for the symbols configured
+    SYMBOL_STORAGE,
+    COUNT
+  };
+
+  // clang-format off
+  struct Histogram {
+    uint32_t count;
+    uint64_t sum;
+    uint32_t max;
+    uint32_t buckets[HISTOGRAM_BUCKETS];
+  };
+
+  struct Gauge {
+    uint32_t last;
+    uint32_t low;
+    uint32_t high;
+    bool set;
+  };
+  // clang-format on
+
+  /**
+   * @brief Fixed set of counters, gauges and histograms, cheap enough to
+   *  leave on. Recording is a few adds and compares, with no allocation and
+   *  no printing, and print() dumps a summary on request.
+   *
+   * Each metric should only be recorded from one core. A print() racing
+   * with a record may show a slightly stale value, which is fine for stats.
+   */
+  class Metrics {
+    public:
+      Metrics() = default;
+      ~Metrics() = default;
+
+      void record(MetricTiming timing, uint32_t micros);
+      void add(MetricCounter counter, uint32_t amount = 1);
+      void set(MetricGauge gauge, uint32_t value);
+      void sampleMemory();
+      void reset();
+
+      void print(Print& out) const;
+
+      /**
+       * @brief Get a histogram, ex. to report it elsewhere.
+       *
+       * @param timing Which one.
+       * @return const Histogram&
+       */
+      const Histogram& get(MetricTiming timing) const {
+        return this->histograms[static_cast<uint8_t>(timing)];
+      }
+
+      /**
+       * @brief Get a counter.
+       *
+       * @param counter Which one.
+       * @return uint32_t
+       */
+      uint32_t get(MetricCounter counter) const {
+        return this->counters[static_cast<uint8_t>(counter)];
+      }
+
+      /**
+       * @brief Get a gauge.
+       *
+       * @param gauge Which one.
+       * @return const Gauge&
+       */
+      const Gauge& get(MetricGauge gauge) const {
+        return this->gauges[static_cast<uint8_t>(gauge)];
+      }
+
+    protected:
+      Histogram histograms[static_cast<uint8_t>(MetricTiming::COUNT)] = {};
+      volatile uint32_t counters[static_cast<uint8_t>(MetricCounter::COUNT)] =
+        {};
+      Gauge gauges[static_cast<uint8_t>(MetricGauge::COUNT)] = {};
+  };
+
+  // Shared by the StockTicker and the settings
+  extern Metrics metrics;
+} // Telemetry
+
+#endif // PICO2W_STOCK_TICKER_METRICS_H
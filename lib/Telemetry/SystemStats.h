@@ -0,0 +1,68 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_SYSTEMSTATS_H
+#define PICO2W_STOCK_TICKER_SYSTEMSTATS_H
+
+#include <Arduino.h>
+
+// The only calls into the Pico core outside of the Arduino API, so the
+// libraries also build on a host against a plain Arduino API shim
+namespace Telemetry {
+  /**
+   * @brief Get how much of the heap is free.
+   *
+   * @return uint32_t In bytes, 0 where it can't be measured.
+   */
+  inline uint32_t freeHeapBytes() {
+#ifdef ARDUINO_ARCH_RP2040
+    return rp2040.getFreeHeap();
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * @brief Get how much of the current core's stack is free.
+   *
+   * @return uint32_t In bytes, 0 where it can't be measured.
+   */
+  inline uint32_t freeStackBytes() {
+#ifdef ARDUINO_ARCH_RP2040
+    return rp2040.getFreeStack();
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * @brief Get which core this is running on.
+   *
+   * @return uint8_t 0 or 1, always 0 where there is only one.
+   */
+  inline uint8_t currentCore() {
+#ifdef ARDUINO_ARCH_RP2040
+    return rp2040.cpuid();
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * @brief Get a random word, for jitter and WebSocket keys and masks.
+   *
+   * @return uint32_t From the hardware generator on the Pico, rand()
+   *  elsewhere so host tests can seed it.
+   */
+  inline uint32_t randomWord() {
+#ifdef ARDUINO_ARCH_RP2040
+    return rp2040.hwrand32();
+#else
+    return (static_cast<uint32_t>(rand()) << 16) ^
+           static_cast<uint32_t>(rand());
+#endif
+  }
+} // Telemetry
+
+#endif // PICO2W_STOCK_TICKER_SYSTEMSTATS_H
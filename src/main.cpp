@@ -25,10 +25,34 @@ MD_MAX72XX display =
   MD_MAX72XX(HARDWARE_TYPE, DATA_PIN, CLK_PIN, CS_PIN, matrixModulesCount * 4);
 #endif
 
-MD_MAX72XX_Print textDisplay(&display);
-MD_MAX72XX_Scrolling scrollingDisplay(&display);
+MD_MAX72XX_GlyphCache glyphCache(&display);
+MD_MAX72XX_Print textDisplay(&display, &glyphCache);
+MD_MAX72XX_Scrolling scrollingDisplay(&display, &glyphCache);
+
+bool firstPricesShown = false;
+
+/**
+ * @brief Log how long after boot the first prices were on the display, once.
+ *
+ * @param source Where the prices came from, "cached" or "fetched".
+ */
+void logFirstPricesShown(const char* source) {
+  if (!firstPricesShown) {
+    firstPricesShown = true;
+    LOG_INFO("First %s prices shown %lu ms after boot", source, millis());
+  }
+}
+
+#ifdef USE_DUAL_CORE
+// Core 1 gets its own stack instead of splitting core 0's, the TLS handshake
+// needs a lot of it
+bool core1_separate_stack = true;
+volatile bool stockTickerStarted = false;
+#endif
 
 void startWiFiConfigOverUSBAndReboot(const char* msg) {
+  // Nothing else runs until the reboot, so print logs right away
+  Telemetry::logger.setDeferred(false);
   Serial1.println("Exposing FatFSUSB for WiFi settings editing");
   wifiSettings.fatFSUSBBegin();
   Serial1.println("USB connected, waiting for eject...");
@@ -50,6 +74,8 @@ void startWiFiConfigOverUSBAndReboot(const char* msg) {
 }
 
 void startTickerConfigOverUSBAndReboot(const char* msg) {
+  // Nothing else runs until the reboot, so print logs right away
+  Telemetry::logger.setDeferred(false);
   Serial1.println("Exposing FatFSUSB for Ticker settings editing");
   tickerSettings.fatFSUSBBegin();
   Serial1.println("USB connected, waiting for eject...");
@@ -201,7 +227,7 @@ void setup() {
           case Settings::TickerSettingsValidationResult::ERROR_INVALID_SYMBOLS:
             startTickerConfigOverUSBAndReboot(
               "Invalid symbols, modify \"symbols\" key (must be comma "
-              "separated list of 1 to 32 stock symbols) in "
+              "separated list of 1 to 256 stock symbols) in "
               "ticker_settings.json on USB drive and eject to finish.");
           case Settings::TickerSettingsValidationResult::
             ERROR_INVALID_SOURCE_FEED:
@@ -231,6 +257,13 @@ void setup() {
               "(must be a natural number between 1 and 15 inclusive) in "
               "ticker_settings.json on USB drive and eject to finish.");
             break;
+          case Settings::TickerSettingsValidationResult::
+            ERROR_INVALID_DATA_SOURCE:
+            startTickerConfigOverUSBAndReboot(
+              "Invalid data source, modify \"dataSource\" key (must be "
+              "\"snapshots\", \"latestTrades\", or \"stream\") in "
+              "ticker_settings.json on USB drive and eject to finish.");
+            break;
           case Settings::TickerSettingsValidationResult::OK:
             break;
         }
@@ -247,33 +280,95 @@ void setup() {
   }
 
   Serial1.println(tickerSettings.symbols);
+#ifdef DATA_SERVER_HOST
+  stockTicker.setDataServer(DATA_SERVER_HOST, DATA_SERVER_PORT);
+#endif
+#ifdef STREAM_SERVER_HOST
+  stockTicker.setStreamServer(STREAM_SERVER_HOST, STREAM_SERVER_PORT);
+#endif
   stockTicker.begin(tickerSettings.apcaApiKeyId,
                     tickerSettings.apcaApiSecretKey, tickerSettings.symbols,
                     tickerSettings.sourceFeed,
-                    tickerSettings.requestPeriod * 1000);
+                    tickerSettings.requestPeriod * 1000,
+                    tickerSettings.getDataSource());
 
-  scrollingDisplay.setText(stockTicker.getDisplayStr());
+  // Cached prices start on the left so they can be read right away
+  scrollingDisplay.setText(stockTicker.getDisplayStr(),
+                           stockTicker.hasCachedPrices());
   scrollingDisplay.periodBetweenShifts = tickerSettings.scrollPeriod;
+  // Each symbol's sparkline is drawn where the marker is in its text
+  scrollingDisplay.setColumnProvider(StockTicker::StockTicker::sparklineColumn,
+                                     StockTicker::SPARKLINE_WIDTH,
+                                     &stockTicker);
   display.control(MD_MAX72XX::INTENSITY, tickerSettings.displayBrightness);
+  if (stockTicker.hasCachedPrices()) {
+    scrollingDisplay.update();
+    display.update();
+    logFirstPricesShown("cached");
+  }
+  // From here on logs are printed from loop() when it has time, instead of
+  // holding up fetching and scrolling
+  Telemetry::logger.setDeferred(true);
+#ifdef USE_DUAL_CORE
+  stockTickerStarted = true;
+#endif
 }
 
+#ifdef USE_DUAL_CORE
+void setup1() {
+  while (!stockTickerStarted) {
+    delay(1); // Wait for settings to load and stockTicker.begin()
+  }
+}
+
+// Fetching and parsing prices runs on core 1, and prices are handed to core 0
+// through StockTicker's price table
+void loop1() {
+  if (WiFi.status() == WL_CONNECTED) {
+    stockTicker.update();
+  }
+}
+#endif
+
 void loop() {
   static StockTicker::StockTickerStatus lastStatus =
     StockTicker::StockTickerStatus::OK;
 
   // If configuration button pressed, start WiFi configuration over USB
   if (configBtn.pressed()) {
+    Telemetry::logger.setDeferred(false);
     Serial1.println("Config button pressed");
     Serial1.println("Stopping WiFi and rebooting");
     WiFi.end();
     rp2040.reboot();
   }
+  // Send 'm' over the serial port to dump the fetch metrics
+  if (Serial1.available() > 0 && Serial1.read() == 'm') {
+    // Finish the log line being printed first
+    Telemetry::logger.flush();
+    stockTicker.printMetrics(Serial1);
+  }
   if (WiFi.status() == WL_CONNECTED) {
+#ifndef USE_DUAL_CORE
     stockTicker.update();
-    scrollingDisplay.update();
+#endif
+    if (stockTicker.updateDisplay()) {
+      // The prices and sparklines already on the display changed, unless
+      // it's showing an error message instead
+      scrollingDisplay.textChanged(stockTicker.getDisplayStr(),
+                                   stockTicker.getDisplayStrLen());
+      logFirstPricesShown("fetched");
+    }
+    if (scrollingDisplay.update()) {
+      Telemetry::metrics.record(Telemetry::MetricTiming::SCROLL_FRAME,
+                                scrollingDisplay.getLastFrameTime());
+      Telemetry::metrics.add(Telemetry::MetricCounter::DISPLAY_SPI_BYTES,
+                             scrollingDisplay.getLastFrameSpiBytes());
+    }
     if (stockTicker.getStatus() != lastStatus) {
       lastStatus = stockTicker.getStatus();
-      Serial1.printf("Stock ticker status changed: %s\n", lastStatus);
+      LOG_INFO("Stock ticker status changed: %d",
+               static_cast<int>(lastStatus));
       switch (lastStatus) {
         case StockTicker::StockTickerStatus::OK:
           scrollingDisplay.setText(stockTicker.getDisplayStr());
@@ -325,25 +420,32 @@ void loop() {
       }
     }
   } else {
-    Serial1.println("Connecting to WiFi...");
-    textDisplay.print("Connecting to WiFi...");
-    display.update();
+    stockTicker.cancel(); // The connection to the API is gone as well
+    LOG_INFO("Connecting to WiFi...");
+    // Keep the cached prices up instead while connecting
+    const bool showingCachedPrices = stockTicker.hasCachedPrices();
+    if (!showingCachedPrices) {
+      textDisplay.print("Connecting to WiFi...");
+      display.update();
+    }
     WiFi.begin(wifiSettings.ssid, wifiSettings.password);
     delay(1000);
     // If WiFi connection fails, start WiFi configuration over USB
     if (WiFi.status() != WL_CONNECTED) {
-      Serial1.println("WiFi connection failed");
+      LOG_WARN("WiFi connection failed");
       startWiFiConfigOverUSBAndReboot(
         "WiFi connection failed, modify \"ssid\" and/or \"password\" in "
         "wifi_settings.json on USB drive and eject to finish.");
     }
-    Serial1.println("Connected to WiFi");
-    textDisplay.print("\nConnected to WiFi");
-    display.update();
-    Serial1.print("IP Address: ");
-    Serial1.println(WiFi.localIP());
-    delay(1000);
-    scrollingDisplay.reset();
+    LOG_INFO("Connected to WiFi, IP address: %s",
+             WiFi.localIP().toString().c_str());
+    if (!showingCachedPrices) {
+      textDisplay.print("\nConnected to WiFi");
+      display.update();
+      delay(1000);
+    }
+    scrollingDisplay.reset(showingCachedPrices);
     stockTicker.refreshOnNextUpdate();
   }
+  Telemetry::logger.drain();
 }
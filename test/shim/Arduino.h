@@ -0,0 +1,234 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_SHIM_ARDUINO_H
+#define PICO2W_STOCK_TICKER_SHIM_ARDUINO_H
+
+// The parts of the Arduino API the libraries use, for building them and
+// their tests on a host with [env:native]. Only what the libraries call is
+// here, and it behaves like the earlephilhower core where that matters.
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+using std::max;
+using std::min;
+
+template <class T, class L, class H>
+auto constrain(const T& x, const L& low, const H& high) {
+  return x < low ? low : (x > high ? high : x);
+}
+
+namespace HostShim {
+  // millis() only moves when a test moves it, so timeouts, backoff and
+  // scroll periods are deterministic. micros() is the real clock, it's only
+  // used to measure how long things take.
+  inline uint32_t millisNow = 0;
+
+  /**
+   * @brief Move millis() forward.
+   *
+   * @param ms How many milliseconds.
+   */
+  inline void advanceMillis(uint32_t ms) {
+    millisNow += ms;
+  }
+
+  /**
+   * @brief Get the real time, in nanoseconds, for timing benchmarks.
+   *
+   * @return uint64_t
+   */
+  inline uint64_t nanos() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(
+             steady_clock::now().time_since_epoch())
+      .count();
+  }
+} // HostShim
+
+inline unsigned long millis() {
+  return HostShim::millisNow;
+}
+
+inline unsigned long micros() {
+  return static_cast<unsigned long>(HostShim::nanos() / 1000);
+}
+
+inline void delay(unsigned long ms) {
+  HostShim::advanceMillis(ms);
+}
+
+inline void yield() {}
+
+class Print {
+  public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+      size_t n = 0;
+      while (size-- > 0 && this->write(*buffer++) == 1) {
+        n++;
+      }
+      return n;
+    }
+    size_t write(const char* str) {
+      return str == nullptr ? 0 : this->write(
+                                    reinterpret_cast<const uint8_t*>(str),
+                                    strlen(str));
+    }
+    size_t write(const char* buffer, size_t size) {
+      return this->write(reinterpret_cast<const uint8_t*>(buffer), size);
+    }
+    virtual int availableForWrite() {
+      return 0;
+    }
+    virtual void flush() {}
+
+    size_t print(const char* str) {
+      return this->write(str);
+    }
+    size_t print(char c) {
+      return this->write(static_cast<uint8_t>(c));
+    }
+    size_t print(long n) {
+      return this->printf("%ld", n);
+    }
+    size_t print(unsigned long n) {
+      return this->printf("%lu", n);
+    }
+    size_t print(int n) {
+      return this->print(static_cast<long>(n));
+    }
+    size_t print(unsigned int n) {
+      return this->print(static_cast<unsigned long>(n));
+    }
+    size_t println() {
+      return this->write("\r\n");
+    }
+    template <class T>
+    size_t println(T value) {
+      const size_t n = this->print(value);
+      return n + this->println();
+    }
+
+    size_t printf(const char* format, ...)
+      __attribute__((format(printf, 2, 3))) {
+      char buf[512];
+      va_list args;
+      va_start(args, format);
+      const int len = vsnprintf(buf, sizeof(buf), format, args);
+      va_end(args);
+      if (len <= 0) {
+        return 0;
+      }
+      return this->write(reinterpret_cast<const uint8_t*>(buf),
+                         min(static_cast<size_t>(len), sizeof(buf) - 1));
+    }
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) {
+      this->timeout = timeout;
+    }
+    // Never waits, the data a host test reads is already there
+    virtual size_t readBytes(char* buffer, size_t length) {
+      size_t n = 0;
+      while (n < length) {
+        const int c = this->read();
+        if (c < 0) {
+          break;
+        }
+        buffer[n++] = static_cast<char>(c);
+      }
+      return n;
+    }
+    size_t readBytes(uint8_t* buffer, size_t length) {
+      return this->readBytes(reinterpret_cast<char*>(buffer), length);
+    }
+
+  protected:
+    unsigned long timeout = 1000;
+};
+
+class IPAddress {
+  public:
+    IPAddress() = default;
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+      this->bytes[0] = a;
+      this->bytes[1] = b;
+      this->bytes[2] = c;
+      this->bytes[3] = d;
+    }
+
+    uint8_t bytes[4] = {0, 0, 0, 0};
+};
+
+class Client : public Stream {
+  public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    size_t write(uint8_t c) override = 0;
+    size_t write(const uint8_t* buffer, size_t size) override = 0;
+    virtual int read(uint8_t* buffer, size_t size) = 0;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+    virtual operator bool() = 0;
+    using Print::write;
+    using Stream::read;
+};
+
+// A UART whose output is kept in memory instead of sent anywhere, so tests
+// can check what was logged. Set echo to also print it.
+class HostSerial : public Stream {
+  public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override {
+      if (this->output.size() < MAX_OUTPUT_LEN) {
+        this->output += static_cast<char>(c);
+      }
+      if (this->echo) {
+        putchar(c);
+      }
+      return 1;
+    }
+    using Print::write;
+    int availableForWrite() override {
+      return this->writeRoom;
+    }
+    int available() override {
+      return 0;
+    }
+    int read() override {
+      return -1;
+    }
+    int peek() override {
+      return -1;
+    }
+
+    static const size_t MAX_OUTPUT_LEN = 1 << 20;
+    std::string output;
+    bool echo = false;
+    // What availableForWrite() says, ex. 32 for the FIFO of a busy UART
+    int writeRoom = 1 << 16;
+};
+
+inline HostSerial Serial;
+inline HostSerial Serial1;
+
+#endif // PICO2W_STOCK_TICKER_SHIM_ARDUINO_H
@@ -0,0 +1,124 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_SHIM_FATFS_H
+#define PICO2W_STOCK_TICKER_SHIM_FATFS_H
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+
+// A filesystem kept in memory. Tests can put files in it, read what was
+// written, and make begin() or open() fail.
+class File : public Stream {
+  public:
+    File() = default;
+    File(std::string* data, bool writable) {
+      this->data = data;
+      this->writable = writable;
+    }
+
+    explicit operator bool() const {
+      return this->data != nullptr;
+    }
+
+    size_t write(uint8_t c) override {
+      return this->write(&c, 1);
+    }
+    size_t write(const uint8_t* buffer, size_t size) override {
+      if (this->data == nullptr || !this->writable) {
+        return 0;
+      }
+      if (this->pos + size > this->data->size()) {
+        this->data->resize(this->pos + size);
+      }
+      memcpy(&(*this->data)[this->pos], buffer, size);
+      this->pos += size;
+      return size;
+    }
+    using Print::write;
+
+    int available() override {
+      return this->data == nullptr ? 0 : this->data->size() - this->pos;
+    }
+    int read() override {
+      uint8_t c;
+      return this->read(&c, 1) == 1 ? c : -1;
+    }
+    int read(uint8_t* buffer, size_t size) {
+      const size_t n = min(size, static_cast<size_t>(this->available()));
+      if (n > 0) {
+        memcpy(buffer, this->data->data() + this->pos, n);
+        this->pos += n;
+      }
+      return n;
+    }
+    int peek() override {
+      return this->available() > 0
+               ? static_cast<uint8_t>((*this->data)[this->pos])
+               : -1;
+    }
+    size_t readBytes(char* buffer, size_t length) override {
+      return this->read(reinterpret_cast<uint8_t*>(buffer), length);
+    }
+
+    bool seek(uint32_t pos) {
+      if (this->data == nullptr || pos > this->data->size()) {
+        return false;
+      }
+      this->pos = pos;
+      return true;
+    }
+    size_t size() const {
+      return this->data == nullptr ? 0 : this->data->size();
+    }
+    void close() {
+      this->data = nullptr;
+    }
+
+  protected:
+    std::string* data = nullptr;
+    bool writable = false;
+    size_t pos = 0;
+};
+
+class HostFatFS {
+  public:
+    bool begin() {
+      if (this->failBegin) {
+        return false;
+      }
+      this->mounted = true;
+      return true;
+    }
+    void end() {
+      this->mounted = false;
+    }
+    File open(const char* path, const char* mode) {
+      if (!this->mounted) {
+        return File();
+      }
+      if (mode[0] == 'w') {
+        std::string& data = this->files[path];
+        data.clear();
+        return File(&data, true);
+      }
+      const auto it = this->files.find(path);
+      return it == this->files.end() ? File() : File(&it->second, false);
+    }
+    bool exists(const char* path) {
+      return this->files.count(path) > 0;
+    }
+    bool remove(const char* path) {
+      return this->files.erase(path) > 0;
+    }
+
+    std::map<std::string, std::string> files;
+    bool failBegin = false;
+    bool mounted = false;
+};
+
+inline HostFatFS FatFS;
+
+#endif // PICO2W_STOCK_TICKER_SHIM_FATFS_H
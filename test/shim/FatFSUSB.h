@@ -0,0 +1,24 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_SHIM_FATFSUSB_H
+#define PICO2W_STOCK_TICKER_SHIM_FATFSUSB_H
+
+#include <Arduino.h>
+
+// There's no USB on the host, the callbacks are never called
+class HostFatFSUSB {
+  public:
+    bool begin() {
+      return true;
+    }
+    void end() {}
+    void onPlug(void (*callback)(uint32_t), uint32_t data = 0) {}
+    void onUnplug(void (*callback)(uint32_t), uint32_t data = 0) {}
+    void driveReady(bool (*callback)(uint32_t), uint32_t data = 0) {}
+};
+
+inline HostFatFSUSB FatFSUSB;
+
+#endif // PICO2W_STOCK_TICKER_SHIM_FATFSUSB_H
@@ -0,0 +1,212 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_SHIM_MD_MAX72XX_H
+#define PICO2W_STOCK_TICKER_SHIM_MD_MAX72XX_H
+
+#include <Arduino.h>
+
+#define COL_SIZE 8
+#define ROW_SIZE 8
+
+// Stand-in for an FC16 chain driven by MD_MAX72XX 3.5, with the same costs
+// so they can be counted:
+//  - Fonts are walked from the first character on every lookup, each step
+//    counted in fontReads.
+//  - Each module keeps its rows, and which rows changed since the last
+//    update(). update() sends every row that changed on any module to the
+//    whole chain, 2 bytes per module, counted in spiBytes.
+//  - Column 0 is the rightmost one, and TSL moves every column of the
+//    modules to the next higher one, the carry going into the next module.
+// The font is made up, but has the widths of the real one's characters.
+class MD_MAX72XX {
+  public:
+    enum moduleType_t { PAROLA_HW, GENERIC_HW, ICSTATION_HW, FC16_HW };
+    enum controlRequest_t {
+      SHUTDOWN,
+      SCANLIMIT,
+      INTENSITY,
+      TEST,
+      DECODE,
+      UPDATE,
+      WRAPAROUND
+    };
+    enum controlValue_t { OFF = 0, ON = 1 };
+    enum transformType_t { TSL, TSR, TSU, TSD, TFLR, TFUD, TRC, TINV };
+
+    static constexpr uint8_t MAX_DEVICES = 64;
+
+    MD_MAX72XX(moduleType_t type, uint8_t csPin, uint8_t numDevices = 1) {
+      this->deviceCount = min(numDevices, MAX_DEVICES);
+      memset(this->devices, 0, sizeof(this->devices));
+      buildFont();
+    }
+
+    void begin() {}
+    bool control(controlRequest_t request, int value) {
+      if (request == UPDATE) {
+        this->autoUpdate = value == ON;
+      }
+      return true;
+    }
+
+    uint16_t getColumnCount() const {
+      return this->deviceCount * COL_SIZE;
+    }
+    uint8_t getDeviceCount() const {
+      return this->deviceCount;
+    }
+
+    uint8_t getChar(uint16_t c, uint8_t size, uint8_t* buf) {
+      uint32_t offset = this->findChar(static_cast<uint8_t>(c));
+      const uint8_t width = min(size, font[offset++]);
+      memcpy(buf, font + offset, width);
+      return width;
+    }
+    uint8_t setChar(uint16_t col, uint16_t c) {
+      uint32_t offset = this->findChar(static_cast<uint8_t>(c));
+      const uint8_t width = font[offset++];
+      for (uint8_t i = 0; i < width && col - i >= 0; i++) {
+        this->setColumn(col - i, font[offset + i]);
+      }
+      return width;
+    }
+
+    uint8_t getColumn(uint16_t c) const {
+      if (c >= this->getColumnCount()) {
+        return 0;
+      }
+      const Device& device = this->devices[c / COL_SIZE];
+      const uint8_t bit = COL_SIZE - 1 - c % COL_SIZE;
+      uint8_t value = 0;
+      for (uint8_t row = 0; row < ROW_SIZE; row++) {
+        if (device.rows[row] & (1 << bit)) {
+          value |= 1 << row;
+        }
+      }
+      return value;
+    }
+    bool setColumn(uint16_t c, uint8_t value) {
+      if (c >= this->getColumnCount()) {
+        return false;
+      }
+      Device& device = this->devices[c / COL_SIZE];
+      const uint8_t bit = COL_SIZE - 1 - c % COL_SIZE;
+      for (uint8_t row = 0; row < ROW_SIZE; row++) {
+        if (value & (1 << row)) {
+          device.rows[row] |= 1 << bit;
+        } else {
+          device.rows[row] &= ~(1 << bit);
+        }
+      }
+      device.changedRows = 0xFF;
+      this->updateIfAuto();
+      return true;
+    }
+
+    bool transform(uint8_t startDev, uint8_t endDev, transformType_t type) {
+      if (type != TSL || startDev > endDev || endDev >= this->deviceCount) {
+        return false;
+      }
+      for (int dev = endDev; dev >= startDev; dev--) {
+        for (uint8_t row = 0; row < ROW_SIZE; row++) {
+          const uint8_t carry =
+            dev > startDev ? this->devices[dev - 1].rows[row] & 1 : 0;
+          this->devices[dev].rows[row] =
+            (this->devices[dev].rows[row] >> 1) | (carry << 7);
+        }
+        this->devices[dev].changedRows = 0xFF;
+      }
+      this->updateIfAuto();
+      return true;
+    }
+
+    void clear() {
+      for (uint8_t dev = 0; dev < this->deviceCount; dev++) {
+        memset(this->devices[dev].rows, 0, ROW_SIZE);
+        this->devices[dev].changedRows = 0xFF;
+      }
+      this->updateIfAuto();
+    }
+
+    void update() {
+      for (uint8_t row = 0; row < ROW_SIZE; row++) {
+        bool changed = false;
+        for (uint8_t dev = 0; dev < this->deviceCount; dev++) {
+          if (this->devices[dev].changedRows & (1 << row)) {
+            changed = true;
+            this->devices[dev].changedRows &= ~(1 << row);
+          }
+        }
+        if (changed) {
+          this->spiBytes += 2 * this->deviceCount;
+        }
+      }
+    }
+
+    // Steps taken walking the font, and bytes sent to the chain
+    uint64_t fontReads = 0;
+    uint64_t spiBytes = 0;
+
+  protected:
+    struct Device {
+      uint8_t rows[ROW_SIZE];
+      uint8_t changedRows;
+    };
+
+    Device devices[MAX_DEVICES];
+    uint8_t deviceCount = 0;
+    bool autoUpdate = true;
+
+    static inline uint8_t font[2048];
+    static inline bool fontBuilt = false;
+
+    static uint8_t charWidth(int c) {
+      if (c == ' ') {
+        return 2;
+      }
+      if (c >= '0' && c <= '9') {
+        return 4;
+      }
+      if ((c >= 'A' && c <= 'Z') || c < ' ' || c >= 0x80) {
+        return 5;
+      }
+      if (c >= 'a' && c <= 'z') {
+        return 4;
+      }
+      return 3;
+    }
+
+    static void buildFont() {
+      if (fontBuilt) {
+        return;
+      }
+      size_t offset = 0;
+      for (int c = 0; c < 256; c++) {
+        const uint8_t width = charWidth(c);
+        font[offset++] = width;
+        for (uint8_t i = 0; i < width; i++) {
+          font[offset++] = static_cast<uint8_t>(c * 31 + i * 7 + 1);
+        }
+      }
+      fontBuilt = true;
+    }
+
+    uint32_t findChar(uint8_t c) {
+      uint32_t offset = 0;
+      for (uint16_t i = 0; i < c; i++) {
+        offset += font[offset] + 1;
+        this->fontReads++;
+      }
+      return offset;
+    }
+
+    void updateIfAuto() {
+      if (this->autoUpdate) {
+        this->update();
+      }
+    }
+};
+
+#endif // PICO2W_STOCK_TICKER_SHIM_MD_MAX72XX_H
@@ -0,0 +1,54 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_SHIM_STREAMUTILS_H
+#define PICO2W_STOCK_TICKER_SHIM_STREAMUTILS_H
+
+#include <Arduino.h>
+
+// The two StreamUtils classes the settings use with LOG_JSON_PARSED
+class ReadLoggingStream : public Stream {
+  public:
+    ReadLoggingStream(Stream& source, Print& log)
+        : source(source), log(log) {}
+
+    int available() override {
+      return this->source.available();
+    }
+    int read() override {
+      const int c = this->source.read();
+      if (c >= 0) {
+        this->log.write(static_cast<uint8_t>(c));
+      }
+      return c;
+    }
+    int peek() override {
+      return this->source.peek();
+    }
+    size_t write(uint8_t c) override {
+      return this->source.write(c);
+    }
+    using Print::write;
+
+  protected:
+    Stream& source;
+    Print& log;
+};
+
+class WriteLoggingStream : public Print {
+  public:
+    WriteLoggingStream(Print& target, Print& log) : target(target), log(log) {}
+
+    size_t write(uint8_t c) override {
+      this->log.write(c);
+      return this->target.write(c);
+    }
+    using Print::write;
+
+  protected:
+    Print& target;
+    Print& log;
+};
+
+#endif // PICO2W_STOCK_TICKER_SHIM_STREAMUTILS_H
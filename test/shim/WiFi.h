@@ -0,0 +1,27 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_SHIM_WIFI_H
+#define PICO2W_STOCK_TICKER_SHIM_WIFI_H
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+
+#define WL_IDLE_STATUS 0
+#define WL_CONNECTED 3
+#define WL_DISCONNECTED 6
+
+// Always connected unless a test says otherwise
+class HostWiFi {
+  public:
+    int status() {
+      return this->connectionStatus;
+    }
+
+    int connectionStatus = WL_CONNECTED;
+};
+
+inline HostWiFi WiFi;
+
+#endif // PICO2W_STOCK_TICKER_SHIM_WIFI_H
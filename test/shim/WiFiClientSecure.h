@@ -0,0 +1,49 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_SHIM_WIFICLIENTSECURE_H
+#define PICO2W_STOCK_TICKER_SHIM_WIFICLIENTSECURE_H
+
+#include <Arduino.h>
+
+// There's no network on the host: every connection fails. Tests give the
+// clients a ScriptedClient instead, see HttpKeepAliveClient::setClient().
+class WiFiClientSecure : public Client {
+  public:
+    int connect(IPAddress ip, uint16_t port) override {
+      return 0;
+    }
+    int connect(const char* host, uint16_t port) override {
+      return 0;
+    }
+    size_t write(uint8_t c) override {
+      return 0;
+    }
+    size_t write(const uint8_t* buffer, size_t size) override {
+      return 0;
+    }
+    using Print::write;
+    int available() override {
+      return 0;
+    }
+    int read() override {
+      return -1;
+    }
+    int read(uint8_t* buffer, size_t size) override {
+      return -1;
+    }
+    int peek() override {
+      return -1;
+    }
+    void stop() override {}
+    uint8_t connected() override {
+      return 0;
+    }
+    operator bool() override {
+      return false;
+    }
+    void setInsecure() {}
+};
+
+#endif // PICO2W_STOCK_TICKER_SHIM_WIFICLIENTSECURE_H
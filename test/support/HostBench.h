@@ -0,0 +1,96 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_HOSTBENCH_H
+#define PICO2W_STOCK_TICKER_HOSTBENCH_H
+
+#include <Arduino.h>
+#include <string>
+
+// Helpers for the native benchmarks. Every result is printed as one line,
+//  BENCH {"name":"...","symbols":32,"ns_per_op":1234.5,...}
+// so `pio test -e native -v | grep '^BENCH '` gives a JSON line per result.
+// Host timings only compare versions of the code on the same machine, they
+// aren't what the Pico takes.
+namespace HostBench {
+  // Symbol counts every benchmark is run at
+  const uint16_t SYMBOL_COUNTS[] = {1, 32, 64};
+
+  /**
+   * @brief One benchmark result, printed by print().
+   */
+  class Result {
+    public:
+      Result(const char* name, uint16_t symbols) {
+        this->json = "{\"name\":\"";
+        this->json += name;
+        this->json += "\",\"symbols\":" + std::to_string(symbols);
+      }
+
+      /**
+       * @brief Add a field to the result.
+       *
+       * @param key The name of the field.
+       * @param value The value.
+       * @return Result& This, to chain calls.
+       */
+      Result& add(const char* key, double value) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), ",\"%s\":%.6g", key, value);
+        this->json += buf;
+        return *this;
+      }
+
+      void print() const {
+        printf("BENCH %s}\n", this->json.c_str());
+        fflush(stdout);
+      }
+
+    protected:
+      std::string json;
+  };
+
+  /**
+   * @brief Time a piece of code, run until at least minNanos have passed
+   *  and at least minRuns times.
+   *
+   * @param run The code to time.
+   * @param minRuns The least number of runs.
+   * @param minNanos The least total time, in nanoseconds.
+   * @return double The average time of one run, in nanoseconds.
+   */
+  template <class F>
+  double nanosPerRun(F run, uint32_t minRuns = 10,
+                     uint64_t minNanos = 50000000) {
+    run(); // Warm up caches, and anything built on first use
+    uint32_t runs = 0;
+    const uint64_t start = HostShim::nanos();
+    uint64_t elapsed = 0;
+    while (runs < minRuns || elapsed < minNanos) {
+      run();
+      runs++;
+      elapsed = HostShim::nanos() - start;
+    }
+    return static_cast<double>(elapsed) / runs;
+  }
+
+  /**
+   * @brief Build a symbols setting with made up ids, "S0,S1,S2,...".
+   *
+   * @param count How many symbols.
+   * @return std::string
+   */
+  inline std::string symbolsString(uint16_t count) {
+    std::string symbols;
+    for (uint16_t i = 0; i < count; i++) {
+      if (i > 0) {
+        symbols += ',';
+      }
+      symbols += "S" + std::to_string(i);
+    }
+    return symbols;
+  }
+} // HostBench
+
+#endif // PICO2W_STOCK_TICKER_HOSTBENCH_H
@@ -0,0 +1,146 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_RECORDEDRESPONSES_H
+#define PICO2W_STOCK_TICKER_RECORDEDRESPONSES_H
+
+#include <Arduino.h>
+#include <string>
+
+#ifndef HOST_PROJECT_DIR
+#define HOST_PROJECT_DIR "."
+#endif
+
+// The responses in tools/recorded_responses, the same corpus
+// tools/mock_data_server.py serves, the messages tools/stream_replay.py
+// sends, and bodies with more symbols made from them for the benchmarks.
+namespace RecordedResponses {
+  /**
+   * @brief Read a file in tools.
+   *
+   * @param name The path, relative to tools.
+   * @return std::string The contents, empty if the file can't be read.
+   */
+  inline std::string readFile(const std::string& name) {
+    const std::string path = std::string(HOST_PROJECT_DIR) + "/tools/" + name;
+    std::string body;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+      return body;
+    }
+    char buf[1024];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+      body.append(buf, n);
+    }
+    fclose(file);
+    return body;
+  }
+
+  /**
+   * @brief Read one of the recorded responses.
+   *
+   * @param name The file name, ex. "snapshots.json".
+   * @return std::string The body, empty if the file can't be read.
+   */
+  inline std::string read(const char* name) {
+    return readFile(std::string("recorded_responses/") + name);
+  }
+
+  /**
+   * @brief Read the recorded stream messages tools/stream_replay.py sends,
+   *  one per line.
+   *
+   * @return std::string The messages, empty if the file can't be read.
+   */
+  inline std::string streamMessages() {
+    return readFile("recorded_trades.jsonl");
+  }
+
+  /**
+   * @brief Get the raw text of the value of a key, the first one found.
+   *  Enough for the recorded responses, which have no brackets in strings.
+   *
+   * @param json The document.
+   * @param key The key, ex. a symbol.
+   * @return std::string The value, ex. {...} or [...].
+   */
+  inline std::string valueOf(const std::string& json, const char* key) {
+    const std::string quoted = std::string("\"") + key + "\":";
+    const size_t start = json.find(quoted);
+    if (start == std::string::npos) {
+      return "";
+    }
+    const size_t valueStart = start + quoted.size();
+    int depth = 0;
+    size_t i = valueStart;
+    do {
+      if (json[i] == '{' || json[i] == '[') {
+        depth++;
+      } else if (json[i] == '}' || json[i] == ']') {
+        depth--;
+      }
+      i++;
+    } while (depth > 0 && i < json.size());
+    return json.substr(valueStart, i - valueStart);
+  }
+
+  /**
+   * @brief Build an object of count symbols, "S0", "S1", ..., all with the
+   *  same value.
+   *
+   * @param value The value of every symbol.
+   * @param count How many symbols.
+   * @return std::string
+   */
+  inline std::string repeatSymbols(const std::string& value, uint16_t count) {
+    std::string json = "{";
+    for (uint16_t i = 0; i < count; i++) {
+      if (i > 0) {
+        json += ',';
+      }
+      json += "\"S" + std::to_string(i) + "\":" + value;
+    }
+    return json + "}";
+  }
+
+  /**
+   * @brief A /v2/stocks/snapshots body for count made up symbols, each with
+   *  AAPL's recorded snapshot.
+   *
+   * @param count How many symbols.
+   * @return std::string
+   */
+  inline std::string snapshots(uint16_t count) {
+    return repeatSymbols(valueOf(read("snapshots.json"), "AAPL"), count);
+  }
+
+  /**
+   * @brief A /v2/stocks/trades/latest body for count made up symbols, each
+   *  with AAPL's recorded trade.
+   *
+   * @param count How many symbols.
+   * @return std::string
+   */
+  inline std::string latestTrades(uint16_t count) {
+    return "{\"trades\":" +
+           repeatSymbols(valueOf(read("latest_trades.json"), "AAPL"), count) +
+           "}";
+  }
+
+  /**
+   * @brief A /v2/stocks/bars body for count made up symbols, each with
+   *  AAPL's recorded bars.
+   *
+   * @param count How many symbols.
+   * @return std::string
+   */
+  inline std::string bars(uint16_t count) {
+    return "{\"bars\":" +
+           repeatSymbols(valueOf(read("bars.json"), "AAPL"), count) +
+           ",\"next_page_token\":null}";
+  }
+} // RecordedResponses
+
+#endif // PICO2W_STOCK_TICKER_RECORDEDRESPONSES_H
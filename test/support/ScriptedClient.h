@@ -0,0 +1,164 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_SCRIPTEDCLIENT_H
+#define PICO2W_STOCK_TICKER_SCRIPTEDCLIENT_H
+
+#include <Arduino.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+// A connection to a made up server, for giving to HttpKeepAliveClient and
+// WebSocketClient in tests. Every request head written to it (up to the
+// blank line) is answered right away with what respond returns, which then
+// comes back maxChunk bytes at a time.
+class ScriptedClient : public Client {
+  public:
+    // Gets a request head, returns the whole response to it
+    std::function<std::string(const std::string& request)> respond;
+    // Most bytes available() says there are at once
+    size_t maxChunk = SIZE_MAX;
+    // Make connect() fail
+    bool refuseConnections = false;
+    // Close the connection after each response, once it's read
+    bool closeAfterResponse = false;
+
+    uint32_t connectCount = 0;
+    // Every request head received, on any connection
+    std::vector<std::string> requests;
+    // Every byte written, on any connection
+    std::string sent;
+
+    /**
+     * @brief Close the connection from the server's side. What was already
+     *  sent can still be read, like with a real socket.
+     */
+    void closeFromServer() {
+      this->serverClosed = true;
+    }
+
+    /**
+     * @brief Send more to the client, without a request.
+     *
+     * @param data What to send.
+     */
+    void push(const std::string& data) {
+      this->rx += data;
+    }
+
+    int connect(IPAddress ip, uint16_t port) override {
+      return this->connect("", port);
+    }
+    int connect(const char* host, uint16_t port) override {
+      this->stop();
+      if (this->refuseConnections) {
+        return 0;
+      }
+      this->open = true;
+      this->serverClosed = false;
+      this->connectCount++;
+      return 1;
+    }
+
+    size_t write(uint8_t c) override {
+      return this->write(&c, 1);
+    }
+    size_t write(const uint8_t* buffer, size_t size) override {
+      if (!this->open || this->serverClosed) {
+        return 0;
+      }
+      this->sent.append(reinterpret_cast<const char*>(buffer), size);
+      this->pending.append(reinterpret_cast<const char*>(buffer), size);
+      size_t end;
+      while ((end = this->pending.find("\r\n\r\n")) != std::string::npos) {
+        const std::string request = this->pending.substr(0, end + 4);
+        this->pending.erase(0, end + 4);
+        this->requests.push_back(request);
+        if (this->respond) {
+          this->rx += this->respond(request);
+        }
+        if (this->closeAfterResponse) {
+          this->serverClosed = true;
+        }
+      }
+      return size;
+    }
+    using Print::write;
+
+    int available() override {
+      if (!this->open) {
+        return 0;
+      }
+      return min(this->rx.size() - this->rxPos, this->maxChunk);
+    }
+    int read() override {
+      uint8_t c;
+      return this->read(&c, 1) == 1 ? c : -1;
+    }
+    int read(uint8_t* buffer, size_t size) override {
+      const size_t n = min(size, static_cast<size_t>(this->available()));
+      if (n == 0) {
+        return -1;
+      }
+      memcpy(buffer, this->rx.data() + this->rxPos, n);
+      this->rxPos += n;
+      return n;
+    }
+    int peek() override {
+      return this->available() > 0
+               ? static_cast<uint8_t>(this->rx[this->rxPos])
+               : -1;
+    }
+    void stop() override {
+      this->open = false;
+      this->rx.clear();
+      this->rxPos = 0;
+      this->pending.clear();
+    }
+    // Like WiFiClient, still connected while there's something to read
+    uint8_t connected() override {
+      return this->open &&
+             (!this->serverClosed || this->rxPos < this->rx.size());
+    }
+    operator bool() override {
+      return this->open;
+    }
+
+  protected:
+    bool open = false;
+    bool serverClosed = false;
+    std::string pending;
+    std::string rx;
+    size_t rxPos = 0;
+};
+
+/**
+ * @brief Build an HTTP/1.1 response with a Content-Length.
+ *
+ * @param body The body.
+ * @param status The status code and reason.
+ * @param headers More headers, each ending in "\r\n".
+ * @return std::string
+ */
+inline std::string httpResponse(const std::string& body,
+                                const char* status = "200 OK",
+                                const std::string& headers = "") {
+  return std::string("HTTP/1.1 ") + status +
+         "\r\nContent-Type: application/json\r\nContent-Length: " +
+         std::to_string(body.size()) + "\r\n" + headers + "\r\n" + body;
+}
+
+/**
+ * @brief Get the path of a request, from its request line.
+ *
+ * @param request The request head.
+ * @return std::string
+ */
+inline std::string requestPath(const std::string& request) {
+  const size_t start = request.find(' ') + 1;
+  return request.substr(start, request.find(' ', start) - start);
+}
+
+#endif // PICO2W_STOCK_TICKER_SCRIPTEDCLIENT_H
@@ -0,0 +1,42 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#ifndef PICO2W_STOCK_TICKER_STRINGSTREAM_H
+#define PICO2W_STOCK_TICKER_STRINGSTREAM_H
+
+#include <Arduino.h>
+#include <string>
+
+// A Stream over a string, read from the start. What is written to it is
+// kept separately in written.
+class StringStream : public Stream {
+  public:
+    StringStream() = default;
+    explicit StringStream(const std::string& data) : data(data) {}
+
+    int available() override {
+      return this->data.size() - this->pos;
+    }
+    int read() override {
+      return this->pos < this->data.size()
+               ? static_cast<uint8_t>(this->data[this->pos++])
+               : -1;
+    }
+    int peek() override {
+      return this->pos < this->data.size()
+               ? static_cast<uint8_t>(this->data[this->pos])
+               : -1;
+    }
+    size_t write(uint8_t c) override {
+      this->written += static_cast<char>(c);
+      return 1;
+    }
+    using Print::write;
+
+    std::string data;
+    size_t pos = 0;
+    std::string written;
+};
+
+#endif // PICO2W_STOCK_TICKER_STRINGSTREAM_H
@@ -0,0 +1,474 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <FixedPoint.h>
+#include <HostBench.h>
+#include <MD_MAX72xx.h>
+#include <MD_MAX72xx_Text.h>
+#include <RecordedResponses.h>
+#include <ScriptedClient.h>
+#include <StockTicker.h>
+#include <SymbolIndex.h>
+#include <TickerSettings.h>
+#include <map>
+#include <unity.h>
+#include <vector>
+
+// The hot paths at 1, 32 and 64 symbols: parsing each endpoint's response,
+// looking up its symbols, formatting prices, rendering the display string,
+// the memory for the symbols, a whole fetch (up to 256 symbols, and sent as
+// is versus gzipped), a frame of scrolling and loading the settings. Run with
+//  pio test -e native -f test_benchmarks -v | grep '^BENCH '
+
+// Same chain as the default config.h, 4 modules of 4
+const uint8_t BENCH_DEVICES = 16;
+
+// Gives the benchmarks the parts of StockTicker in between fetching and
+// drawing
+class BenchTicker : public StockTicker::StockTicker {
+  public:
+    /**
+     * @brief Give every symbol a new price, as a snapshot response would.
+     *
+     * @param step Changes the prices, so they differ from the last call.
+     */
+    void setAllPrices(int64_t step) {
+      for (uint16_t i = 0; i < this->symbolCount; i++) {
+        const int64_t open = (100 + i) * ::StockTicker::FIXED_POINT_SCALE;
+        onSnapshot(this, this->symbolId(i), open, open + step * 1234 + i);
+      }
+      this->publishPrices();
+    }
+
+    /**
+     * @brief Give one symbol a new price.
+     *
+     * @param i The index of the symbol.
+     * @param step Changes the price, so it differs from the last call.
+     */
+    void setPrice(uint16_t i, int64_t step) {
+      const int64_t open = (100 + i) * ::StockTicker::FIXED_POINT_SCALE;
+      onSnapshot(this, this->symbolId(i), open, open + step * 1234);
+      this->publishPrices();
+    }
+
+    /**
+     * @brief Fetch the snapshots of every symbol, calling update() until
+     *  the fetch is done like the main loop would.
+     *
+     * @return uint32_t How many update() calls it took.
+     */
+    uint32_t fetchSnapshots() {
+      this->needsBars = false;
+      this->refreshOnNextUpdate();
+      uint32_t steps = 0;
+      do {
+        this->update();
+        steps++;
+      } while (this->fetchState != ::StockTicker::FetchState::IDLE);
+      return steps;
+    }
+
+    uint32_t getLongestStepTime() const {
+      return this->longestStepTime;
+    }
+};
+
+BenchTicker ticker;
+
+void setUp() {}
+
+void tearDown() {}
+
+// Counts the symbols a parser reports
+void countSnapshot(void* context, const char* id, int64_t openPrice,
+                   int64_t closePrice) {
+  (*static_cast<uint16_t*>(context))++;
+}
+
+void test_snapshot_parse() {
+  for (const uint16_t symbols : HostBench::SYMBOL_COUNTS) {
+    const std::string body = RecordedResponses::snapshots(symbols);
+    TEST_ASSERT_FALSE(body.empty());
+    uint16_t found = 0;
+    StockTicker::SnapshotParser parser(countSnapshot, &found);
+    const double ns = HostBench::nanosPerRun([&]() {
+      found = 0;
+      parser.reset();
+      parser.feed(body.data(), body.size());
+    });
+    TEST_ASSERT_EQUAL(StockTicker::JsonStreamStatus::DONE, parser.getStatus());
+    TEST_ASSERT_EQUAL(symbols, found);
+    HostBench::Result("snapshot_parse", symbols)
+      .add("ns_per_op", ns)
+      .add("bytes", body.size())
+      .add("ns_per_byte", ns / body.size())
+      .add("parser_bytes", sizeof(parser))
+      .print();
+  }
+}
+
+// Counts the symbols a parser reports
+void countLatestTrade(void* context, const char* id, int64_t price) {
+  (*static_cast<uint16_t*>(context))++;
+}
+
+// DataSource::LATEST_TRADES, to compare with test_snapshot_parse
+void test_latest_trades_parse() {
+  for (const uint16_t symbols : HostBench::SYMBOL_COUNTS) {
+    const std::string body = RecordedResponses::latestTrades(symbols);
+    TEST_ASSERT_FALSE(body.empty());
+    uint16_t found = 0;
+    StockTicker::LatestTradesParser parser(countLatestTrade, &found);
+    const double ns = HostBench::nanosPerRun([&]() {
+      found = 0;
+      parser.reset();
+      parser.feed(body.data(), body.size());
+    });
+    TEST_ASSERT_EQUAL(StockTicker::JsonStreamStatus::DONE, parser.getStatus());
+    TEST_ASSERT_EQUAL(symbols, found);
+    HostBench::Result("latest_trades_parse", symbols)
+      .add("ns_per_op", ns)
+      .add("bytes", body.size())
+      .add("ns_per_byte", ns / body.size())
+      .add("parser_bytes", sizeof(parser))
+      .print();
+  }
+}
+
+void test_price_format() {
+  // A symbol's price, change and percent, as the display string shows them
+  const int64_t values[] = {1234567, 23456, 19034};
+  char buf[24];
+  volatile size_t len = 0;
+  const double fixedNs = HostBench::nanosPerRun([&]() {
+    len += StockTicker::formatFixedPoint(values[0], 2, false, buf, sizeof(buf));
+    len += StockTicker::formatFixedPoint(values[1], 2, true, buf, sizeof(buf));
+    len += StockTicker::formatFixedPoint(values[2], 2, true, buf, sizeof(buf));
+  });
+  const float floats[] = {123.4567f, 2.3456f, 1.9034f};
+  const double printfNs = HostBench::nanosPerRun([&]() {
+    len += snprintf(buf, sizeof(buf), "%.2f", floats[0]);
+    len += snprintf(buf, sizeof(buf), "%+.2f", floats[1]);
+    len += snprintf(buf, sizeof(buf), "%+.2f%%", floats[2]);
+  });
+  HostBench::Result("price_format", 1)
+    .add("ns_per_op", fixedNs)
+    .add("printf_ns_per_op", printfNs)
+    .print();
+}
+
+// Slots of the symbol table before the index, scanned with strcmp
+const uint16_t SCAN_SLOTS = 64;
+const uint8_t SCAN_ID_LEN = 32;
+
+void test_symbol_lookup() {
+  for (const uint16_t symbols : HostBench::SYMBOL_COUNTS) {
+    std::vector<std::string> ids;
+    for (uint16_t i = 0; i < symbols; i++) {
+      ids.push_back("S" + std::to_string(i));
+    }
+    StockTicker::SymbolIndex index;
+    StockTicker::BlockCarver measure(nullptr);
+    index.begin(measure, symbols);
+    std::vector<uint8_t> storage(measure.size());
+    StockTicker::BlockCarver carver(storage.data());
+    index.begin(carver, symbols);
+    index.clear();
+    static char scanIds[SCAN_SLOTS][SCAN_ID_LEN];
+    memset(scanIds, 0, sizeof(scanIds));
+    for (uint16_t i = 0; i < symbols; i++) {
+      TEST_ASSERT_TRUE(index.insert(ids[i].c_str(), i));
+      strcpy(scanIds[i], ids[i].c_str());
+    }
+    for (uint16_t i = 0; i < symbols; i++) {
+      TEST_ASSERT_EQUAL(i, index.find(ids[i].c_str()));
+    }
+    TEST_ASSERT_EQUAL(-1, index.find("MISSING"));
+
+    // One response's worth of lookups, every symbol once
+    volatile int32_t found = 0;
+    const double indexNs = HostBench::nanosPerRun([&]() {
+      for (const std::string& id : ids) {
+        found += index.find(id.c_str());
+      }
+    });
+    const double scanNs = HostBench::nanosPerRun([&]() {
+      for (const std::string& id : ids) {
+        for (uint16_t slot = 0; slot < SCAN_SLOTS; slot++) {
+          if (strcmp(scanIds[slot], id.c_str()) == 0) {
+            found += slot;
+            break;
+          }
+        }
+      }
+    });
+    HostBench::Result("symbol_lookup", symbols)
+      .add("ns_per_op", indexNs)
+      .add("scan_ns_per_op", scanNs)
+      .add("ns_per_lookup", indexNs / symbols)
+      .print();
+  }
+}
+
+void test_display_render() {
+  for (const uint16_t symbols : HostBench::SYMBOL_COUNTS) {
+    const std::string symbolsString = HostBench::symbolsString(symbols);
+    ticker.begin("key", "secret", symbolsString.c_str());
+    int64_t step = 0;
+    uint64_t renderNanos = 0;
+    uint32_t renders = 0;
+    // Every symbol changed, as after a snapshot
+    while (renders < 2000) {
+      ticker.setAllPrices(++step);
+      const uint64_t start = HostShim::nanos();
+      TEST_ASSERT_TRUE(ticker.updateDisplay());
+      renderNanos += HostShim::nanos() - start;
+      renders++;
+    }
+    HostBench::Result("display_render_all", symbols)
+      .add("ns_per_op", static_cast<double>(renderNanos) / renders)
+      .add("bytes_rewritten", ticker.getLastRenderBytes())
+      .add("display_len", ticker.getDisplayStrLen())
+      .print();
+
+    // One symbol changed, as after a streamed trade
+    renderNanos = 0;
+    renders = 0;
+    while (renders < 2000) {
+      ticker.setPrice(renders % symbols, ++step);
+      const uint64_t start = HostShim::nanos();
+      TEST_ASSERT_TRUE(ticker.updateDisplay());
+      renderNanos += HostShim::nanos() - start;
+      renders++;
+    }
+    TEST_ASSERT_EQUAL(strlen(ticker.getDisplayStr()),
+                      ticker.getDisplayStrLen());
+    HostBench::Result("display_render_one", symbols)
+      .add("ns_per_op", static_cast<double>(renderNanos) / renders)
+      .add("bytes_rewritten", ticker.getLastRenderBytes())
+      .print();
+    ticker.end();
+  }
+}
+
+void test_symbol_storage() {
+  // Up to the most symbols the settings allow
+  for (const uint16_t symbols : {1, 32, 64, 128, 256}) {
+    const std::string symbolsString = HostBench::symbolsString(symbols);
+    ticker.begin("key", "secret", symbolsString.c_str());
+    ticker.setAllPrices(1);
+    TEST_ASSERT_TRUE(ticker.updateDisplay());
+    TEST_ASSERT_EQUAL(strlen(ticker.getDisplayStr()),
+                      ticker.getDisplayStrLen());
+    const uint32_t bytes =
+      Telemetry::metrics.get(Telemetry::MetricGauge::SYMBOL_STORAGE).last;
+    HostBench::Result("symbol_storage", symbols)
+      .add("bytes", bytes)
+      .add("bytes_per_symbol", static_cast<double>(bytes) / symbols)
+      .add("static_bytes", sizeof(StockTicker::StockTicker))
+      .print();
+    ticker.end();
+    TEST_ASSERT_EQUAL_STRING("", ticker.getDisplayStr());
+  }
+}
+
+/**
+ * @brief Answer a snapshots request with AAPL's recorded snapshot for each
+ *  symbol in it. Built once per batch, so timing the fetch doesn't time
+ *  this.
+ *
+ * @param request The request head.
+ * @return std::string
+ */
+std::string snapshotsResponse(const std::string& request) {
+  static std::map<std::string, std::string> responses;
+  // Ex. /v2/stocks/snapshots?symbols=S0,S1&feed=iex
+  const std::string path = requestPath(request);
+  std::string& response = responses[path];
+  if (response.empty()) {
+    const std::string value = RecordedResponses::valueOf(
+      RecordedResponses::read("snapshots.json"), "AAPL");
+    const size_t start = path.find("symbols=") + strlen("symbols=");
+    const std::string ids = path.substr(start, path.find('&', start) - start);
+    std::string body = "{";
+    size_t idStart = 0;
+    while (idStart < ids.size()) {
+      const size_t idEnd = min(ids.find(',', idStart), ids.size());
+      body += (idStart > 0 ? ",\"" : "\"") +
+              ids.substr(idStart, idEnd - idStart) + "\":" + value;
+      idStart = idEnd + 1;
+    }
+    response = httpResponse(body + "}");
+  }
+  return response;
+}
+
+// Kept for the rest of the benchmarks once given to the ticker
+ScriptedClient server;
+
+// A whole fetch through HttpKeepAliveClient, with the batches pipelined on
+// one connection, up to the most symbols the settings allow
+void test_fetch() {
+  for (const uint16_t symbols : {32, 128, 256}) {
+    server = ScriptedClient();
+    server.respond = snapshotsResponse;
+    // A TCP segment at a time
+    server.maxChunk = 1460;
+    const std::string symbolsString = HostBench::symbolsString(symbols);
+    ticker.setClients(&server, &server);
+    ticker.begin("key", "secret", symbolsString.c_str());
+    uint32_t steps = 0;
+    const double ns = HostBench::nanosPerRun(
+      [&]() {
+        steps = ticker.fetchSnapshots();
+      },
+      10, 0);
+    TEST_ASSERT_EQUAL(StockTicker::StockTickerStatus::OK, ticker.getStatus());
+    TEST_ASSERT_TRUE(ticker.updateDisplay());
+    TEST_ASSERT_NULL(strstr(ticker.getDisplayStr(), "No data yet"));
+    TEST_ASSERT_EQUAL(1, server.connectCount);
+    // Every fetch made the same requests, 11 fetches with the warm up
+    const size_t batches = server.requests.size() / 11;
+    size_t bytes = 0;
+    for (size_t i = 0; i < batches; i++) {
+      bytes += snapshotsResponse(server.requests[i]).size();
+    }
+    HostBench::Result("fetch", symbols)
+      .add("ns_per_op", ns)
+      .add("batches", batches)
+      .add("bytes", bytes)
+      .add("updates", steps)
+      .add("longest_update_us", ticker.getLongestStepTime())
+      .print();
+    ticker.end();
+  }
+}
+
+// The same fetch with the body sent as is and gzipped at level 6, like the
+// real server does, from tools/recorded_gzip. Compares the time, mostly
+// parsing versus inflating and parsing, and the bytes received with headers.
+void test_fetch_gzip() {
+  for (const uint16_t symbols : HostBench::SYMBOL_COUNTS) {
+    const std::string body = RecordedResponses::snapshots(symbols);
+    const std::string gzip = RecordedResponses::readFile(
+      "recorded_gzip/snapshots_" + std::to_string(symbols) + ".6.gz");
+    TEST_ASSERT_FALSE(gzip.empty());
+    const std::string symbolsString = HostBench::symbolsString(symbols);
+    HostBench::Result result("fetch_gzip", symbols);
+    for (const bool gzipped : {false, true}) {
+      const std::string response =
+        gzipped ? httpResponse(gzip, "200 OK", "Content-Encoding: gzip\r\n")
+                : httpResponse(body);
+      server = ScriptedClient();
+      server.respond = [&](const std::string& request) {
+        return response;
+      };
+      server.maxChunk = 1460;
+      ticker.setClients(&server, &server);
+      ticker.begin("key", "secret", symbolsString.c_str());
+      const uint32_t bytesBefore =
+        Telemetry::metrics.get(Telemetry::MetricCounter::BYTES_RECEIVED);
+      uint32_t fetches = 0;
+      const double ns = HostBench::nanosPerRun(
+        [&]() {
+          ticker.fetchSnapshots();
+          fetches++;
+        },
+        10, 0);
+      TEST_ASSERT_EQUAL(StockTicker::StockTickerStatus::OK,
+                        ticker.getStatus());
+      TEST_ASSERT_TRUE(ticker.updateDisplay());
+      TEST_ASSERT_NULL(strstr(ticker.getDisplayStr(), "No data yet"));
+      // One batch, so one response per fetch
+      TEST_ASSERT_EQUAL(fetches, server.requests.size());
+      const double bytes =
+        static_cast<double>(
+          Telemetry::metrics.get(Telemetry::MetricCounter::BYTES_RECEIVED) -
+          bytesBefore) /
+        fetches;
+      result.add(gzipped ? "gzip_ns_per_op" : "identity_ns_per_op", ns)
+        .add(gzipped ? "gzip_bytes" : "identity_bytes", bytes);
+      ticker.end();
+    }
+    result.print();
+  }
+}
+
+void test_scroll_frame() {
+  for (const uint16_t symbols : HostBench::SYMBOL_COUNTS) {
+    const std::string symbolsString = HostBench::symbolsString(symbols);
+    ticker.begin("key", "secret", symbolsString.c_str());
+    ticker.setAllPrices(1);
+    ticker.updateDisplay();
+
+    MD_MAX72XX display(MD_MAX72XX::FC16_HW, 0, BENCH_DEVICES);
+    display.control(MD_MAX72XX::UPDATE, MD_MAX72XX::OFF);
+    MD_MAX72XX_GlyphCache glyphs(&display);
+    MD_MAX72XX_Scrolling scrolling(&display, &glyphs);
+    scrolling.setColumnProvider(StockTicker::StockTicker::sparklineColumn,
+                                StockTicker::SPARKLINE_WIDTH, &ticker);
+    scrolling.setText(ticker.getDisplayStr());
+
+    // Scroll the whole text through once
+    const uint32_t frames =
+      ticker.getDisplayStrLen() * 6 + display.getColumnCount();
+    uint64_t frameNanos = 0;
+    uint64_t spiBytes = 0;
+    display.fontReads = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+      HostShim::advanceMillis(scrolling.periodBetweenShifts);
+      const uint64_t start = HostShim::nanos();
+      TEST_ASSERT_TRUE(scrolling.update());
+      frameNanos += HostShim::nanos() - start;
+      spiBytes += scrolling.getLastFrameSpiBytes();
+    }
+    HostBench::Result("scroll_frame", symbols)
+      .add("ns_per_op", static_cast<double>(frameNanos) / frames)
+      .add("spi_bytes_per_frame", static_cast<double>(spiBytes) / frames)
+      .add("font_reads", display.fontReads)
+      .add("frames", frames)
+      .print();
+    ticker.end();
+  }
+}
+
+void test_settings_load() {
+  for (const uint16_t symbols : HostBench::SYMBOL_COUNTS) {
+    const std::string symbolsString = HostBench::symbolsString(symbols);
+    Settings::TickerSettings settings;
+    strcpy(settings.apcaApiKeyId, "key");
+    strcpy(settings.apcaApiSecretKey, "secret");
+    strcpy(settings.symbols, symbolsString.c_str());
+    TEST_ASSERT_EQUAL(Settings::SaveToDiskResult::OK, settings.saveToDisk());
+
+    Settings::TickerSettings loaded;
+    const double ns = HostBench::nanosPerRun([&]() {
+      TEST_ASSERT_EQUAL(Settings::LoadFromDiskResult::OK,
+                        loaded.loadFromDisk());
+    });
+    TEST_ASSERT_EQUAL_STRING(symbolsString.c_str(), loaded.symbols);
+    HostBench::Result("settings_load", symbols)
+      .add("ns_per_op", ns)
+      .add("file_bytes", FatFS.files["ticker_settings.json"].size())
+      .add("arena_peak",
+           Telemetry::metrics.get(Telemetry::MetricGauge::JSON_ARENA_PEAK).last)
+      .print();
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_snapshot_parse);
+  RUN_TEST(test_latest_trades_parse);
+  RUN_TEST(test_price_format);
+  RUN_TEST(test_symbol_lookup);
+  RUN_TEST(test_display_render);
+  RUN_TEST(test_symbol_storage);
+  RUN_TEST(test_fetch);
+  RUN_TEST(test_fetch_gzip);
+  RUN_TEST(test_scroll_frame);
+  RUN_TEST(test_settings_load);
+  return UNITY_END();
+}
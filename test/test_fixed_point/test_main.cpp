@@ -0,0 +1,139 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <FixedPoint.h>
+#include <string>
+#include <unity.h>
+
+using StockTicker::formatFixedPoint;
+using StockTicker::parseFixedPoint;
+
+void setUp() {}
+
+void tearDown() {}
+
+/**
+ * @brief Parse text that should be a number.
+ *
+ * @param text The number.
+ * @return int64_t The value, in 1/FIXED_POINT_SCALE units.
+ */
+int64_t parse(const char* text) {
+  int64_t value = INT64_MIN;
+  TEST_ASSERT_TRUE_MESSAGE(parseFixedPoint(text, value), text);
+  return value;
+}
+
+std::string format(int64_t value, uint8_t decimals, bool showPlus = false) {
+  char buf[32];
+  const size_t len = formatFixedPoint(value, decimals, showPlus, buf,
+                                      sizeof(buf));
+  TEST_ASSERT_EQUAL(strlen(buf), len);
+  return buf;
+}
+
+void test_parse_plain_numbers() {
+  TEST_ASSERT_EQUAL_INT64(0, parse("0"));
+  TEST_ASSERT_EQUAL_INT64(0, parse("-0.0"));
+  TEST_ASSERT_EQUAL_INT64(1234500, parse("123.45"));
+  TEST_ASSERT_EQUAL_INT64(-1234500, parse("-123.45"));
+  TEST_ASSERT_EQUAL_INT64(1500000, parse("1.5e2"));
+  TEST_ASSERT_EQUAL_INT64(15, parse("15E-4"));
+  TEST_ASSERT_EQUAL_INT64(50000, parse("5."));
+  // Exact past what a float holds
+  TEST_ASSERT_EQUAL_INT64(1234567890123456789, parse("123456789012345.6789"));
+  TEST_ASSERT_EQUAL_INT64(INT64_MAX, parse("922337203685477.5807"));
+}
+
+void test_parse_rounds_half_away_from_zero() {
+  TEST_ASSERT_EQUAL_INT64(1, parse("0.00005"));
+  TEST_ASSERT_EQUAL_INT64(-1, parse("-0.00005"));
+  TEST_ASSERT_EQUAL_INT64(0, parse("0.0000499999999999999999999"));
+  TEST_ASSERT_EQUAL_INT64(123460, parse("12.345950"));
+  TEST_ASSERT_EQUAL_INT64(-123459, parse("-12.345949"));
+  TEST_ASSERT_EQUAL_INT64(1, parse("5000000000000000000e-23"));
+  TEST_ASSERT_EQUAL_INT64(0, parse("4999999999999999999e-23"));
+  TEST_ASSERT_EQUAL_INT64(0, parse("1e-400"));
+}
+
+void test_parse_rounds_digits_past_the_mantissa() {
+  // More significant digits than fit, the ones cut off still round
+  TEST_ASSERT_EQUAL_INT64(2586736235636800955,
+                          parse("258673623563680.09550"));
+  TEST_ASSERT_EQUAL_INT64(-4146649317072649095,
+                          parse("-414664931707264.9095459"));
+  TEST_ASSERT_EQUAL_INT64(6338361298073700010,
+                          parse("633836129807370.000999940099"));
+  TEST_ASSERT_EQUAL_INT64(1314343171127000004,
+                          parse("131434317112700.000449495459504909"));
+}
+
+void test_parse_rejects() {
+  int64_t value = 7;
+  TEST_ASSERT_FALSE(parseFixedPoint("", value));
+  TEST_ASSERT_FALSE(parseFixedPoint("-", value));
+  TEST_ASSERT_FALSE(parseFixedPoint("abc", value));
+  TEST_ASSERT_FALSE(parseFixedPoint("1.2.3", value));
+  TEST_ASSERT_FALSE(parseFixedPoint("1e", value));
+  TEST_ASSERT_FALSE(parseFixedPoint("12 ", value));
+  TEST_ASSERT_FALSE(parseFixedPoint("922337203685477.58075", value));
+  TEST_ASSERT_FALSE(parseFixedPoint("1e400", value));
+  TEST_ASSERT_EQUAL_INT64(7, value);
+}
+
+void test_percent() {
+  TEST_ASSERT_EQUAL_INT64(0, StockTicker::fixedPointPercent(5, 0));
+  TEST_ASSERT_EQUAL_INT64(
+    25000, StockTicker::fixedPointPercent(parse("2.5"), parse("100")));
+  TEST_ASSERT_EQUAL_INT64(
+    -333333, StockTicker::fixedPointPercent(parse("-1"), parse("3")));
+  TEST_ASSERT_EQUAL_INT64(
+    666667, StockTicker::fixedPointPercent(parse("2"), parse("3")));
+}
+
+void test_format() {
+  TEST_ASSERT_EQUAL_STRING("0.00", format(0, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING("+0.00", format(0, 2, true).c_str());
+  TEST_ASSERT_EQUAL_STRING("123.45", format(1234500, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING("123.46", format(1234550, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING("-123.46", format(-1234550, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING("+0.01", format(50, 2, true).c_str());
+  TEST_ASSERT_EQUAL_STRING("-0.0050", format(-50, 4).c_str());
+  TEST_ASSERT_EQUAL_STRING("124", format(1235000, 0).c_str());
+  TEST_ASSERT_EQUAL_STRING("922337203685477.5807",
+                           format(INT64_MAX, 4).c_str());
+  TEST_ASSERT_EQUAL_STRING("-922337203685477.5808",
+                           format(INT64_MIN, 4).c_str());
+}
+
+void test_format_truncates_to_buffer() {
+  char buf[5];
+  TEST_ASSERT_EQUAL(4, formatFixedPoint(1234500, 2, true, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("+123", buf);
+  TEST_ASSERT_EQUAL(0, formatFixedPoint(1234500, 2, true, buf, 1));
+  TEST_ASSERT_EQUAL_STRING("", buf);
+}
+
+void test_format_matches_printf() {
+  char expected[32];
+  for (int64_t value = -200000; value <= 200000; value += 7) {
+    // Nothing to round at all 4 decimals, so binary doubles can't differ
+    snprintf(expected, sizeof(expected), "%+.4f",
+             static_cast<double>(value) / StockTicker::FIXED_POINT_SCALE);
+    TEST_ASSERT_EQUAL_STRING(expected, format(value, 4, true).c_str());
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_plain_numbers);
+  RUN_TEST(test_parse_rounds_half_away_from_zero);
+  RUN_TEST(test_parse_rounds_digits_past_the_mantissa);
+  RUN_TEST(test_parse_rejects);
+  RUN_TEST(test_percent);
+  RUN_TEST(test_format);
+  RUN_TEST(test_format_truncates_to_buffer);
+  RUN_TEST(test_format_matches_printf);
+  return UNITY_END();
+}
@@ -0,0 +1,184 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <GzipInflater.h>
+#include <RecordedResponses.h>
+#include <StringStream.h>
+#include <string>
+#include <unity.h>
+
+using StockTicker::GzipInflater;
+using StockTicker::InflateStatus;
+
+// The fixtures in tools/recorded_gzip, see tools/make_gzip_fixtures.py
+const uint8_t LEVELS[] = {1, 6, 9};
+const uint16_t FAR_LEN = 32500;
+const uint8_t BLOCK_FIXED = 1;
+const uint8_t BLOCK_DYNAMIC = 2;
+
+// A Stream over a string that only lets through what has arrived so far,
+// like the body of a response coming in over WiFi
+class TrickleStream : public StringStream {
+  public:
+    explicit TrickleStream(const std::string& data) : StringStream(data) {}
+
+    int available() override {
+      return this->arrived - this->pos;
+    }
+    int read() override {
+      return this->pos < this->arrived ? StringStream::read() : -1;
+    }
+    int peek() override {
+      return this->pos < this->arrived ? StringStream::peek() : -1;
+    }
+
+    size_t arrived = 0;
+};
+
+// Too big for the stack with the window
+GzipInflater inflater;
+
+void setUp() {}
+
+void tearDown() {}
+
+/**
+ * @brief Decompress a gzip stream given a few bytes at a time, reading
+ *  everything that can be decompressed after each.
+ *
+ * @param gzip The gzip stream.
+ * @param chunk How many bytes arrive at a time.
+ * @param status Set to how the inflater ended up.
+ * @return std::string What was decompressed.
+ */
+std::string inflate(const std::string& gzip, size_t chunk,
+                    InflateStatus& status) {
+  TrickleStream source(gzip);
+  inflater.begin(&source);
+  std::string out;
+  do {
+    source.arrived = min(source.arrived + chunk, gzip.size());
+    int c;
+    while ((c = inflater.read()) >= 0) {
+      out += static_cast<char>(c);
+    }
+  } while (inflater.getStatus() == InflateStatus::IN_PROGRESS &&
+           source.arrived < gzip.size());
+  status = inflater.getStatus();
+  return out;
+}
+
+/**
+ * @brief Read a fixture compressed at one level.
+ *
+ * @param name The body, ex. "snapshots".
+ * @param level The compression level.
+ * @return std::string The gzip stream.
+ */
+std::string readFixture(const char* name, uint8_t level) {
+  return RecordedResponses::readFile(std::string("recorded_gzip/") + name +
+                                     "." + std::to_string(level) + ".gz");
+}
+
+/**
+ * @brief Check a fixture decompresses to its body at every level, whether
+ *  it arrives 1 byte, 7 bytes or all of it at a time.
+ *
+ * @param name The body, ex. "snapshots".
+ * @param body What it should decompress to.
+ * @param blockType The type of its first block, so the fixture still
+ *  covers what it's meant to.
+ */
+void assertInflates(const char* name, const std::string& body,
+                    uint8_t blockType) {
+  for (const uint8_t level : LEVELS) {
+    const std::string gzip = readFixture(name, level);
+    TEST_ASSERT_FALSE(gzip.empty());
+    // The 3 bits after the 10 byte header, BFINAL then BTYPE
+    TEST_ASSERT_EQUAL(blockType, (static_cast<uint8_t>(gzip[10]) >> 1) & 3);
+    for (const size_t chunk : {static_cast<size_t>(1), static_cast<size_t>(7),
+                               gzip.size()}) {
+      const std::string message = std::string(name) + " level " +
+                                  std::to_string(level) + ", " +
+                                  std::to_string(chunk) + " bytes at a time";
+      InflateStatus status;
+      const std::string out = inflate(gzip, chunk, status);
+      TEST_ASSERT_EQUAL_MESSAGE(InflateStatus::DONE, status, message.c_str());
+      TEST_ASSERT_EQUAL_MESSAGE(body.size(), out.size(), message.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(body == out, message.c_str());
+    }
+  }
+}
+
+/**
+ * @brief Pseudo-random lowercase letters from the C library's old rand(),
+ *  the same as tools/make_gzip_fixtures.py makes.
+ *
+ * @param count How many.
+ * @return std::string
+ */
+std::string letters(size_t count) {
+  std::string out;
+  uint32_t x = 1;
+  for (size_t i = 0; i < count; i++) {
+    x = (x * 1103515245 + 12345) & 0x7FFFFFFF;
+    out += static_cast<char>('a' + (x >> 16) % 26);
+  }
+  return out;
+}
+
+void test_fixed_huffman() {
+  assertInflates("short", "{\"trades\":{\"AAPL\":null,\"MSFT\":null,"
+                          "\"GOOG\":null}}",
+                 BLOCK_FIXED);
+}
+
+void test_dynamic_huffman() {
+  assertInflates("snapshots", RecordedResponses::read("snapshots.json"),
+                 BLOCK_DYNAMIC);
+}
+
+void test_copies_longer_than_a_chunk() {
+  // Mostly copies of up to 258 bytes, each from a few bits
+  assertInflates("snapshots_64", RecordedResponses::snapshots(64),
+                 BLOCK_DYNAMIC);
+}
+
+void test_copies_from_far_back() {
+  // The second half is copied from FAR_LEN bytes back, through the window
+  // wrapping around
+  const std::string far = letters(FAR_LEN);
+  assertInflates("far", far + far, BLOCK_DYNAMIC);
+}
+
+void test_trailer_is_checked() {
+  const std::string gzip = readFixture("far", 6);
+  const std::string body = letters(FAR_LEN) + letters(FAR_LEN);
+  // The CRC-32, then the size
+  for (const size_t corruptAt : {gzip.size() - 8, gzip.size() - 4}) {
+    std::string corrupt = gzip;
+    corrupt[corruptAt] ^= 1;
+    for (const size_t chunk : {static_cast<size_t>(7), gzip.size()}) {
+      InflateStatus status;
+      // Everything is still decompressed, it just can't be trusted
+      TEST_ASSERT_TRUE(inflate(corrupt, chunk, status) == body);
+      TEST_ASSERT_EQUAL(InflateStatus::ERROR, status);
+    }
+  }
+  // Cut off before the trailer
+  InflateStatus status;
+  TEST_ASSERT_TRUE(inflate(gzip.substr(0, gzip.size() - 8), 7, status) ==
+                   body);
+  TEST_ASSERT_EQUAL(InflateStatus::IN_PROGRESS, status);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fixed_huffman);
+  RUN_TEST(test_dynamic_huffman);
+  RUN_TEST(test_copies_longer_than_a_chunk);
+  RUN_TEST(test_copies_from_far_back);
+  RUN_TEST(test_trailer_is_checked);
+  return UNITY_END();
+}
@@ -0,0 +1,252 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <HttpKeepAliveClient.h>
+#include <ScriptedClient.h>
+#include <string>
+#include <unity.h>
+
+using StockTicker::HttpKeepAliveClient;
+using StockTicker::HttpRequestState;
+
+// Enough polls for any response in these tests, so a stuck client fails
+// instead of hanging
+const uint32_t MAX_POLLS = 100000;
+
+ScriptedClient server;
+HttpKeepAliveClient http;
+
+void setUp() {
+  server = ScriptedClient();
+  server.respond = [](const std::string& request) {
+    return httpResponse("{\"path\":\"" + requestPath(request) + "\"}");
+  };
+  http = HttpKeepAliveClient();
+  http.setClient(&server);
+  TEST_ASSERT_TRUE(http.begin("data.example", 443, "/first", "X-Key: k\r\n"));
+}
+
+void tearDown() {}
+
+/**
+ * @brief Poll until the body can be read, read all of it, then finish the
+ *  response.
+ *
+ * @return std::string The body, or "error <code>" if the request failed, in
+ *  which case it's cancelled like StockTicker does.
+ */
+std::string readResponse() {
+  std::string body;
+  for (uint32_t i = 0; i < MAX_POLLS; i++) {
+    const HttpRequestState state = http.poll();
+    if (state == HttpRequestState::ERROR) {
+      const std::string error =
+        "error " + std::to_string(http.getStatusCode());
+      http.cancel();
+      return error;
+    }
+    if (state != HttpRequestState::READING_BODY) {
+      continue;
+    }
+    int c;
+    while ((c = http.read()) >= 0) {
+      body += static_cast<char>(c);
+    }
+    if (http.bodyComplete()) {
+      http.finishResponse();
+      return body;
+    }
+  }
+  TEST_FAIL_MESSAGE("Response never finished");
+  return body;
+}
+
+/**
+ * @brief Poll until the client is back to IDLE, or the next pipelined
+ *  response can be read.
+ */
+void finish() {
+  for (uint32_t i = 0; i < MAX_POLLS; i++) {
+    const HttpRequestState state = http.poll();
+    if (state == HttpRequestState::IDLE ||
+        state == HttpRequestState::READING_HEAD ||
+        state == HttpRequestState::READING_BODY) {
+      return;
+    }
+  }
+  TEST_FAIL_MESSAGE("Response never finished");
+}
+
+std::string get() {
+  http.startGet();
+  const std::string body = readResponse();
+  finish();
+  return body;
+}
+
+void test_request_is_prebuilt() {
+  TEST_ASSERT_EQUAL_STRING("{\"path\":\"/first\"}", get().c_str());
+  TEST_ASSERT_EQUAL(1, server.requests.size());
+  TEST_ASSERT_EQUAL_STRING("GET /first HTTP/1.1\r\n"
+                           "Host: data.example\r\n"
+                           "Connection: keep-alive\r\n"
+                           "X-Key: k\r\n"
+                           "\r\n",
+                           server.requests[0].c_str());
+  TEST_ASSERT_TRUE(http.setPath("/second?a=1"));
+  get();
+  TEST_ASSERT_EQUAL_STRING("GET /second?a=1 HTTP/1.1\r\n"
+                           "Host: data.example\r\n"
+                           "Connection: keep-alive\r\n"
+                           "X-Key: k\r\n"
+                           "\r\n",
+                           server.requests[1].c_str());
+}
+
+void test_connection_is_reused() {
+  for (int i = 0; i < 10; i++) {
+    TEST_ASSERT_EQUAL_STRING("{\"path\":\"/first\"}", get().c_str());
+    TEST_ASSERT_EQUAL(200, http.getStatusCode());
+    TEST_ASSERT_EQUAL(i > 0, http.lastRequestReusedConnection());
+  }
+  TEST_ASSERT_EQUAL(10, server.requests.size());
+  TEST_ASSERT_EQUAL(1, server.connectCount);
+}
+
+void test_reconnects_when_server_closes() {
+  server.respond = [](const std::string& request) {
+    return httpResponse("{}", "200 OK", "Connection: close\r\n");
+  };
+  TEST_ASSERT_EQUAL_STRING("{}", get().c_str());
+  TEST_ASSERT_EQUAL_STRING("{}", get().c_str());
+  TEST_ASSERT_FALSE(http.lastRequestReusedConnection());
+  TEST_ASSERT_EQUAL(2, server.connectCount);
+}
+
+void test_reconnects_after_idle_close() {
+  get();
+  // Ex. the server's keep-alive timeout ran out between polls
+  server.closeFromServer();
+  TEST_ASSERT_EQUAL_STRING("{\"path\":\"/first\"}", get().c_str());
+  TEST_ASSERT_EQUAL(2, server.connectCount);
+}
+
+void test_unread_body_is_skipped() {
+  server.respond = [](const std::string& request) {
+    return httpResponse(std::string(5000, 'x') + requestPath(request));
+  };
+  http.startGet();
+  while (http.poll() != HttpRequestState::READING_BODY) {
+  }
+  // Stop early, the next response must still start in the right place
+  http.finishResponse();
+  finish();
+  TEST_ASSERT_TRUE(http.setPath("/next"));
+  const std::string body = get();
+  TEST_ASSERT_EQUAL_STRING("/next", body.substr(5000).c_str());
+  TEST_ASSERT_EQUAL(1, server.connectCount);
+}
+
+void test_chunked_body_trickled() {
+  server.maxChunk = 1;
+  server.respond = [](const std::string& request) {
+    return std::string("HTTP/1.1 200 OK\r\n"
+                       "Transfer-Encoding: chunked\r\n\r\n"
+                       "5;ext=1\r\nhello\r\n"
+                       "1A\r\n abcdefghijklmnopqrstuvwxy\r\n"
+                       "0\r\nTrailer: x\r\n\r\n");
+  };
+  TEST_ASSERT_EQUAL_STRING("hello abcdefghijklmnopqrstuvwxy", get().c_str());
+  TEST_ASSERT_EQUAL_STRING("hello abcdefghijklmnopqrstuvwxy", get().c_str());
+  TEST_ASSERT_EQUAL(1, server.connectCount);
+}
+
+void test_body_until_close() {
+  server.respond = [](const std::string& request) {
+    return std::string("HTTP/1.0 200 OK\r\n\r\nuntil close");
+  };
+  server.closeAfterResponse = true;
+  TEST_ASSERT_EQUAL_STRING("until close", get().c_str());
+}
+
+void test_pipelined_responses_in_order() {
+  http.startGet();
+  while (http.poll() != HttpRequestState::READING_BODY) {
+  }
+  TEST_ASSERT_TRUE(http.canQueueGet());
+  TEST_ASSERT_TRUE(http.queueGet("/second"));
+  TEST_ASSERT_TRUE(http.queueGet("/third"));
+  TEST_ASSERT_EQUAL(2, http.getPendingResponses());
+  TEST_ASSERT_EQUAL_STRING("{\"path\":\"/first\"}", readResponse().c_str());
+  finish();
+  TEST_ASSERT_EQUAL_STRING("{\"path\":\"/second\"}", readResponse().c_str());
+  finish();
+  TEST_ASSERT_EQUAL_STRING("{\"path\":\"/third\"}", readResponse().c_str());
+  finish();
+  TEST_ASSERT_EQUAL(HttpRequestState::IDLE, http.getState());
+  TEST_ASSERT_EQUAL(1, server.connectCount);
+}
+
+void test_rate_limit_headers() {
+  server.respond = [](const std::string& request) {
+    return httpResponse("{}", "429 Too Many Requests",
+                        "Date: Tue, 08 Jul 2025 15:59:50 GMT\r\n"
+                        "Retry-After: Tue, 08 Jul 2025 16:00:20 GMT\r\n"
+                        "X-RateLimit-Remaining: 0\r\n"
+                        "X-RateLimit-Reset: 1751990420\r\n");
+  };
+  get();
+  TEST_ASSERT_EQUAL(429, http.getStatusCode());
+  TEST_ASSERT_EQUAL(30, http.getRateLimitInfo().retryAfter);
+  TEST_ASSERT_EQUAL(0, http.getRateLimitInfo().remaining);
+  TEST_ASSERT_EQUAL_UINT32(1751990420, http.getRateLimitInfo().reset);
+  TEST_ASSERT_EQUAL_UINT32(1751990390, http.getRateLimitInfo().date);
+}
+
+void test_timeout_across_millis_wrap() {
+  // Never answers
+  server.respond = [](const std::string& request) { return std::string(); };
+  HostShim::millisNow = UINT32_MAX - 100;
+  http.startGet();
+  while (http.poll() != HttpRequestState::READING_HEAD) {
+  }
+  // The deadline is past the wrap, millis() isn't yet
+  HostShim::advanceMillis(50);
+  TEST_ASSERT_EQUAL(HttpRequestState::READING_HEAD, http.poll());
+  // Both past the wrap
+  HostShim::advanceMillis(http.responseTimeout - 100);
+  TEST_ASSERT_EQUAL(HttpRequestState::READING_HEAD, http.poll());
+  HostShim::advanceMillis(100);
+  TEST_ASSERT_EQUAL(HttpRequestState::ERROR, http.poll());
+  TEST_ASSERT_EQUAL(StockTicker::HTTP_ERROR_READ_TIMEOUT, http.getStatusCode());
+}
+
+void test_connection_refused() {
+  server.refuseConnections = true;
+  TEST_ASSERT_EQUAL_STRING("error -1", get().c_str());
+}
+
+void test_bad_response() {
+  server.respond = [](const std::string& request) {
+    return std::string("garbage\r\n\r\n");
+  };
+  TEST_ASSERT_EQUAL_STRING("error -5", get().c_str());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_request_is_prebuilt);
+  RUN_TEST(test_connection_is_reused);
+  RUN_TEST(test_reconnects_when_server_closes);
+  RUN_TEST(test_reconnects_after_idle_close);
+  RUN_TEST(test_unread_body_is_skipped);
+  RUN_TEST(test_chunked_body_trickled);
+  RUN_TEST(test_body_until_close);
+  RUN_TEST(test_pipelined_responses_in_order);
+  RUN_TEST(test_rate_limit_headers);
+  RUN_TEST(test_timeout_across_millis_wrap);
+  RUN_TEST(test_connection_refused);
+  RUN_TEST(test_bad_response);
+  return UNITY_END();
+}
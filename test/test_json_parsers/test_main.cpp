@@ -0,0 +1,269 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <BarsParser.h>
+#include <JsonStreamTokenizer.h>
+#include <LatestTradesParser.h>
+#include <RecordedResponses.h>
+#include <SnapshotParser.h>
+#include <StringStream.h>
+#include <TradeStreamParser.h>
+#include <map>
+#include <string>
+#include <unity.h>
+
+using StockTicker::JsonStreamStatus;
+
+// Writes every event down, so the tokenizer's view of a document can be
+// compared with what it should be
+class RecordingTokenizer : public StockTicker::JsonStreamTokenizer {
+  public:
+    std::string events;
+
+  protected:
+    void onContainerStart(uint8_t depth, const char* key,
+                          bool isArray) override {
+      this->events += std::to_string(depth) + (key ? key : "") +
+                      (isArray ? "[ " : "{ ");
+    }
+    void onContainerEnd(uint8_t depth, bool isArray) override {
+      this->events += std::to_string(depth) + (isArray ? "] " : "} ");
+    }
+    void onValue(uint8_t depth, const char* key,
+                 StockTicker::JsonValueType type, const char* text) override {
+      this->events += std::to_string(depth) + (key ? key : "") + "=" + text;
+      if (this->keyTruncated()) {
+        this->events += "(key cut)";
+      }
+      if (this->valueTruncated()) {
+        this->events += "(value cut)";
+      }
+      this->events += " ";
+    }
+};
+
+// What the parsers reported, by symbol
+std::map<std::string, int64_t> opens;
+std::map<std::string, int64_t> prices;
+std::map<std::string, int> barCounts;
+std::string controls;
+
+void onSnapshot(void* context, const char* id, int64_t openPrice,
+                int64_t closePrice) {
+  opens[id] = openPrice;
+  prices[id] = closePrice;
+}
+
+void onPrice(void* context, const char* id, int64_t price) {
+  prices[id] = price;
+}
+
+void onBar(void* context, const char* id, int64_t closePrice) {
+  prices[id] = closePrice;
+  barCounts[id]++;
+}
+
+void onControl(void* context, const char* type, const char* msg,
+               int32_t code) {
+  controls += std::string(type) + ":" + msg + ":" + std::to_string(code) + " ";
+}
+
+void setUp() {
+  opens.clear();
+  prices.clear();
+  barCounts.clear();
+  controls.clear();
+}
+
+void tearDown() {}
+
+/**
+ * @brief Feed a document one character at a time, as it arrives from the
+ *  network, and check the tokenizer stops right at its end.
+ */
+JsonStreamStatus feedByChar(StockTicker::JsonStreamTokenizer& parser,
+                            const std::string& json) {
+  parser.reset();
+  for (const char c : json) {
+    if (parser.feed(c) != JsonStreamStatus::IN_PROGRESS) {
+      break;
+    }
+  }
+  return parser.getStatus();
+}
+
+void test_tokenizer_events() {
+  RecordingTokenizer tokenizer;
+  TEST_ASSERT_EQUAL(
+    JsonStreamStatus::DONE,
+    feedByChar(tokenizer, " {\"a\": [1, -2.5e3, true, null, \"x\\\"y\"],"
+                          " \"b\": {\"c\": false}, \"d\": []} "));
+  TEST_ASSERT_EQUAL_STRING("1{ 2a[ 2=1 2=-2.5e3 2=true 2=null 2=x\"y 2] "
+                           "2b{ 2c=false 2} 2d[ 2] 1} ",
+                           tokenizer.events.c_str());
+}
+
+void test_tokenizer_root_scalars() {
+  RecordingTokenizer tokenizer;
+  // A number only ends at the character after it
+  tokenizer.reset();
+  TEST_ASSERT_EQUAL(JsonStreamStatus::IN_PROGRESS, tokenizer.feed("12", 2));
+  TEST_ASSERT_EQUAL(JsonStreamStatus::DONE, tokenizer.feed(" ", 1));
+  TEST_ASSERT_EQUAL(JsonStreamStatus::DONE, feedByChar(tokenizer, "\"s\""));
+  TEST_ASSERT_EQUAL(JsonStreamStatus::DONE, feedByChar(tokenizer, "{}"));
+  TEST_ASSERT_EQUAL(JsonStreamStatus::DONE, feedByChar(tokenizer, "[]"));
+}
+
+void test_tokenizer_errors() {
+  RecordingTokenizer tokenizer;
+  TEST_ASSERT_EQUAL(JsonStreamStatus::ERROR_INVALID_INPUT,
+                    feedByChar(tokenizer, "{\"a\" 1}"));
+  TEST_ASSERT_EQUAL(JsonStreamStatus::ERROR_INVALID_INPUT,
+                    feedByChar(tokenizer, "{\"a\": 1]"));
+  TEST_ASSERT_EQUAL(JsonStreamStatus::ERROR_INVALID_INPUT,
+                    feedByChar(tokenizer, "[1,,2]"));
+  TEST_ASSERT_EQUAL(JsonStreamStatus::ERROR_INVALID_INPUT,
+                    feedByChar(tokenizer, "[nope]"));
+  TEST_ASSERT_EQUAL(JsonStreamStatus::ERROR_INVALID_INPUT,
+                    feedByChar(tokenizer, "{1: 2}"));
+  TEST_ASSERT_EQUAL(
+    JsonStreamStatus::ERROR_TOO_DEEP,
+    feedByChar(tokenizer,
+               std::string(StockTicker::JSON_MAX_DEPTH + 1, '[')));
+  TEST_ASSERT_EQUAL(
+    JsonStreamStatus::IN_PROGRESS,
+    feedByChar(tokenizer, std::string(StockTicker::JSON_MAX_DEPTH, '[')));
+
+  // parse() stops at the end of the stream, and right after the document
+  StringStream cut("{\"a\": [1, 2");
+  TEST_ASSERT_EQUAL(JsonStreamStatus::ERROR_INCOMPLETE_INPUT,
+                    tokenizer.parse(cut));
+  StringStream twice("{\"a\": 1}{\"b\": 2}");
+  TEST_ASSERT_EQUAL(JsonStreamStatus::DONE, tokenizer.parse(twice));
+  TEST_ASSERT_EQUAL('{', twice.peek());
+}
+
+void test_tokenizer_truncation_is_reported() {
+  const std::string longText(40, 'x');
+  RecordingTokenizer tokenizer;
+  TEST_ASSERT_EQUAL(JsonStreamStatus::DONE,
+                    feedByChar(tokenizer, "{\"" + longText + "\": \"" +
+                                            longText + "\", \"k\": 1}"));
+  const std::string cut(StockTicker::JSON_TOKEN_MAX_LEN - 1, 'x');
+  TEST_ASSERT_EQUAL_STRING(
+    ("1{ 1" + cut + "=" + cut + "(key cut)(value cut) 1k=1 1} ").c_str(),
+    tokenizer.events.c_str());
+}
+
+void test_snapshots_recorded_response() {
+  const std::string body = RecordedResponses::read("snapshots.json");
+  TEST_ASSERT_FALSE(body.empty());
+  StockTicker::SnapshotParser parser(onSnapshot, nullptr);
+  TEST_ASSERT_EQUAL(JsonStreamStatus::DONE, feedByChar(parser, body));
+  TEST_ASSERT_EQUAL(8, prices.size());
+  TEST_ASSERT_EQUAL_INT64(2261000, opens["AAPL"]);
+  TEST_ASSERT_EQUAL_INT64(2274800, prices["AAPL"]);
+  TEST_ASSERT_EQUAL_INT64(4966200, opens["MSFT"]);
+  TEST_ASSERT_EQUAL_INT64(4977200, prices["MSFT"]);
+  TEST_ASSERT_EQUAL_INT64(2234700, opens["AMZN"]);
+  TEST_ASSERT_EQUAL_INT64(2193600, prices["AMZN"]);
+  TEST_ASSERT_EQUAL_INT64(6204500, opens["SPY"]);
+  TEST_ASSERT_EQUAL_INT64(6203400, prices["SPY"]);
+
+  // The same, fed in one go
+  prices.clear();
+  parser.reset();
+  TEST_ASSERT_EQUAL(JsonStreamStatus::DONE,
+                    parser.feed(body.data(), body.size()));
+  TEST_ASSERT_EQUAL(8, prices.size());
+}
+
+void test_snapshots_skip_cut_off_values() {
+  StockTicker::SnapshotParser parser(onSnapshot, nullptr);
+  const std::string longId(40, 'A');
+  const std::string longPrice = "1" + std::string(40, '0');
+  TEST_ASSERT_EQUAL(
+    JsonStreamStatus::DONE,
+    feedByChar(parser,
+               "{\"" + longId + "\": {\"dailyBar\": {\"o\": 1, \"c\": 2}},"
+               " \"BIG\": {\"dailyBar\": {\"o\": 1, \"c\": " + longPrice +
+                 "}}, \"OK\": {\"dailyBar\": {\"o\": 1, \"c\": 2}}}"));
+  TEST_ASSERT_EQUAL(1, prices.size());
+  TEST_ASSERT_EQUAL_INT64(20000, prices["OK"]);
+}
+
+void test_snapshots_missing_daily_bar() {
+  StockTicker::SnapshotParser parser(onSnapshot, nullptr);
+  TEST_ASSERT_EQUAL(
+    JsonStreamStatus::DONE,
+    feedByChar(parser, "{\"A\": {\"latestTrade\": {\"p\": 1}},"
+                       " \"B\": {\"dailyBar\": {\"o\": 1}},"
+                       " \"C\": {\"dailyBar\": {\"c\": 3, \"o\": 2}}}"));
+  TEST_ASSERT_EQUAL(1, prices.size());
+  TEST_ASSERT_EQUAL_INT64(20000, opens["C"]);
+  TEST_ASSERT_EQUAL_INT64(30000, prices["C"]);
+}
+
+void test_latest_trades_recorded_response() {
+  const std::string body = RecordedResponses::read("latest_trades.json");
+  StockTicker::LatestTradesParser parser(onPrice, nullptr);
+  TEST_ASSERT_EQUAL(JsonStreamStatus::DONE, feedByChar(parser, body));
+  TEST_ASSERT_EQUAL(8, prices.size());
+  TEST_ASSERT_EQUAL_INT64(2274800, prices["AAPL"]);
+  TEST_ASSERT_EQUAL_INT64(7209200, prices["META"]);
+}
+
+void test_bars_recorded_response() {
+  const std::string body = RecordedResponses::read("bars.json");
+  StockTicker::BarsParser parser(onBar, nullptr);
+  TEST_ASSERT_EQUAL(JsonStreamStatus::DONE, feedByChar(parser, body));
+  TEST_ASSERT_EQUAL(8, barCounts.size());
+  TEST_ASSERT_EQUAL(13, barCounts["TSLA"]);
+  // The last bar is the latest close
+  TEST_ASSERT_EQUAL_INT64(2978100, prices["TSLA"]);
+  TEST_ASSERT_FALSE(parser.hasNextPage());
+}
+
+void test_trade_stream_messages() {
+  StockTicker::TradeStreamParser parser(onPrice, onControl, nullptr);
+  TEST_ASSERT_EQUAL(
+    JsonStreamStatus::DONE,
+    feedByChar(parser, "[{\"T\":\"success\",\"msg\":\"authenticated\"}]"));
+  TEST_ASSERT_EQUAL_STRING("success:authenticated:0 ", controls.c_str());
+
+  FILE* file = fopen(HOST_PROJECT_DIR "/tools/recorded_trades.jsonl", "r");
+  TEST_ASSERT_NOT_NULL(file);
+  char line[1024];
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    TEST_ASSERT_EQUAL(JsonStreamStatus::DONE, feedByChar(parser, line));
+  }
+  fclose(file);
+  // The last trade of each symbol
+  TEST_ASSERT_EQUAL(5, prices.size());
+  TEST_ASSERT_EQUAL_INT64(2276000, prices["AAPL"]);
+  TEST_ASSERT_EQUAL_INT64(1781100, prices["GOOG"]);
+  TEST_ASSERT_EQUAL_INT64(2199200, prices["AMZN"]);
+
+  TEST_ASSERT_EQUAL(
+    JsonStreamStatus::DONE,
+    feedByChar(parser, "[{\"T\":\"error\",\"code\":402,\"msg\":\"auth "
+                       "failed\"}]"));
+  TEST_ASSERT_EQUAL_STRING("success:authenticated:0 error:auth failed:402 ",
+                           controls.c_str());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_tokenizer_events);
+  RUN_TEST(test_tokenizer_root_scalars);
+  RUN_TEST(test_tokenizer_errors);
+  RUN_TEST(test_tokenizer_truncation_is_reported);
+  RUN_TEST(test_snapshots_recorded_response);
+  RUN_TEST(test_snapshots_skip_cut_off_values);
+  RUN_TEST(test_snapshots_missing_daily_bar);
+  RUN_TEST(test_latest_trades_recorded_response);
+  RUN_TEST(test_bars_recorded_response);
+  RUN_TEST(test_trade_stream_messages);
+  return UNITY_END();
+}
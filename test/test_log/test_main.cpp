@@ -0,0 +1,134 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <Log.h>
+#include <string>
+#include <unity.h>
+
+using Telemetry::LogLevel;
+
+enum class Colour : uint8_t { RED, GREEN };
+
+void setUp() {
+  HostShim::millisNow = 12345;
+  Serial1.output.clear();
+  Serial1.writeRoom = 1 << 16;
+}
+
+void tearDown() {}
+
+void test_formats_like_printf() {
+  Telemetry::Logger testLogger;
+  char expected[128];
+  const char* const format = "%d %ld %llu %5.2f %-4s| %c %x %u %% %p %s";
+  const int* const pointer = reinterpret_cast<const int*>(0x1234);
+  snprintf(expected, sizeof(expected), format, -7, -80000L,
+           1234567890123ULL, 3.14159, "ab", 'z', 255u,
+           static_cast<uint8_t>(Colour::GREEN), pointer, "end");
+  testLogger.log(LogLevel::INFO, format, -7, -80000L, 1234567890123ULL,
+                 3.14159, "ab", 'z', 255u, Colour::GREEN, pointer, "end");
+  const std::string line = "[12.345] " + std::string(expected) + "\n";
+  TEST_ASSERT_EQUAL_STRING(line.c_str(), Serial1.output.c_str());
+}
+
+void test_levels_and_no_arguments() {
+  Telemetry::Logger testLogger;
+  testLogger.log(LogLevel::ERROR, "Failed %s", "here");
+  testLogger.log(LogLevel::WARN, "100%% sure");
+  testLogger.log(LogLevel::DEBUG, "Done");
+  TEST_ASSERT_EQUAL_STRING("[12.345] Error: Failed here\n"
+                           "[12.345] Warning: 100% sure\n"
+                           "[12.345] Done\n",
+                           Serial1.output.c_str());
+}
+
+void test_strings_are_copied_and_cut_off() {
+  Telemetry::Logger testLogger;
+  testLogger.setDeferred(true);
+  std::string name = "AAPL";
+  const std::string longString(1000, 'x');
+  const char* nothing = nullptr;
+  testLogger.log(LogLevel::INFO, "%s %s", name.c_str(), nothing);
+  testLogger.log(LogLevel::INFO, "%s|", longString.c_str());
+  // Both together don't fit in a record, the second gets what's left
+  testLogger.log(LogLevel::INFO, "%s|%s|%d", longString.c_str(),
+                 longString.c_str(), 42);
+  // Copied, so changing it after doesn't change the log
+  name.replace(0, 4, "MSFT");
+  TEST_ASSERT_EQUAL_STRING("", Serial1.output.c_str());
+  testLogger.flush();
+
+  const std::string maxString(Telemetry::LOG_MAX_STRING_LEN, 'x');
+  const size_t firstEnd = Serial1.output.find('\n');
+  TEST_ASSERT_EQUAL_STRING("[12.345] AAPL (null)",
+                           Serial1.output.substr(0, firstEnd).c_str());
+  const size_t secondEnd = Serial1.output.find('\n', firstEnd + 1);
+  TEST_ASSERT_EQUAL_STRING(
+    ("[12.345] " + maxString + "|").c_str(),
+    Serial1.output.substr(firstEnd + 1, secondEnd - firstEnd - 1).c_str());
+  const std::string third = Serial1.output.substr(secondEnd + 1);
+  TEST_ASSERT_EQUAL_STRING("|42\n",
+                           third.substr(third.size() - 4).c_str());
+  TEST_ASSERT_LESS_OR_EQUAL(Telemetry::LOG_MAX_LINE_LEN, third.size());
+  TEST_ASSERT_EQUAL_STRING(("[12.345] " + maxString + "|x").c_str(),
+                           third.substr(0, 9 + maxString.size() + 2).c_str());
+}
+
+void test_long_lines_are_cut_off() {
+  Telemetry::Logger testLogger;
+  // Only the format makes it this long, the strings are cut off earlier
+  testLogger.log(LogLevel::INFO, "%320d|", 1);
+  TEST_ASSERT_EQUAL(Telemetry::LOG_MAX_LINE_LEN - 1, Serial1.output.size());
+  TEST_ASSERT_EQUAL(' ', Serial1.output[Serial1.output.size() - 2]);
+  TEST_ASSERT_EQUAL('\n', Serial1.output.back());
+}
+
+void test_drain_only_fills_the_fifo() {
+  Telemetry::Logger testLogger;
+  testLogger.setDeferred(true);
+  for (int i = 0; i < 3; i++) {
+    testLogger.log(LogLevel::INFO, "Record %d", i);
+  }
+  // The transmit FIFO is full
+  Serial1.writeRoom = 0;
+  testLogger.drain();
+  TEST_ASSERT_EQUAL_STRING("", Serial1.output.c_str());
+  Serial1.writeRoom = 8;
+  testLogger.drain();
+  TEST_ASSERT_EQUAL_STRING("[12.345] Record 0\n"
+                           "[12.345] Record 1\n"
+                           "[12.345] Record 2\n",
+                           Serial1.output.c_str());
+}
+
+void test_full_buffer_drops_records() {
+  Telemetry::Logger testLogger;
+  testLogger.setDeferred(true);
+  const std::string longString(200, 'z');
+  uint32_t logged = 0;
+  while (testLogger.getDroppedCount() < 5) {
+    testLogger.log(LogLevel::INFO, "%s", longString.c_str());
+    logged++;
+  }
+  testLogger.flush();
+  size_t lines = 0;
+  for (const char c : Serial1.output) {
+    lines += c == '\n' ? 1 : 0;
+  }
+  // Every record that fit, then how many didn't
+  TEST_ASSERT_EQUAL(logged - 5 + 1, lines);
+  TEST_ASSERT_TRUE(Serial1.output.find("5 log records dropped\n") !=
+                   std::string::npos);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_formats_like_printf);
+  RUN_TEST(test_levels_and_no_arguments);
+  RUN_TEST(test_strings_are_copied_and_cut_off);
+  RUN_TEST(test_long_lines_are_cut_off);
+  RUN_TEST(test_drain_only_fills_the_fifo);
+  RUN_TEST(test_full_buffer_drops_records);
+  return UNITY_END();
+}
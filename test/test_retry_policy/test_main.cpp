@@ -0,0 +1,234 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <HostBench.h>
+#include <HttpKeepAliveClient.h>
+#include <RetryPolicy.h>
+#include <ScriptedClient.h>
+#include <string>
+#include <unity.h>
+
+using StockTicker::CircuitState;
+using StockTicker::HttpRateLimitInfo;
+using StockTicker::HttpRequestState;
+using StockTicker::RetryPolicy;
+
+// Same as the default request period
+const uint32_t PERIOD = 60 * 1000;
+const HttpRateLimitInfo NO_RATE_LIMIT = {-1, -1, 0, 0};
+
+ScriptedClient server;
+StockTicker::HttpKeepAliveClient http;
+RetryPolicy policy;
+
+void setUp() {
+  srand(1); // Same jitter every run
+  HostShim::millisNow = 0;
+  server = ScriptedClient();
+  http = StockTicker::HttpKeepAliveClient();
+  http.setClient(&server);
+  TEST_ASSERT_TRUE(http.begin("data.example", 443, "/", ""));
+  policy.reset();
+}
+
+void tearDown() {}
+
+/**
+ * @brief Make one request to the scripted server, the way StockTicker does.
+ *
+ * @return int32_t The status code, or a negative HTTP_ERROR_* value.
+ */
+int32_t request() {
+  policy.onAttempt();
+  http.startGet();
+  for (uint32_t i = 0; i < 100000; i++) {
+    const HttpRequestState state = http.poll();
+    if (state == HttpRequestState::ERROR) {
+      const int32_t error = http.getStatusCode();
+      http.cancel();
+      return error;
+    }
+    if (state == HttpRequestState::READING_BODY) {
+      while (http.read() >= 0) {
+      }
+      if (http.bodyComplete()) {
+        http.finishResponse();
+      }
+    }
+    if (state == HttpRequestState::IDLE) {
+      return http.getStatusCode();
+    }
+  }
+  TEST_FAIL_MESSAGE("Request never finished");
+  return 0;
+}
+
+// Requests made in a simulation, split by whether the server was failing
+struct SimulationResult {
+  uint32_t duringOutage;
+  uint32_t afterOutage;
+  // Time from the end of the outage to the first successful request
+  uint32_t recoveryTime;
+  // Time from the first success to being back at the normal period
+  uint32_t rampTime;
+};
+
+/**
+ * @brief Poll the scripted server for a while, waiting between requests as
+ *  long as the retry policy says.
+ *
+ * @param outageEnd Until when the server fails, in milliseconds.
+ * @param duration How long to run, in milliseconds.
+ * @param failure What the server responds with during the outage.
+ * @return SimulationResult
+ */
+SimulationResult simulate(uint32_t outageEnd, uint32_t duration,
+                          const std::string& failure) {
+  server.respond = [&](const std::string& request) {
+    return millis() < outageEnd ? failure : httpResponse("{}");
+  };
+  SimulationResult result = {0, 0, 0, 0};
+  bool recovered = false;
+  bool backToPeriod = false;
+  uint32_t recoveredAt = 0;
+  while (millis() < duration) {
+    const int32_t status = request();
+    if (millis() < outageEnd) {
+      result.duringOutage++;
+    } else {
+      result.afterOutage++;
+    }
+    const uint32_t delay =
+      policy.onResult(status, http.getRateLimitInfo(), PERIOD);
+    if (status == 200 && !recovered) {
+      recovered = true;
+      recoveredAt = millis();
+      result.recoveryTime = millis() - outageEnd;
+    }
+    if (recovered && !backToPeriod && delay == PERIOD) {
+      backToPeriod = true;
+      result.rampTime = millis() - recoveredAt;
+    }
+    HostShim::advanceMillis(delay);
+  }
+  return result;
+}
+
+void test_steady_polling() {
+  const SimulationResult result = simulate(0, 60 * PERIOD, "");
+  TEST_ASSERT_EQUAL(60, result.afterOutage);
+  TEST_ASSERT_EQUAL(0, result.rampTime);
+  TEST_ASSERT_EQUAL(1, server.connectCount);
+}
+
+void test_server_errors_back_off() {
+  // 20 minutes of 500s, then an hour of normal polling
+  const uint32_t outage = 20 * 60 * 1000;
+  const SimulationResult result = simulate(
+    outage, outage + 60 * PERIOD,
+    httpResponse("{}", "500 Internal Server Error", "Connection: close\r\n"));
+  HostBench::Result("retry_server_errors", 1)
+    .add("requests_during_outage", result.duringOutage)
+    .add("requests_after_outage", result.afterOutage)
+    .add("recovery_ms", result.recoveryTime)
+    .add("ramp_ms", result.rampTime)
+    .print();
+  // 5 backed off retries, then a probe every CIRCUIT_BREAKER_OPEN_TIME,
+  // instead of one request per loop() pass
+  const uint32_t probes = outage / StockTicker::CIRCUIT_BREAKER_OPEN_TIME;
+  TEST_ASSERT_LESS_OR_EQUAL(5 + probes, result.duringOutage);
+  TEST_ASSERT_LESS_OR_EQUAL(StockTicker::CIRCUIT_BREAKER_OPEN_TIME,
+                            result.recoveryTime);
+  // Eased back to the period in a few halvings, not all at once
+  TEST_ASSERT_GREATER_THAN(0, result.rampTime);
+  TEST_ASSERT_LESS_OR_EQUAL(10 * PERIOD, result.rampTime);
+  TEST_ASSERT_EQUAL(CircuitState::CLOSED, policy.getCircuitState());
+}
+
+void test_rate_limited_honours_retry_after() {
+  server.respond = [](const std::string& request) {
+    return httpResponse("{}", "429 Too Many Requests",
+                        "Retry-After: 90\r\n");
+  };
+  const int32_t status = request();
+  TEST_ASSERT_EQUAL(429, status);
+  // Longer than the 5 second backoff
+  TEST_ASSERT_EQUAL_UINT32(
+    90 * 1000, policy.onResult(status, http.getRateLimitInfo(), PERIOD));
+}
+
+void test_rate_limited_waits_for_reset() {
+  server.respond = [](const std::string& request) {
+    return httpResponse("{}", "200 OK",
+                        "Date: Tue, 08 Jul 2025 15:58:00 GMT\r\n"
+                        "X-RateLimit-Remaining: 0\r\n"
+                        "X-RateLimit-Reset: 1751990400\r\n");
+  };
+  const int32_t status = request();
+  TEST_ASSERT_EQUAL(200, status);
+  // Out of requests until the reset, 2 minutes by the server's clock
+  TEST_ASSERT_EQUAL_UINT32(
+    120 * 1000, policy.onResult(status, http.getRateLimitInfo(), PERIOD));
+}
+
+void test_rate_limited_requests() {
+  // 10 minutes of 429s without Retry-After
+  const uint32_t outage = 10 * 60 * 1000;
+  const SimulationResult result =
+    simulate(outage, outage + 10 * PERIOD,
+             httpResponse("{}", "429 Too Many Requests"));
+  HostBench::Result("retry_rate_limited", 1)
+    .add("requests_during_outage", result.duringOutage)
+    .add("requests_after_outage", result.afterOutage)
+    .add("recovery_ms", result.recoveryTime)
+    .print();
+  TEST_ASSERT_LESS_OR_EQUAL(8, result.duringOutage);
+  TEST_ASSERT_GREATER_THAN(0, result.afterOutage);
+}
+
+void test_connection_failures_open_the_breaker() {
+  server.refuseConnections = true;
+  for (uint8_t i = 1; i < StockTicker::CIRCUIT_BREAKER_THRESHOLD; i++) {
+    const int32_t status = request();
+    TEST_ASSERT_EQUAL(StockTicker::HTTP_ERROR_CONNECTION_FAILED, status);
+    const uint32_t delay = policy.onResult(status, NO_RATE_LIMIT, PERIOD);
+    // Equal jitter around a doubling backoff
+    const uint32_t full = min(2000u << (i - 1), 60 * 1000u);
+    TEST_ASSERT_GREATER_OR_EQUAL(full / 2, delay);
+    TEST_ASSERT_LESS_OR_EQUAL(full, delay);
+    TEST_ASSERT_EQUAL(CircuitState::CLOSED, policy.getCircuitState());
+  }
+  TEST_ASSERT_EQUAL_UINT32(
+    StockTicker::CIRCUIT_BREAKER_OPEN_TIME,
+    policy.onResult(request(), NO_RATE_LIMIT, PERIOD));
+  TEST_ASSERT_EQUAL(CircuitState::OPEN, policy.getCircuitState());
+
+  // A failed probe opens it again right away
+  request();
+  TEST_ASSERT_EQUAL(CircuitState::HALF_OPEN, policy.getCircuitState());
+  policy.onResult(StockTicker::HTTP_ERROR_CONNECTION_FAILED, NO_RATE_LIMIT,
+                  PERIOD);
+  TEST_ASSERT_EQUAL(CircuitState::OPEN, policy.getCircuitState());
+
+  // A successful one closes it
+  server.refuseConnections = false;
+  server.respond = [](const std::string& request) {
+    return httpResponse("{}");
+  };
+  TEST_ASSERT_EQUAL(200, request());
+  policy.onResult(200, NO_RATE_LIMIT, PERIOD);
+  TEST_ASSERT_EQUAL(CircuitState::CLOSED, policy.getCircuitState());
+  TEST_ASSERT_EQUAL(0, policy.getConsecutiveFailures());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_steady_polling);
+  RUN_TEST(test_server_errors_back_off);
+  RUN_TEST(test_rate_limited_honours_retry_after);
+  RUN_TEST(test_rate_limited_waits_for_reset);
+  RUN_TEST(test_rate_limited_requests);
+  RUN_TEST(test_connection_failures_open_the_breaker);
+  return UNITY_END();
+}
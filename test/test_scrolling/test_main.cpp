@@ -0,0 +1,384 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <HostBench.h>
+#include <MD_MAX72xx.h>
+#include <MD_MAX72xx_Text.h>
+#include <string>
+#include <unity.h>
+
+// Chains the scroller is checked on, the last one as wide as it scrolls
+const uint8_t DEVICE_COUNTS[] = {1, 4, 16, 32};
+const uint8_t SPARKLINE_WIDTH = 10;
+
+/**
+ * @brief Draw made up sparkline columns, different for every marker.
+ *
+ * @param context Points to a seed, changed to draw different columns.
+ * @param textIndex The index of the marker in the text.
+ * @param column Which column to draw.
+ * @return uint8_t
+ */
+uint8_t sparklineColumn(void* context, size_t textIndex, uint8_t column) {
+  const uint8_t seed = *static_cast<const uint8_t*>(context);
+  return static_cast<uint8_t>(1 << ((textIndex + column + seed) % 8));
+}
+
+/**
+ * @brief The scroller as it was before the framebuffer, to check the new one
+ *  against. Every frame clears the display and draws each visible character
+ *  again from the font, then sends the whole display.
+ */
+class ReferenceScroller {
+  public:
+    ReferenceScroller(MD_MAX72XX* display, const char* text,
+                      bool startOnLeft = false) {
+      this->display = display;
+      this->text = text;
+      this->reset(startOnLeft);
+    }
+
+    void setColumnProvider(MD_MAX72XX_ColumnProvider provider, uint8_t width,
+                           void* context) {
+      this->provider = provider;
+      this->providedWidth = width;
+      this->providerContext = context;
+    }
+
+    void update() {
+      this->display->update();
+      const int32_t colCount = this->display->getColumnCount();
+      const size_t textLen = strlen(this->text);
+      this->display->clear();
+      int32_t col = this->charCol;
+      for (size_t i = this->charIndex;
+           i < textLen && col < this->scrollCol + colCount; i++) {
+        // The display counts columns from the right
+        const int32_t displayCol = colCount - 1 - (col - this->scrollCol);
+        col += this->drawChar(i, displayCol) + 1;
+      }
+      if (this->holdFrames > 0) {
+        this->holdFrames--;
+      }
+      if (this->holdFrames == 0) {
+        this->scrollCol++;
+      }
+      while (this->charIndex < textLen) {
+        const uint8_t width = this->getWidth(this->charIndex);
+        if (this->scrollCol < this->charCol + width) {
+          break;
+        }
+        this->charCol += width;
+        this->charIndex++;
+      }
+      if (this->charIndex >= textLen) {
+        this->reset();
+      }
+    }
+
+  protected:
+    MD_MAX72XX* display;
+    const char* text;
+    MD_MAX72XX_ColumnProvider provider = nullptr;
+    uint8_t providedWidth = 0;
+    void* providerContext = nullptr;
+    int32_t scrollCol = 0;
+    uint16_t holdFrames = 0;
+    size_t charIndex = 0;
+    int32_t charCol = 0;
+
+    void reset(bool startOnLeft = false) {
+      const int32_t colCount = this->display->getColumnCount();
+      this->scrollCol = startOnLeft ? 0 : -colCount;
+      this->holdFrames = startOnLeft ? colCount : 0;
+      this->charIndex = 0;
+      this->charCol = 0;
+    }
+
+    bool isMarker(size_t i) const {
+      return this->text[i] == MD_MAX72XX_Scrolling::COLUMNS_MARKER &&
+             this->provider != nullptr;
+    }
+
+    uint8_t drawChar(size_t i, int32_t displayCol) {
+      if (!this->isMarker(i)) {
+        return this->display->setChar(displayCol, this->text[i]);
+      }
+      for (uint8_t x = 0; x < this->providedWidth; x++) {
+        if (displayCol - x >= 0) {
+          this->display->setColumn(
+            displayCol - x, this->provider(this->providerContext, i, x));
+        }
+      }
+      return this->providedWidth;
+    }
+
+    // Looked up in the font every time, like getTextWidth(char) did
+    uint8_t getWidth(size_t i) {
+      if (this->isMarker(i)) {
+        return this->providedWidth + 1;
+      }
+      uint8_t buf[16];
+      return this->display->getChar(this->text[i], sizeof(buf), buf) + 1;
+    }
+};
+
+/**
+ * @brief Build a ticker like display string for some symbols.
+ *
+ * @param symbols How many symbols.
+ * @param withSparklines Whether each has a COLUMNS_MARKER for its sparkline.
+ * @return std::string
+ */
+std::string tickerText(uint16_t symbols, bool withSparklines) {
+  std::string text;
+  for (uint16_t i = 0; i < symbols; i++) {
+    char entry[64];
+    snprintf(entry, sizeof(entry), "S%u: $%u.%02u +0.%02u%% (+$1.%02u) %s   ",
+             i, 100 + i * 7, i % 100, (i * 3) % 100, (i * 11) % 100,
+             withSparklines ? "\x01" : "");
+    text += entry;
+  }
+  return text;
+}
+
+/**
+ * @brief Check that two displays show the same thing.
+ *
+ * @param expected The display drawn by the reference.
+ * @param actual The display to check.
+ * @param frame Which frame it is, for the message.
+ */
+void assertSameColumns(MD_MAX72XX& expected, MD_MAX72XX& actual,
+                       uint32_t frame) {
+  for (uint16_t col = 0; col < expected.getColumnCount(); col++) {
+    if (expected.getColumn(col) != actual.getColumn(col)) {
+      char message[64];
+      snprintf(message, sizeof(message), "Frame %lu differs at column %u",
+               static_cast<unsigned long>(frame), col);
+      TEST_FAIL_MESSAGE(message);
+    }
+  }
+}
+
+/**
+ * @brief Scroll a text on the reference and on MD_MAX72XX_Scrolling side by
+ *  side, checking every frame is the same and the SPI bytes it reports.
+ *
+ * @param devices How many modules in the chain.
+ * @param text The text, may be changed by edit.
+ * @param frames How many frames.
+ * @param startOnLeft Passed to setText().
+ * @param edit Called before each frame with its number, returns true if it
+ *  changed the text in place.
+ */
+template <class F>
+void scrollSideBySide(uint8_t devices, char* text, uint32_t frames,
+                      bool startOnLeft, F edit) {
+  uint8_t seed = 0;
+  MD_MAX72XX referenceDisplay(MD_MAX72XX::FC16_HW, 0, devices);
+  referenceDisplay.control(MD_MAX72XX::UPDATE, MD_MAX72XX::OFF);
+  ReferenceScroller reference(&referenceDisplay, text, startOnLeft);
+  reference.setColumnProvider(sparklineColumn, SPARKLINE_WIDTH, &seed);
+
+  MD_MAX72XX display(MD_MAX72XX::FC16_HW, 0, devices);
+  display.control(MD_MAX72XX::UPDATE, MD_MAX72XX::OFF);
+  MD_MAX72XX_GlyphCache glyphs(&display);
+  MD_MAX72XX_Scrolling scrolling(&display, &glyphs);
+  scrolling.setColumnProvider(sparklineColumn, SPARKLINE_WIDTH, &seed);
+  scrolling.setText(text, startOnLeft);
+
+  uint64_t reportedSpiBytes = 0;
+  for (uint32_t frame = 0; frame < frames; frame++) {
+    if (edit(frame, seed)) {
+      TEST_ASSERT_TRUE(scrolling.textChanged(text, strlen(text)));
+    }
+    HostShim::advanceMillis(scrolling.periodBetweenShifts);
+    reference.update();
+    TEST_ASSERT_TRUE(scrolling.update());
+    reportedSpiBytes += scrolling.getLastFrameSpiBytes();
+    assertSameColumns(referenceDisplay, display, frame);
+  }
+  // Each frame sends the one before it, so both sent the same frames
+  TEST_ASSERT_EQUAL_UINT64(display.spiBytes, reportedSpiBytes);
+  TEST_ASSERT_LESS_OR_EQUAL(referenceDisplay.spiBytes, display.spiBytes);
+}
+
+void setUp() {
+  HostShim::millisNow = 0;
+}
+
+void tearDown() {}
+
+void test_matches_reference() {
+  for (const uint8_t devices : DEVICE_COUNTS) {
+    std::string text = tickerText(3, true);
+    // Twice through, to check it starts over the same way
+    const uint32_t frames = 2 * (text.size() * 6 + devices * COL_SIZE);
+    scrollSideBySide(devices, text.data(), frames, false,
+                     [](uint32_t frame, uint8_t& seed) { return false; });
+    scrollSideBySide(devices, text.data(), frames, true,
+                     [](uint32_t frame, uint8_t& seed) { return false; });
+  }
+}
+
+void test_short_text_matches_reference() {
+  for (const uint8_t devices : DEVICE_COUNTS) {
+    char text[] = "Hi";
+    scrollSideBySide(devices, text, 3 * (20 + devices * COL_SIZE), false,
+                     [](uint32_t frame, uint8_t& seed) { return false; });
+  }
+}
+
+void test_text_changed_in_place_matches_reference() {
+  for (const uint8_t devices : DEVICE_COUNTS) {
+    const std::string first = tickerText(4, true);
+    const std::string second = tickerText(2, true) + "Longer $999.99!";
+    char text[256];
+    strcpy(text, first.c_str());
+    const uint32_t frames = 3 * (first.size() * 6 + devices * COL_SIZE);
+    scrollSideBySide(devices, text, frames, false,
+                     [&](uint32_t frame, uint8_t& seed) {
+                       if (frame % 97 != 50) {
+                         return false;
+                       }
+                       // New prices and sparklines, the way the StockTicker
+                       // rewrites it
+                       strcpy(text, (frame % 2 == 0 ? second : first).c_str());
+                       seed++;
+                       return true;
+                     });
+  }
+}
+
+void test_other_text_changing_is_ignored() {
+  // The StockTicker's display string changes while an error message is
+  // shown, the message must still be shown whole
+  char displayStr[] = "AAPL";
+  const char* const message =
+    "Internal server error, check Alpaca Markets' Slack or Community Forum, "
+    "trying again later.";
+  MD_MAX72XX referenceDisplay(MD_MAX72XX::FC16_HW, 0, 4);
+  referenceDisplay.control(MD_MAX72XX::UPDATE, MD_MAX72XX::OFF);
+  ReferenceScroller reference(&referenceDisplay, message);
+  MD_MAX72XX display(MD_MAX72XX::FC16_HW, 0, 4);
+  display.control(MD_MAX72XX::UPDATE, MD_MAX72XX::OFF);
+  MD_MAX72XX_GlyphCache glyphs(&display);
+  MD_MAX72XX_Scrolling scrolling(&display, &glyphs);
+  scrolling.setText(message);
+  for (uint32_t frame = 0; frame < 2 * strlen(message) * 6; frame++) {
+    if (frame % 50 == 0) {
+      TEST_ASSERT_FALSE(
+        scrolling.textChanged(displayStr, strlen(displayStr)));
+    }
+    HostShim::advanceMillis(scrolling.periodBetweenShifts);
+    reference.update();
+    TEST_ASSERT_TRUE(scrolling.update());
+    assertSameColumns(referenceDisplay, display, frame);
+  }
+}
+
+void test_shifts_across_millis_wrap() {
+  MD_MAX72XX display(MD_MAX72XX::FC16_HW, 0, 4);
+  MD_MAX72XX_GlyphCache glyphs(&display);
+  MD_MAX72XX_Scrolling scrolling(&display, &glyphs);
+  HostShim::millisNow = UINT32_MAX - 2 * scrolling.periodBetweenShifts;
+  scrolling.setText("AAPL");
+  for (uint8_t frame = 0; frame < 5; frame++) {
+    TEST_ASSERT_TRUE(scrolling.update());
+    // Once a period, even when the next shift time wrapped
+    TEST_ASSERT_FALSE(scrolling.update());
+    HostShim::advanceMillis(scrolling.periodBetweenShifts);
+  }
+}
+
+void test_print_matches_set_char() {
+  MD_MAX72XX expected(MD_MAX72XX::FC16_HW, 0, 4);
+  MD_MAX72XX display(MD_MAX72XX::FC16_HW, 0, 4);
+  MD_MAX72XX_GlyphCache glyphs(&display);
+  MD_MAX72XX_Print print(&display, &glyphs);
+  const char text[] = "Hi $1.23";
+  uint16_t col = expected.getColumnCount() - 1;
+  for (const char c : std::string(text)) {
+    col -= expected.setChar(col, c) + 1;
+  }
+  print.print(text);
+  assertSameColumns(expected, display, 0);
+  // Widths come from the cache, the font is only read to build it
+  const uint64_t fontReads = display.fontReads;
+  print.print("\nHi $1.23");
+  TEST_ASSERT_EQUAL_UINT64(fontReads, display.fontReads);
+  assertSameColumns(expected, display, 1);
+}
+
+void test_frame_cost() {
+  // Against the reference, the cost of a frame on a short and a long chain,
+  // and how it grows with the length of the text
+  for (const uint16_t symbols : HostBench::SYMBOL_COUNTS) {
+    for (const uint8_t devices : {4, 16}) {
+      const std::string text = tickerText(symbols, true);
+      const uint32_t frames = text.size() * 6 + devices * COL_SIZE;
+      uint8_t seed = 0;
+
+      MD_MAX72XX referenceDisplay(MD_MAX72XX::FC16_HW, 0, devices);
+      referenceDisplay.control(MD_MAX72XX::UPDATE, MD_MAX72XX::OFF);
+      ReferenceScroller reference(&referenceDisplay, text.c_str());
+      reference.setColumnProvider(sparklineColumn, SPARKLINE_WIDTH, &seed);
+      uint64_t start = HostShim::nanos();
+      for (uint32_t i = 0; i < frames; i++) {
+        reference.update();
+      }
+      const double referenceNanos =
+        static_cast<double>(HostShim::nanos() - start) / frames;
+
+      MD_MAX72XX display(MD_MAX72XX::FC16_HW, 0, devices);
+      display.control(MD_MAX72XX::UPDATE, MD_MAX72XX::OFF);
+      MD_MAX72XX_GlyphCache glyphs(&display);
+      MD_MAX72XX_Scrolling scrolling(&display, &glyphs);
+      scrolling.setColumnProvider(sparklineColumn, SPARKLINE_WIDTH, &seed);
+      scrolling.setText(text.c_str());
+      // Not counting building the glyph cache, done once
+      glyphs.getWidth(' ');
+      display.fontReads = 0;
+      start = HostShim::nanos();
+      for (uint32_t i = 0; i < frames; i++) {
+        HostShim::advanceMillis(scrolling.periodBetweenShifts);
+        scrolling.update();
+      }
+      const double nanos =
+        static_cast<double>(HostShim::nanos() - start) / frames;
+
+      HostBench::Result("scroll_frame_reference", symbols)
+        .add("devices", devices)
+        .add("ns_per_op", referenceNanos)
+        .add("spi_bytes_per_frame",
+             static_cast<double>(referenceDisplay.spiBytes) / frames)
+        .add("font_reads_per_frame",
+             static_cast<double>(referenceDisplay.fontReads) / frames)
+        .print();
+      HostBench::Result("scroll_frame_shifted", symbols)
+        .add("devices", devices)
+        .add("ns_per_op", nanos)
+        .add("spi_bytes_per_frame",
+             static_cast<double>(display.spiBytes) / frames)
+        .add("font_reads_per_frame",
+             static_cast<double>(display.fontReads) / frames)
+        .print();
+      TEST_ASSERT_EQUAL_UINT64(0, display.fontReads);
+      TEST_ASSERT_LESS_OR_EQUAL(referenceDisplay.spiBytes, display.spiBytes);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_matches_reference);
+  RUN_TEST(test_short_text_matches_reference);
+  RUN_TEST(test_text_changed_in_place_matches_reference);
+  RUN_TEST(test_other_text_changing_is_ignored);
+  RUN_TEST(test_shifts_across_millis_wrap);
+  RUN_TEST(test_print_matches_set_char);
+  RUN_TEST(test_frame_cost);
+  return UNITY_END();
+}
@@ -0,0 +1,147 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <TickerSettings.h>
+#include <string>
+#include <unity.h>
+
+using Settings::LoadFromDiskResult;
+using Settings::SaveToDiskResult;
+using Settings::TickerSettings;
+
+const char* const PATH = "ticker_settings.json";
+const char* const VALID_FILE =
+  "{\"apcaApiKeyId\":\"key\",\"apcaApiSecretKey\":\"secret\","
+  "\"symbols\":\"AAPL,MSFT\",\"sourceFeed\":\"iex\"}";
+
+TickerSettings settings;
+
+void setUp() {
+  FatFS = HostFatFS();
+  settings = TickerSettings();
+  strcpy(settings.apcaApiKeyId, "key");
+  strcpy(settings.apcaApiSecretKey, "secret");
+  strcpy(settings.symbols, "AAPL,MSFT");
+}
+
+void tearDown() {}
+
+/**
+ * @brief Check that a load or save left nothing behind, whether it worked or
+ *  not: the arena is empty for the next one and FatFS isn't mounted.
+ */
+void assertReleased() {
+  TEST_ASSERT_EQUAL(0, Settings::jsonArena.getUsed());
+  TEST_ASSERT_FALSE(FatFS.mounted);
+}
+
+void test_round_trip() {
+  TEST_ASSERT_EQUAL(SaveToDiskResult::OK, settings.saveToDisk());
+  assertReleased();
+  TickerSettings loaded;
+  TEST_ASSERT_EQUAL(LoadFromDiskResult::OK, loaded.loadFromDisk());
+  assertReleased();
+  TEST_ASSERT_EQUAL_STRING("key", loaded.apcaApiKeyId);
+  TEST_ASSERT_EQUAL_STRING("AAPL,MSFT", loaded.symbols);
+  TEST_ASSERT_GREATER_THAN(
+    0,
+    Telemetry::metrics.get(Telemetry::MetricGauge::JSON_ARENA_PEAK).last);
+}
+
+void test_failed_loads_release_the_arena() {
+  FatFS.failBegin = true;
+  TEST_ASSERT_EQUAL(LoadFromDiskResult::ERROR_FATFS_INIT_FAILED,
+                    settings.loadFromDisk());
+  assertReleased();
+  FatFS.failBegin = false;
+
+  TEST_ASSERT_EQUAL(LoadFromDiskResult::ERROR_FILE_OPEN_FAILED,
+                    settings.loadFromDisk());
+  assertReleased();
+
+  FatFS.files[PATH] = "{\"apcaApiKeyId\":";
+  TEST_ASSERT_EQUAL(LoadFromDiskResult::ERROR_JSON_PARSE_INCOMPLETE_INPUT,
+                    settings.loadFromDisk());
+  assertReleased();
+
+  FatFS.files[PATH] = "";
+  TEST_ASSERT_EQUAL(LoadFromDiskResult::ERROR_JSON_PARSE_EMPTY_INPUT,
+                    settings.loadFromDisk());
+  assertReleased();
+
+  // Parses, and fills the arena, but isn't valid
+  FatFS.files[PATH] = "{\"apcaApiKeyId\":\"key\",\"apcaApiSecretKey\":"
+                      "\"secret\",\"symbols\":\"\",\"sourceFeed\":\"iex\"}";
+  TEST_ASSERT_EQUAL(LoadFromDiskResult::ERROR_VALIDATION_FAILED,
+                    settings.loadFromDisk());
+  assertReleased();
+  TEST_ASSERT_GREATER_THAN(
+    0,
+    Telemetry::metrics.get(Telemetry::MetricGauge::JSON_ARENA_PEAK).last);
+}
+
+void test_failed_saves_release_the_arena() {
+  FatFS.failBegin = true;
+  TEST_ASSERT_EQUAL(SaveToDiskResult::ERROR_FATFS_INIT_FAILED,
+                    settings.saveToDisk());
+  assertReleased();
+  TEST_ASSERT_FALSE(FatFS.exists(PATH));
+}
+
+void test_soak() {
+  // Every way loading and saving can go, over and over. The arena has to be
+  // empty after each one, or it would run out after a few failures.
+  FatFS.files[PATH] = VALID_FILE;
+  TEST_ASSERT_EQUAL(LoadFromDiskResult::OK, settings.loadFromDisk());
+  const uint32_t peak =
+    Telemetry::metrics.get(Telemetry::MetricGauge::JSON_ARENA_PEAK).last;
+  for (uint16_t i = 0; i < 1000; i++) {
+    switch (i % 6) {
+      case 0:
+        FatFS.failBegin = true;
+        TEST_ASSERT_EQUAL(LoadFromDiskResult::ERROR_FATFS_INIT_FAILED,
+                          settings.loadFromDisk());
+        FatFS.failBegin = false;
+        break;
+      case 1:
+        FatFS.remove(PATH);
+        TEST_ASSERT_EQUAL(LoadFromDiskResult::ERROR_FILE_OPEN_FAILED,
+                          settings.loadFromDisk());
+        break;
+      case 2:
+        FatFS.files[PATH] = "{\"apcaApiKeyId\":\"key\",,}";
+        TEST_ASSERT_EQUAL(LoadFromDiskResult::ERROR_JSON_PARSE_INVALID_INPUT,
+                          settings.loadFromDisk());
+        break;
+      case 3:
+        TEST_ASSERT_EQUAL(SaveToDiskResult::OK, settings.saveToDisk());
+        break;
+      case 4:
+        FatFS.failBegin = true;
+        TEST_ASSERT_EQUAL(SaveToDiskResult::ERROR_FATFS_INIT_FAILED,
+                          settings.saveToDisk());
+        FatFS.failBegin = false;
+        break;
+      case 5:
+        FatFS.files[PATH] = VALID_FILE;
+        TEST_ASSERT_EQUAL(LoadFromDiskResult::OK, settings.loadFromDisk());
+        TEST_ASSERT_EQUAL(
+          peak,
+          Telemetry::metrics.get(Telemetry::MetricGauge::JSON_ARENA_PEAK).last);
+        break;
+    }
+    assertReleased();
+  }
+  TEST_ASSERT_EQUAL(0, Settings::jsonArena.getFailedAllocations());
+  TEST_ASSERT_EQUAL_STRING("AAPL,MSFT", settings.symbols);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_failed_loads_release_the_arena);
+  RUN_TEST(test_failed_saves_release_the_arena);
+  RUN_TEST(test_soak);
+  return UNITY_END();
+}
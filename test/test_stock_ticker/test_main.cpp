@@ -0,0 +1,342 @@
+//
+// Created by ckyiu on 10/17/2026.
+//
+
+#include <RecordedResponses.h>
+#include <ScriptedClient.h>
+#include <StockTicker.h>
+#include <string>
+#include <unity.h>
+
+using StockTicker::DataSource;
+using StockTicker::SparklineBuffer;
+using StockTicker::SparklineColumns;
+using StockTicker::StockTickerStatus;
+
+/**
+ * @brief StockTicker that also shows what it keeps per symbol besides the
+ *  display string.
+ */
+class InspectedTicker : public StockTicker::StockTicker {
+  public:
+    int64_t getReferencePrice(uint16_t i) const {
+      return this->symbolReferencePrices[i];
+    }
+
+    /**
+     * @brief Render a symbol's sparkline, without marking it rendered.
+     *
+     * @param i The index of the symbol.
+     * @return std::string The columns.
+     */
+    std::string getSparkline(uint16_t i) const {
+      SparklineBuffer sparkline = this->sparklines[i];
+      SparklineColumns columns;
+      sparkline.render(columns);
+      return std::string(reinterpret_cast<const char*>(columns.columns),
+                         sizeof(columns.columns));
+    }
+};
+
+// The whole StockTicker, fetching the recorded responses from a scripted
+// server the way it would from Alpaca Markets
+ScriptedClient dataServer;
+ScriptedClient streamServer;
+InspectedTicker stockTicker;
+
+/**
+ * @brief Answer each request with the recorded response of its endpoint.
+ *
+ * @param request The request head.
+ * @return std::string
+ */
+std::string recordedResponse(const std::string& request) {
+  const std::string path = requestPath(request);
+  if (path.rfind("/v2/stocks/snapshots?", 0) == 0) {
+    return httpResponse(RecordedResponses::read("snapshots.json"));
+  }
+  if (path.rfind("/v2/stocks/trades/latest?", 0) == 0) {
+    return httpResponse(RecordedResponses::read("latest_trades.json"));
+  }
+  if (path.rfind("/v2/stocks/bars?", 0) == 0) {
+    return httpResponse(RecordedResponses::read("bars.json"));
+  }
+  return httpResponse("{\"message\":\"not found\"}", "404 Not Found");
+}
+
+/**
+ * @brief Build an unmasked text frame, the way the server sends them.
+ *
+ * @param text The message.
+ * @return std::string
+ */
+std::string textFrame(const std::string& text) {
+  std::string frame = "\x81";
+  if (text.size() < 126) {
+    frame += static_cast<char>(text.size());
+  } else {
+    frame += static_cast<char>(126);
+    frame += static_cast<char>(text.size() >> 8);
+    frame += static_cast<char>(text.size() & 0xFF);
+  }
+  return frame + text;
+}
+
+/**
+ * @brief Wrap a body in gzip without compressing it, in stored blocks. That
+ *  is enough to take GzipInflater through to the trailer.
+ *
+ * @param body The body.
+ * @param crcXor Flips bits of the CRC-32 in the trailer, to corrupt it.
+ * @param sizeDelta Added to the size in the trailer, to corrupt it.
+ * @return std::string
+ */
+std::string gzipStored(const std::string& body, uint32_t crcXor = 0,
+                       uint32_t sizeDelta = 0) {
+  const auto appendLe = [](std::string& out, uint32_t value, uint8_t bytes) {
+    for (uint8_t i = 0; i < bytes; i++) {
+      out += static_cast<char>(value >> (8 * i));
+    }
+  };
+  // No flags, no mtime, unknown OS
+  std::string gzip("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+  size_t pos = 0;
+  do {
+    const size_t len = min(body.size() - pos, static_cast<size_t>(65535));
+    gzip += static_cast<char>(pos + len == body.size() ? 1 : 0); // BFINAL
+    appendLe(gzip, len, 2);
+    appendLe(gzip, ~len, 2);
+    gzip += body.substr(pos, len);
+    pos += len;
+  } while (pos < body.size());
+  uint32_t crc = 0xffffffff;
+  for (const char c : body) {
+    crc ^= static_cast<uint8_t>(c);
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (crc & 1 ? 0xedb88320 : 0);
+    }
+  }
+  appendLe(gzip, ~crc ^ crcXor, 4);
+  appendLe(gzip, body.size() + sizeDelta, 4);
+  return gzip;
+}
+
+/**
+ * @brief Call update() and updateDisplay() like the main loop does, a
+ *  millisecond apart.
+ *
+ * @param steps How many times.
+ */
+void run(uint32_t steps) {
+  for (uint32_t i = 0; i < steps; i++) {
+    stockTicker.update();
+    stockTicker.updateDisplay();
+    HostShim::advanceMillis(1);
+  }
+}
+
+/**
+ * @brief Get how many requests were made for a path.
+ *
+ * @param prefix The start of the path.
+ * @return size_t
+ */
+size_t requestCount(const char* prefix) {
+  size_t count = 0;
+  for (const std::string& request : dataServer.requests) {
+    count += requestPath(request).rfind(prefix, 0) == 0 ? 1 : 0;
+  }
+  return count;
+}
+
+bool displays(const char* text) {
+  return strstr(stockTicker.getDisplayStr(), text) != nullptr;
+}
+
+void setUp() {
+  HostShim::millisNow = 0;
+  // No prices cached by the last test
+  FatFS.files.clear();
+  dataServer = ScriptedClient();
+  dataServer.respond = recordedResponse;
+  // Arrives a piece at a time, like over WiFi
+  dataServer.maxChunk = 536;
+  streamServer = ScriptedClient();
+  stockTicker.setClients(&dataServer, &streamServer);
+}
+
+void tearDown() {
+  stockTicker.end();
+}
+
+void test_snapshots_fill_the_display() {
+  stockTicker.begin("key", "secret", "AAPL,MSFT,GOOG", "iex", 60 * 1000);
+  TEST_ASSERT_TRUE(displays("AAPL: No data yet..."));
+  run(2000);
+  TEST_ASSERT_EQUAL(StockTickerStatus::OK, stockTicker.getStatus());
+  TEST_ASSERT_EQUAL(1, requestCount("/v2/stocks/snapshots?symbols=AAPL,"
+                                    "MSFT,GOOG&feed=iex"));
+  TEST_ASSERT_EQUAL(1, requestCount("/v2/stocks/bars?"));
+  // Relative to the open of the day
+  TEST_ASSERT_TRUE(displays("AAPL: $227.48 +0.61% (+$1.38) \x01"));
+  TEST_ASSERT_TRUE(displays("MSFT: $"));
+  TEST_ASSERT_TRUE(displays("GOOG: $"));
+  TEST_ASSERT_FALSE(displays("No data yet"));
+  TEST_ASSERT_EQUAL(strlen(stockTicker.getDisplayStr()),
+                    stockTicker.getDisplayStrLen());
+
+  // Kept on the connection, and polled again after the period
+  const uint32_t identical =
+    Telemetry::metrics.get(Telemetry::MetricCounter::RESPONSES_IDENTICAL);
+  HostShim::advanceMillis(60 * 1000);
+  run(2000);
+  TEST_ASSERT_EQUAL(2, requestCount("/v2/stocks/snapshots?"));
+  TEST_ASSERT_EQUAL(1, dataServer.connectCount);
+  // The same recorded response again
+  TEST_ASSERT_EQUAL(identical + 1, Telemetry::metrics.get(
+    Telemetry::MetricCounter::RESPONSES_IDENTICAL));
+}
+
+void test_polls_across_millis_wrap() {
+  // millis() wraps back to 0 half a minute in
+  HostShim::millisNow = UINT32_MAX - 30 * 1000;
+  stockTicker.begin("key", "secret", "AAPL", "iex", 60 * 1000);
+  run(2000);
+  TEST_ASSERT_EQUAL(1, requestCount("/v2/stocks/snapshots?"));
+  HostShim::advanceMillis(30 * 1000);
+  run(2000);
+  TEST_ASSERT_EQUAL(1, requestCount("/v2/stocks/snapshots?"));
+  HostShim::advanceMillis(30 * 1000);
+  run(2000);
+  TEST_ASSERT_EQUAL(2, requestCount("/v2/stocks/snapshots?"));
+  // Refreshing right away also works past the wrap
+  stockTicker.refreshOnNextUpdate();
+  run(2000);
+  TEST_ASSERT_EQUAL(3, requestCount("/v2/stocks/snapshots?"));
+}
+
+void test_latest_trades_after_a_snapshot() {
+  stockTicker.begin("key", "secret", "AAPL,MSFT", "iex", 60 * 1000,
+                    DataSource::LATEST_TRADES);
+  run(2000);
+  HostShim::advanceMillis(60 * 1000);
+  run(2000);
+  TEST_ASSERT_EQUAL(StockTickerStatus::OK, stockTicker.getStatus());
+  TEST_ASSERT_EQUAL(1, requestCount("/v2/stocks/snapshots?"));
+  TEST_ASSERT_EQUAL(1, requestCount("/v2/stocks/trades/latest?symbols=AAPL,"
+                                    "MSFT&feed=iex"));
+  TEST_ASSERT_TRUE(displays("AAPL: $227.48 +0.61% (+$1.38) \x01"));
+}
+
+void test_server_errors_are_reported() {
+  dataServer.respond = [](const std::string& request) {
+    return httpResponse("{\"message\":\"forbidden\"}", "403 Forbidden");
+  };
+  stockTicker.begin("key", "secret", "AAPL", "iex", 60 * 1000);
+  run(2000);
+  TEST_ASSERT_EQUAL(StockTickerStatus::ERROR_FORBIDDEN,
+                    stockTicker.getStatus());
+  TEST_ASSERT_TRUE(displays("AAPL: No data yet..."));
+}
+
+void test_gzip_trailer_is_checked() {
+  const std::string recorded = RecordedResponses::read("snapshots.json");
+  std::string changed = recorded;
+  size_t found;
+  while ((found = changed.find("227.48")) != std::string::npos) {
+    changed.replace(found, 6, "300.00");
+  }
+  // A different reference price too
+  while ((found = changed.find("\"o\":226.1,")) != std::string::npos) {
+    changed.replace(found, 10, "\"o\":250.0,");
+  }
+  std::string gzip;
+  dataServer.respond = [&](const std::string& request) {
+    if (requestPath(request).rfind("/v2/stocks/snapshots?", 0) != 0) {
+      return recordedResponse(request);
+    }
+    return httpResponse(gzip, "200 OK", "Content-Encoding: gzip\r\n");
+  };
+  stockTicker.begin("key", "secret", "AAPL,MSFT", "iex", 60 * 1000);
+  gzip = gzipStored(recorded);
+  run(2000);
+  TEST_ASSERT_EQUAL(StockTickerStatus::OK, stockTicker.getStatus());
+  TEST_ASSERT_TRUE(displays("AAPL: $227.48 +0.61% (+$1.38) \x01"));
+  const int64_t referencePrice = stockTicker.getReferencePrice(0);
+  const std::string sparkline = stockTicker.getSparkline(0);
+
+  // Parses fine, but the whole batch is thrown away when the trailer
+  // doesn't match what was decompressed
+  const std::string corrupt[] = {
+    gzipStored(changed, 1),
+    gzipStored(changed, 0, 1),
+    // Ends before the trailer
+    gzipStored(changed).substr(0, gzipStored(changed).size() - 8)};
+  for (const std::string& body : corrupt) {
+    gzip = body;
+    HostShim::advanceMillis(60 * 1000);
+    run(2000);
+    TEST_ASSERT_EQUAL(StockTickerStatus::ERROR_BAD_JSON_RESPONSE,
+                      stockTicker.getStatus());
+    TEST_ASSERT_TRUE(displays("AAPL: $227.48 +0.61% (+$1.38) \x01"));
+    TEST_ASSERT_FALSE(displays("300.00"));
+    // Along with what it did to the reference price and sparkline
+    TEST_ASSERT_EQUAL_INT64(referencePrice, stockTicker.getReferencePrice(0));
+    TEST_ASSERT_TRUE(sparkline == stockTicker.getSparkline(0));
+  }
+
+  gzip = gzipStored(changed);
+  HostShim::advanceMillis(60 * 1000);
+  run(2000);
+  TEST_ASSERT_EQUAL(StockTickerStatus::OK, stockTicker.getStatus());
+  TEST_ASSERT_TRUE(displays("AAPL: $300.00"));
+}
+
+void test_stream_trades() {
+  streamServer.respond = [](const std::string& request) {
+    return std::string("HTTP/1.1 101 Switching Protocols\r\n"
+                       "Upgrade: websocket\r\n"
+                       "Connection: Upgrade\r\n\r\n") +
+           textFrame("[{\"T\":\"success\",\"msg\":\"connected\"}]");
+  };
+  stockTicker.begin("key", "secret", "AAPL,MSFT,GOOG", "iex", 60 * 1000,
+                    DataSource::STREAM);
+  run(2000);
+  TEST_ASSERT_EQUAL(1, streamServer.connectCount);
+  const std::string& handshake = streamServer.requests.at(0);
+  TEST_ASSERT_EQUAL_STRING("/v2/iex", requestPath(handshake).c_str());
+  streamServer.push(
+    textFrame("[{\"T\":\"success\",\"msg\":\"authenticated\"}]"));
+  run(10);
+  streamServer.push(textFrame("[{\"T\":\"subscription\",\"trades\":"
+                              "[\"AAPL\",\"MSFT\",\"GOOG\"]}]"));
+  run(10);
+
+  // Replay the recorded trades
+  const std::string trades = RecordedResponses::streamMessages();
+  TEST_ASSERT_FALSE(trades.empty());
+  size_t start = 0;
+  size_t end;
+  while ((end = trades.find('\n', start)) != std::string::npos) {
+    streamServer.push(textFrame(trades.substr(start, end - start)));
+    run(2);
+    start = end + 1;
+  }
+  TEST_ASSERT_EQUAL(StockTickerStatus::OK, stockTicker.getStatus());
+  TEST_ASSERT_EQUAL(1, streamServer.connectCount);
+  // The last trade, against the open from the snapshot
+  TEST_ASSERT_TRUE(displays("AAPL: $227.60 +0.66% (+$1.50) \x01"));
+  TEST_ASSERT_EQUAL(strlen(stockTicker.getDisplayStr()),
+                    stockTicker.getDisplayStrLen());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_snapshots_fill_the_display);
+  RUN_TEST(test_polls_across_millis_wrap);
+  RUN_TEST(test_latest_trades_after_a_snapshot);
+  RUN_TEST(test_server_errors_are_reported);
+  RUN_TEST(test_gzip_trailer_is_checked);
+  RUN_TEST(test_stream_trades);
+  return UNITY_END();
+}
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Builds the gzip fixtures test_gzip_inflater decompresses and
+test_benchmarks serves.
+
+Each body is compressed at levels 1, 6 and 9, the fastest, the default the
+real server and tools/mock_data_server.py use, and the smallest, into
+tools/recorded_gzip/<body>.<level>.gz. The bodies cover what GzipInflater
+has to get right:
+
+    snapshots     the recorded snapshots.json, dynamic Huffman codes
+    snapshots_N   AAPL's snapshot for 1, 32 and 64 made up symbols, like
+                  RecordedResponses::snapshots(N), so most of it is copies
+                  of up to 258 bytes, far longer than a few input bytes
+    far           FAR_LEN pseudo-random letters twice, so the second half is
+                  copied from FAR_LEN bytes back, near the 32 KB window
+    short         a latest trades body without any trades, short enough to
+                  get fixed Huffman codes
+
+The tests build the same bodies to compare against, so keep them in sync
+with test/test_gzip_inflater and test/test_benchmarks. The mtime is left at
+0, so running this again with the same zlib gives the same files.
+
+Only the Python standard library is needed.
+"""
+
+import gzip
+import os
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+LEVELS = (1, 6, 9)
+# The symbol counts of HostBench::SYMBOL_COUNTS
+SYMBOL_COUNTS = (1, 32, 64)
+# zlib never copies from further back than 32 KB minus 262 bytes
+FAR_LEN = 32500
+
+
+def value_of(json, key):
+    """Raw text of the value of a key, like RecordedResponses::valueOf()."""
+    quoted = '"%s":' % key
+    i = start = json.index(quoted) + len(quoted)
+    depth = 0
+    while True:
+        if json[i] in "{[":
+            depth += 1
+        elif json[i] in "}]":
+            depth -= 1
+        i += 1
+        if depth <= 0 or i >= len(json):
+            return json[start:i]
+
+
+def letters(count, seed=1):
+    """Pseudo-random lowercase letters from the C library's old rand()."""
+    out = []
+    x = seed
+    for _ in range(count):
+        x = (x * 1103515245 + 12345) & 0x7FFFFFFF
+        out.append(chr(ord("a") + (x >> 16) % 26))
+    return "".join(out)
+
+
+def main():
+    with open(os.path.join(TOOLS, "recorded_responses", "snapshots.json"),
+              "rb") as f:
+        snapshots = f.read()
+    aapl = value_of(snapshots.decode(), "AAPL")
+    far = letters(FAR_LEN)
+    bodies = {"snapshots": snapshots}
+    for count in SYMBOL_COUNTS:
+        bodies["snapshots_%d" % count] = (
+            "{" + ",".join('"S%d":%s' % (i, aapl) for i in range(count)) +
+            "}").encode()
+    bodies.update({
+        "far": (far + far).encode(),
+        "short": b'{"trades":{"AAPL":null,"MSFT":null,"GOOG":null}}',
+    })
+    out_dir = os.path.join(TOOLS, "recorded_gzip")
+    os.makedirs(out_dir, exist_ok=True)
+    for name, body in bodies.items():
+        for level in LEVELS:
+            path = os.path.join(out_dir, "%s.%d.gz" % (name, level))
+            with open(path, "wb") as f:
+                f.write(gzip.compress(body, compresslevel=level, mtime=0))
+            print("%s: %d -> %d bytes" % (path, len(body),
+                                          os.path.getsize(path)))
+
+
+if __name__ == "__main__":
+    main()
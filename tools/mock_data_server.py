@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+"""Local stand-in for Alpaca Markets' historical stock data REST API.
+
+Serves /v2/stocks/snapshots, /v2/stocks/trades/latest and /v2/stocks/bars
+from recorded responses (tools/recorded_responses), keeping only the
+requested symbols like the real API does. Keeps connections alive and
+answers pipelined requests in order, like the real server.
+
+It can also misbehave on purpose, to test StockTicker without WiFi trouble
+or live credentials: add latency, trickle the body out slowly, send it
+chunked, cut it short, or answer with error codes and rate-limit headers.
+With --gzip it compresses bodies for clients that accept it, like the real
+server does.
+
+Point the ticker at it with DATA_SERVER_HOST / DATA_SERVER_PORT in config.h.
+The ticker only talks TLS but doesn't check the certificate, so a
+self-signed one works (see tools/stream_replay.py for making one):
+
+    python3 tools/mock_data_server.py --cert cert.pem --key key.pem \\
+        --latency 200 --error 429 --error-every 5 --retry-after 10
+
+Without --cert it serves plain HTTP, for host builds and curl.
+
+Only the Python standard library is needed.
+"""
+
+import argparse
+import email.utils
+import gzip
+import json
+import os
+import random
+import socket
+import ssl
+import threading
+import time
+import urllib.parse
+
+DEFAULT_CORPUS = os.path.join(os.path.dirname(__file__), "recorded_responses")
+REASONS = {200: "OK", 400: "Bad Request", 403: "Forbidden", 404: "Not Found",
+           429: "Too Many Requests", 500: "Internal Server Error",
+           503: "Service Unavailable"}
+
+
+class Corpus:
+    """The recorded responses, by symbol."""
+
+    def __init__(self, path, synthesize):
+        with open(os.path.join(path, "snapshots.json")) as f:
+            self.snapshots = json.load(f)
+        with open(os.path.join(path, "latest_trades.json")) as f:
+            self.trades = json.load(f)["trades"]
+        with open(os.path.join(path, "bars.json")) as f:
+            self.bars = json.load(f)["bars"]
+        self.synthesize = synthesize
+
+    def _pick(self, recorded, symbol):
+        """Get the recording of a symbol, or make one up from another
+        symbol's if --synthesize is on, for load tests with many symbols."""
+        if symbol in recorded:
+            return recorded[symbol]
+        if not self.synthesize:
+            return None
+        # The same made up prices every time for the same symbol
+        rng = random.Random(symbol)
+        template = recorded[rng.choice(sorted(recorded))]
+        scale = rng.uniform(0.05, 5.0)
+        return scale_prices(template, scale)
+
+    def body(self, endpoint, symbols):
+        if endpoint == "snapshots":
+            picked = {s: self._pick(self.snapshots, s) for s in symbols}
+            return {s: v for s, v in picked.items() if v is not None}
+        if endpoint == "trades/latest":
+            picked = {s: self._pick(self.trades, s) for s in symbols}
+            return {"trades": {s: v for s, v in picked.items()
+                               if v is not None}}
+        if endpoint == "bars":
+            picked = {s: self._pick(self.bars, s) for s in symbols}
+            return {"bars": {s: v for s, v in picked.items()
+                             if v is not None},
+                    "next_page_token": None}
+        return None
+
+
+def scale_prices(value, scale):
+    """Copy a recording with every price multiplied by scale."""
+    if isinstance(value, dict):
+        return {k: (round(v * scale, 2)
+                    if k in ("c", "h", "l", "o", "p", "vw", "ap", "bp") and
+                    isinstance(v, (int, float)) else scale_prices(v, scale))
+                for k, v in value.items()}
+    if isinstance(value, list):
+        return [scale_prices(v, scale) for v in value]
+    return value
+
+
+class Connection:
+    """Reads requests one at a time, so pipelined ones are answered in
+    order."""
+
+    def __init__(self, conn):
+        self.conn = conn
+        self.buffer = b""
+
+    def read_request(self):
+        while b"\r\n\r\n" not in self.buffer:
+            data = self.conn.recv(4096)
+            if not data:
+                return None
+            self.buffer += data
+        head, self.buffer = self.buffer.split(b"\r\n\r\n", 1)
+        lines = head.decode("latin-1").split("\r\n")
+        method, target, _ = lines[0].split(" ", 2)
+        headers = {}
+        for line in lines[1:]:
+            name, _, value = line.partition(":")
+            headers[name.strip().lower()] = value.strip()
+        return method, target, headers
+
+
+class Server:
+    def __init__(self, args, corpus):
+        self.args = args
+        self.corpus = corpus
+        self.lock = threading.Lock()
+        self.requests = 0
+
+    def next_request_number(self):
+        with self.lock:
+            self.requests += 1
+            return self.requests
+
+    def respond(self, target, headers):
+        """Get the status code, extra headers and body for a request."""
+        number = self.next_request_number()
+        args = self.args
+        extra = {}
+        if args.remaining is not None:
+            extra["X-RateLimit-Limit"] = "200"
+            extra["X-RateLimit-Remaining"] = str(args.remaining)
+            extra["X-RateLimit-Reset"] = str(int(time.time()) + 60)
+        if (headers.get("apca-api-key-id") is None or
+                headers.get("apca-api-secret-key") is None):
+            return 403, extra, b'{"message":"forbidden."}'
+        if args.error and (
+                (args.error_every and number % args.error_every == 0) or
+                (args.error_rate and random.random() < args.error_rate)):
+            if args.retry_after is not None:
+                extra["Retry-After"] = str(args.retry_after)
+            return args.error, extra, (
+                b'{"message":"injected error %d"}' % args.error)
+        url = urllib.parse.urlsplit(target)
+        prefix = "/v2/stocks/"
+        query = urllib.parse.parse_qs(url.query)
+        symbols = [s for s in query.get("symbols", [""])[0].split(",") if s]
+        if not url.path.startswith(prefix) or not symbols:
+            return 400, extra, b'{"message":"bad request"}'
+        body = self.corpus.body(url.path[len(prefix):], symbols)
+        if body is None:
+            return 404, extra, b'{"message":"not found"}'
+        return 200, extra, json.dumps(body, separators=(",", ":")).encode()
+
+    def send(self, conn, data):
+        """Send data, trickled out at --rate bytes per second if set."""
+        if not self.args.rate:
+            conn.sendall(data)
+            return
+        piece = max(1, int(self.args.rate / 20))
+        for i in range(0, len(data), piece):
+            conn.sendall(data[i:i + piece])
+            time.sleep(len(data[i:i + piece]) / self.args.rate)
+
+    def handle_client(self, conn, addr):
+        args = self.args
+        reader = Connection(conn)
+        print("%s: connected" % (addr,))
+        try:
+            while True:
+                request = reader.read_request()
+                if request is None:
+                    break
+                method, target, headers = request
+                status, extra, body = self.respond(target, headers)
+                length = len(body)
+                if args.gzip and "gzip" in headers.get("accept-encoding", ""):
+                    body = gzip.compress(body, compresslevel=args.gzip)
+                    extra["Content-Encoding"] = "gzip"
+                print("%s: %s %s -> %d, %d bytes (%d sent)" %
+                      (addr, method, target, status, length, len(body)))
+                delay = args.latency + random.uniform(0, args.jitter)
+                time.sleep(delay / 1000.0)
+
+                close = args.close
+                if args.truncate is not None and status == 200:
+                    # Promise the whole body but stop partway, then hang up
+                    close = True
+                    sent_body = body[:args.truncate]
+                else:
+                    sent_body = body
+                head = "HTTP/1.1 %d %s\r\n" % (status,
+                                               REASONS.get(status, "Error"))
+                head += "Date: %s\r\n" % email.utils.formatdate(usegmt=True)
+                head += "Content-Type: application/json; charset=UTF-8\r\n"
+                for name, value in extra.items():
+                    head += "%s: %s\r\n" % (name, value)
+                if close:
+                    head += "Connection: close\r\n"
+                if args.chunked and args.truncate is None:
+                    head += "Transfer-Encoding: chunked\r\n\r\n"
+                    data = head.encode()
+                    for i in range(0, len(sent_body), args.chunked):
+                        chunk = sent_body[i:i + args.chunked]
+                        data += b"%x\r\n%s\r\n" % (len(chunk), chunk)
+                    data += b"0\r\n\r\n"
+                else:
+                    head += "Content-Length: %d\r\n\r\n" % len(body)
+                    data = head.encode() + sent_body
+                self.send(conn, data)
+                if close:
+                    break
+        except (OSError, ValueError) as e:
+            print("%s: %s" % (addr, e))
+        finally:
+            conn.close()
+            print("%s: disconnected" % (addr,))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8444)
+    parser.add_argument("--cert", help="TLS certificate, omit for plain HTTP")
+    parser.add_argument("--key", help="TLS private key")
+    parser.add_argument("--corpus", default=DEFAULT_CORPUS,
+                        help="directory with the recorded responses")
+    parser.add_argument("--synthesize", action="store_true",
+                        help="make up responses for symbols that weren't"
+                             " recorded, for load tests")
+    parser.add_argument("--latency", type=float, default=0,
+                        help="milliseconds to wait before each response")
+    parser.add_argument("--jitter", type=float, default=0,
+                        help="up to this many more milliseconds, random")
+    parser.add_argument("--rate", type=float, default=0,
+                        help="send responses at this many bytes per second")
+    parser.add_argument("--chunked", type=int, default=0, metavar="SIZE",
+                        help="send bodies chunked, in chunks of SIZE bytes")
+    parser.add_argument("--gzip", type=int, nargs="?", const=6, default=0,
+                        metavar="LEVEL",
+                        help="compress bodies if the client accepts gzip")
+    parser.add_argument("--truncate", type=int, metavar="BYTES",
+                        help="close the connection after BYTES of each body")
+    parser.add_argument("--close", action="store_true",
+                        help="close the connection after every response")
+    parser.add_argument("--error", type=int, default=0, metavar="CODE",
+                        help="status code to answer with instead of 200")
+    parser.add_argument("--error-every", type=int, default=0, metavar="N",
+                        help="answer every Nth request with --error")
+    parser.add_argument("--error-rate", type=float, default=0,
+                        help="answer this fraction of requests with --error")
+    parser.add_argument("--retry-after", type=int, metavar="SECONDS",
+                        help="send Retry-After with errors")
+    parser.add_argument("--remaining", type=int, metavar="N",
+                        help="send X-RateLimit-* headers with N remaining")
+    args = parser.parse_args()
+    if args.error and not (args.error_every or args.error_rate):
+        args.error_every = 1
+
+    corpus = Corpus(args.corpus, args.synthesize)
+    server = Server(args, corpus)
+
+    context = None
+    if args.cert:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(args.cert, args.key)
+
+    sock = socket.create_server((args.host, args.port))
+    print("Serving %d recorded symbols on port %d" %
+          (len(corpus.snapshots), args.port))
+    while True:
+        conn, addr = sock.accept()
+        if context:
+            try:
+                conn = context.wrap_socket(conn, server_side=True)
+            except (ssl.SSLError, OSError) as e:
+                print("%s: TLS failed: %s" % (addr, e))
+                conn.close()
+                continue
+        threading.Thread(target=server.handle_client, args=(conn, addr),
+                         daemon=True).start()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""Local stand-in for Alpaca Markets' real-time stock data stream.
+
+Speaks just enough of the stream protocol for StockTicker's "stream" data
+source: it accepts any key and secret, confirms subscriptions, then replays
+recorded messages (one JSON array per line) at a fixed rate.
+
+Point the ticker at it with STREAM_SERVER_HOST / STREAM_SERVER_PORT in
+config.h. The ticker only talks TLS but doesn't check the certificate, so a
+self-signed one works:
+
+    openssl req -x509 -newkey rsa:2048 -nodes -days 365 -subj /CN=replay \\
+        -keyout key.pem -out cert.pem
+    python3 tools/stream_replay.py --cert cert.pem --key key.pem --rate 5
+
+Only the Python standard library is needed.
+"""
+
+import argparse
+import base64
+import hashlib
+import json
+import os
+import socket
+import ssl
+import struct
+import threading
+import time
+
+WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+DEFAULT_RECORDING = os.path.join(os.path.dirname(__file__),
+                                 "recorded_trades.jsonl")
+
+
+def read_http_head(conn):
+    head = b""
+    while b"\r\n\r\n" not in head:
+        data = conn.recv(1024)
+        if not data:
+            raise ConnectionError("closed during handshake")
+        head += data
+    return head.decode("latin-1")
+
+
+def send_frame(conn, lock, opcode, payload=b""):
+    header = bytes([0x80 | opcode])
+    if len(payload) < 126:
+        header += bytes([len(payload)])
+    elif len(payload) < 65536:
+        header += bytes([126]) + struct.pack("!H", len(payload))
+    else:
+        header += bytes([127]) + struct.pack("!Q", len(payload))
+    with lock:
+        conn.sendall(header + payload)
+
+
+def recv_exact(conn, n):
+    data = b""
+    while len(data) < n:
+        chunk = conn.recv(n - len(data))
+        if not chunk:
+            raise ConnectionError("closed")
+        data += chunk
+    return data
+
+
+def recv_frame(conn):
+    b0, b1 = recv_exact(conn, 2)
+    length = b1 & 0x7F
+    if length == 126:
+        length = struct.unpack("!H", recv_exact(conn, 2))[0]
+    elif length == 127:
+        length = struct.unpack("!Q", recv_exact(conn, 8))[0]
+    mask = recv_exact(conn, 4) if b1 & 0x80 else b"\0\0\0\0"
+    payload = bytes(c ^ mask[i % 4] for i, c in enumerate(
+        recv_exact(conn, length)))
+    return b0 & 0x0F, payload
+
+
+def send_json(conn, lock, messages):
+    send_frame(conn, lock, 0x1, json.dumps(messages).encode())
+
+
+def handle_client(conn, addr, args, recording):
+    lock = threading.Lock()
+    subscribed = threading.Event()
+    closed = threading.Event()
+
+    head = read_http_head(conn)
+    key = ""
+    for line in head.split("\r\n"):
+        if line.lower().startswith("sec-websocket-key:"):
+            key = line.split(":", 1)[1].strip()
+    accept = base64.b64encode(
+        hashlib.sha1((key + WEBSOCKET_GUID).encode()).digest()).decode()
+    conn.sendall(("HTTP/1.1 101 Switching Protocols\r\n"
+                  "Upgrade: websocket\r\n"
+                  "Connection: Upgrade\r\n"
+                  "Sec-WebSocket-Accept: %s\r\n\r\n" % accept).encode())
+    print("%s: connected" % (addr,))
+    send_json(conn, lock, [{"T": "success", "msg": "connected"}])
+
+    def read_loop():
+        try:
+            while not closed.is_set():
+                opcode, payload = recv_frame(conn)
+                if opcode == 0x8:
+                    send_frame(conn, lock, 0x8, payload[:2])
+                    break
+                if opcode == 0x9:
+                    send_frame(conn, lock, 0xA, payload)
+                    continue
+                if opcode != 0x1:
+                    continue
+                message = json.loads(payload)
+                print("%s: %s" % (addr, message.get("action")))
+                if message.get("action") == "auth":
+                    if args.reject_auth:
+                        send_json(conn, lock, [{"T": "error", "code": 402,
+                                                "msg": "auth failed"}])
+                    else:
+                        send_json(conn, lock, [{"T": "success",
+                                                "msg": "authenticated"}])
+                elif message.get("action") == "subscribe":
+                    send_json(conn, lock, [{
+                        "T": "subscription",
+                        "trades": message.get("trades", []),
+                        "quotes": [], "bars": []}])
+                    subscribed.set()
+        except (ConnectionError, OSError, ValueError):
+            pass
+        closed.set()
+
+    threading.Thread(target=read_loop, daemon=True).start()
+
+    sent = 0
+    try:
+        while not subscribed.wait(0.1):
+            if closed.is_set():
+                return
+        while not closed.is_set():
+            for line in recording:
+                if closed.is_set():
+                    break
+                send_frame(conn, lock, 0x1, line)
+                sent += 1
+                if args.drop_after and sent >= args.drop_after:
+                    print("%s: dropping connection after %d messages" %
+                          (addr, sent))
+                    return
+                time.sleep(1.0 / args.rate)
+            if not args.loop:
+                break
+        # Keep the connection open, answering pings, until the client leaves
+        while not closed.wait(1):
+            pass
+    except OSError:
+        pass
+    finally:
+        closed.set()
+        conn.close()
+        print("%s: disconnected" % (addr,))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8443)
+    parser.add_argument("--cert", help="TLS certificate, omit for plain ws://")
+    parser.add_argument("--key", help="TLS private key")
+    parser.add_argument("--recording", default=DEFAULT_RECORDING,
+                        help="file with one recorded message per line")
+    parser.add_argument("--rate", type=float, default=1.0,
+                        help="messages per second")
+    parser.add_argument("--loop", action="store_true",
+                        help="replay the recording forever")
+    parser.add_argument("--drop-after", type=int, default=0,
+                        help="close the connection after this many messages,"
+                             " to test reconnecting")
+    parser.add_argument("--reject-auth", action="store_true",
+                        help="answer auth with error 402")
+    args = parser.parse_args()
+
+    with open(args.recording, "rb") as f:
+        recording = [line.strip() for line in f if line.strip()]
+
+    context = None
+    if args.cert:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(args.cert, args.key)
+
+    server = socket.create_server((args.host, args.port))
+    print("Replaying %d messages on port %d" % (len(recording), args.port))
+    while True:
+        conn, addr = server.accept()
+        if context:
+            try:
+                conn = context.wrap_socket(conn, server_side=True)
+            except (ssl.SSLError, OSError) as e:
+                print("%s: TLS failed: %s" % (addr, e))
+                conn.close()
+                continue
+        threading.Thread(target=handle_client,
+                         args=(conn, addr, args, recording),
+                         daemon=True).start()
+
+
+if __name__ == "__main__":
+    main()